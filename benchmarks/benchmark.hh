@@ -0,0 +1,100 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file benchmarks/benchmark.hh
+ *
+ * \brief Timing and JSON output shared by the benchmarks.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_BENCHMARKS_BENCHMARK_HH
+# define ROBOPTIM_CAPSULE_BENCHMARKS_BENCHMARK_HH
+
+# include <algorithm>
+# include <ostream>
+# include <string>
+# include <vector>
+
+# include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace benchmark
+    {
+      /// \brief Wall clock time in seconds, since the first call.
+      inline double now ()
+      {
+	using namespace boost::posix_time;
+	static const ptime epoch = microsec_clock::universal_time ();
+	return static_cast<double> ((microsec_clock::universal_time () - epoch)
+				    .total_microseconds ()) * 1e-6;
+      }
+
+      /// \brief Fastest of several runs of a function.
+      ///
+      /// \param f function object, called without arguments.
+      /// \param repeat number of runs.
+      /// \return wall clock time of the fastest run, in seconds.
+      template <typename F>
+      double bestTime (F f, size_t repeat)
+      {
+	double best = 0.;
+	for (size_t r = 0; r < repeat; ++r)
+	  {
+	    double start = now ();
+	    f ();
+	    double t = now () - start;
+	    best = (r == 0) ? t : std::min (best, t);
+	  }
+	return best;
+      }
+
+      /// \brief Write the results of a benchmark as JSON.
+      ///
+      /// Each record writes its own members, without braces, through
+      /// its writeJson (std::ostream&) method.
+      ///
+      /// \param os output stream.
+      /// \param name name of the benchmark.
+      /// \param records results.
+      /// \param fields optional extra members of the top-level object,
+      /// e.g. "\"simd\": \"SSE2\"".
+      template <typename R>
+      void writeJson (std::ostream& os, const std::string& name,
+		      const std::vector<R>& records,
+		      const std::string& fields = std::string ())
+      {
+	os << "{\n  \"benchmark\": \"" << name << "\",\n";
+	if (!fields.empty ())
+	  os << "  " << fields << ",\n";
+	os << "  \"results\": [";
+	for (size_t i = 0; i < records.size (); ++i)
+	  {
+	    os << (i == 0 ? "\n" : ",\n") << "    {";
+	    records[i].writeJson (os);
+	    os << "}";
+	  }
+	os << "\n  ]\n}" << std::endl;
+      }
+    } // end of namespace benchmark.
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_BENCHMARKS_BENCHMARK_HH
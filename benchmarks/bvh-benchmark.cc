@@ -0,0 +1,435 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file benchmarks/bvh-benchmark.cc
+ *
+ * \brief Capsule hierarchy queries against brute force.
+ *
+ * Scenes of random capsules with a constant density are queried with
+ * random points, capsules and rays, both by testing every capsule and
+ * with the hierarchy. The build is timed with one thread and with all
+ * the hardware threads, and the refit against a rebuild. Results are
+ * written as JSON, with the number of queries whose answers differ.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <Eigen/Geometry>
+
+#include <roboptim/capsule/capsule-bvh.hh>
+#include <roboptim/capsule/capsule-distance.hh>
+
+#include "benchmark.hh"
+
+using namespace roboptim;
+using namespace roboptim::capsule;
+using namespace roboptim::capsule::benchmark;
+
+namespace
+{
+  /// \brief One benchmark record.
+  struct Record
+  {
+    std::string operation;
+    size_t capsules;
+    size_t queries;
+    size_t repeat;
+    /// \brief Brute force, single-threaded build or rebuild.
+    double referenceTime;
+    double bvhTime;
+    size_t mismatches;
+
+    void writeJson (std::ostream& os) const
+    {
+      os << "\"operation\": \"" << operation << "\""
+	 << ", \"capsules\": " << capsules
+	 << ", \"queries\": " << queries
+	 << ", \"repeat\": " << repeat
+	 << ", \"reference_time\": " << referenceTime
+	 << ", \"bvh_time\": " << bvhTime
+	 << ", \"speedup\": "
+	 << (bvhTime > 0. ? referenceTime / bvhTime : 0.)
+	 << ", \"mismatches\": " << mismatches;
+    }
+  };
+
+  /// \brief Short capsules in a cube whose volume grows with their
+  /// number.
+  std::vector<Capsule> randomCapsules (size_t n, value_type side)
+  {
+    std::vector<Capsule> capsules (n);
+    for (size_t i = 0; i < n; ++i)
+      {
+	capsules[i].P0 = 0.5 * side * point_t::Random ();
+	capsules[i].P1 = capsules[i].P0 + 0.5 * point_t::Random ();
+	capsules[i].radius = 0.2 + 0.1 * std::rand () / RAND_MAX;
+      }
+    return capsules;
+  }
+
+  /// \brief Random queries.
+  struct Queries
+  {
+    std::vector<point_t> points;
+    std::vector<Capsule> capsules;
+    std::vector<vector3_t> directions;
+  };
+
+  struct Build
+  {
+    const std::vector<Capsule>* capsules;
+    size_t nbThreads;
+
+    void operator() () const
+    {
+      CapsuleBvh bvh (*capsules, nbThreads);
+    }
+  };
+
+  struct Refit
+  {
+    CapsuleBvh* bvh;
+    const std::vector<Capsule>* moved;
+
+    void operator() () const
+    {
+      bvh->refit (*moved);
+    }
+  };
+
+  struct BruteInside
+  {
+    const std::vector<Capsule>* capsules;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	{
+	  const point_t& p = queries->points[q];
+	  (*results)[q] = 0;
+	  for (size_t i = 0; i < capsules->size (); ++i)
+	    {
+	      const Capsule& c = (*capsules)[i];
+	      if (distancePointToSegment (p, c.P0, c.P1) <= c.radius)
+		{
+		  (*results)[q] = 1;
+		  break;
+		}
+	    }
+	}
+    }
+  };
+
+  struct BvhInside
+  {
+    const CapsuleBvh* bvh;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	(*results)[q] = bvh->inside (queries->points[q]) ? 1 : 0;
+    }
+  };
+
+  struct BruteNearest
+  {
+    const std::vector<Capsule>* capsules;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	{
+	  const point_t& p = queries->points[q];
+	  value_type best = std::numeric_limits<value_type>::infinity ();
+	  for (size_t i = 0; i < capsules->size (); ++i)
+	    {
+	      const Capsule& c = (*capsules)[i];
+	      value_type d = distancePointToSegment (p, c.P0, c.P1)
+		- c.radius;
+	      if (d < best)
+		{
+		  best = d;
+		  (*results)[q] = static_cast<size_type> (i);
+		}
+	    }
+	}
+    }
+  };
+
+  struct BvhNearest
+  {
+    const CapsuleBvh* bvh;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      value_type d;
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	(*results)[q] = bvh->nearest (queries->points[q], d);
+    }
+  };
+
+  struct BruteOverlap
+  {
+    const CapsuleSet* set;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      std::vector<size_type> indices;
+      for (size_t q = 0; q < queries->capsules.size (); ++q)
+	{
+	  overlappingCapsules (queries->capsules[q], *set, indices);
+	  (*results)[q] = static_cast<size_type> (indices.size ());
+	}
+    }
+  };
+
+  struct BvhOverlap
+  {
+    const CapsuleBvh* bvh;
+    const Queries* queries;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      std::vector<size_type> indices;
+      for (size_t q = 0; q < queries->capsules.size (); ++q)
+	{
+	  bvh->overlapping (queries->capsules[q], indices);
+	  (*results)[q] = static_cast<size_type> (indices.size ());
+	}
+    }
+  };
+
+  struct BruteRay
+  {
+    const std::vector<Capsule>* capsules;
+    const Queries* queries;
+    value_type length;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	{
+	  value_type best = length;
+	  (*results)[q] = -1;
+	  for (size_t i = 0; i < capsules->size (); ++i)
+	    {
+	      value_type t;
+	      if (rayCapsuleIntersection (queries->points[q],
+					  queries->directions[q],
+					  (*capsules)[i], t)
+		  && t <= best)
+		{
+		  best = t;
+		  (*results)[q] = static_cast<size_type> (i);
+		}
+	    }
+	}
+    }
+  };
+
+  struct BvhRay
+  {
+    const CapsuleBvh* bvh;
+    const Queries* queries;
+    value_type length;
+    std::vector<size_type>* results;
+
+    void operator() () const
+    {
+      value_type t;
+      for (size_t q = 0; q < queries->points.size (); ++q)
+	{
+	  size_type index = -1;
+	  bvh->raycast (queries->points[q], queries->directions[q], length,
+			t, index);
+	  (*results)[q] = index;
+	}
+    }
+  };
+
+  size_t mismatches (const std::vector<size_type>& a,
+		     const std::vector<size_type>& b)
+  {
+    size_t n = 0;
+    for (size_t i = 0; i < a.size (); ++i)
+      n += (a[i] != b[i]) ? 1 : 0;
+    return n;
+  }
+} // end of anonymous namespace.
+
+int main (int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  po::options_description desc ("Options");
+  desc.add_options ()
+    ("help", "Print this help and exit")
+    ("output", po::value<std::string> ()->default_value ("bvh-benchmark.json"),
+     "JSON output file")
+    ("max-capsules", po::value<size_t> ()->default_value (100000),
+     "Largest number of capsules")
+    ("queries", po::value<size_t> ()->default_value (1000),
+     "Number of queries of each kind")
+    ("repeat", po::value<size_t> ()->default_value (3),
+     "Number of runs of each measurement, the fastest one is kept");
+
+  po::variables_map vm;
+  try
+    {
+      po::store (po::parse_command_line (argc, argv, desc), vm);
+      po::notify (vm);
+    }
+  catch (po::error& e)
+    {
+      std::cerr << "Error: " << e.what () << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  if (vm.count ("help"))
+    {
+      std::cout << desc;
+      return EXIT_SUCCESS;
+    }
+
+  const size_t maxCapsules = vm["max-capsules"].as<size_t> ();
+  const size_t nbQueries = vm["queries"].as<size_t> ();
+  const size_t repeat = std::max (vm["repeat"].as<size_t> (),
+				  static_cast<size_t> (1));
+
+  // Sizes: 100, 1000, ..., up to the maximum size.
+  std::vector<size_t> sizes;
+  for (size_t n = 100; n < maxCapsules; n *= 10)
+    sizes.push_back (n);
+  sizes.push_back (maxCapsules);
+
+  std::vector<Record> records;
+  for (size_t k = 0; k < sizes.size (); ++k)
+    {
+      const size_t n = sizes[k];
+      std::cerr << n << " capsules" << std::endl;
+
+      // About one capsule per unit volume.
+      const value_type side = std::pow (static_cast<value_type> (n), 1. / 3.);
+
+      std::srand (42);
+      const std::vector<Capsule> capsules = randomCapsules (n, side);
+      Queries queries;
+      queries.capsules = randomCapsules (nbQueries, side);
+      for (size_t q = 0; q < nbQueries; ++q)
+	{
+	  queries.points.push_back (0.5 * side * point_t::Random ());
+	  queries.directions.push_back (vector3_t::Random ().normalized ());
+	}
+
+      Record record;
+      record.capsules = n;
+      record.repeat = repeat;
+      record.mismatches = 0;
+
+      // Build with one thread and with all the hardware threads.
+      Build serialBuild = {&capsules, 1};
+      Build parallelBuild = {&capsules, 0};
+      record.operation = "build";
+      record.queries = 0;
+      record.referenceTime = bestTime (serialBuild, repeat);
+      record.bvhTime = bestTime (parallelBuild, repeat);
+      records.push_back (record);
+
+      // Rigid motion of the whole scene: refit against rebuild.
+      std::vector<Capsule> moved (capsules);
+      const Eigen::AngleAxis<value_type> rotation (0.3, vector3_t::UnitZ ());
+      for (size_t i = 0; i < n; ++i)
+	{
+	  moved[i].P0 = rotation * capsules[i].P0 + vector3_t (0.1, 0., 0.);
+	  moved[i].P1 = rotation * capsules[i].P1 + vector3_t (0.1, 0., 0.);
+	}
+      CapsuleBvh bvh (capsules);
+      Build rebuild = {&moved, 0};
+      Refit refit = {&bvh, &moved};
+      record.operation = "refit";
+      record.referenceTime = bestTime (rebuild, repeat);
+      record.bvhTime = bestTime (refit, repeat);
+      records.push_back (record);
+
+      // Queries, on the rebuilt hierarchy.
+      bvh.build (capsules);
+      const CapsuleSet set (capsules);
+      std::vector<size_type> brute (nbQueries);
+      std::vector<size_type> tree (nbQueries);
+      record.queries = nbQueries;
+
+      BruteInside bruteInside = {&capsules, &queries, &brute};
+      BvhInside bvhInside = {&bvh, &queries, &tree};
+      record.operation = "inside";
+      record.referenceTime = bestTime (bruteInside, repeat);
+      record.bvhTime = bestTime (bvhInside, repeat);
+      record.mismatches = mismatches (brute, tree);
+      records.push_back (record);
+
+      BruteNearest bruteNearest = {&capsules, &queries, &brute};
+      BvhNearest bvhNearest = {&bvh, &queries, &tree};
+      record.operation = "nearest";
+      record.referenceTime = bestTime (bruteNearest, repeat);
+      record.bvhTime = bestTime (bvhNearest, repeat);
+      record.mismatches = mismatches (brute, tree);
+      records.push_back (record);
+
+      BruteOverlap bruteOverlap = {&set, &queries, &brute};
+      BvhOverlap bvhOverlap = {&bvh, &queries, &tree};
+      record.operation = "overlapping";
+      record.referenceTime = bestTime (bruteOverlap, repeat);
+      record.bvhTime = bestTime (bvhOverlap, repeat);
+      record.mismatches = mismatches (brute, tree);
+      records.push_back (record);
+
+      BruteRay bruteRay = {&capsules, &queries, side, &brute};
+      BvhRay bvhRay = {&bvh, &queries, side, &tree};
+      record.operation = "raycast";
+      record.referenceTime = bestTime (bruteRay, repeat);
+      record.bvhTime = bestTime (bvhRay, repeat);
+      record.mismatches = mismatches (brute, tree);
+      records.push_back (record);
+    }
+
+  std::ofstream output (vm["output"].as<std::string> ().c_str ());
+  output.precision (10);
+  benchmark::writeJson (output, "bvh", records);
+
+  return EXIT_SUCCESS;
+}
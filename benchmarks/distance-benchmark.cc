@@ -0,0 +1,254 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file benchmarks/distance-benchmark.cc
+ *
+ * \brief Batched point-to-segment kernels against the scalar path.
+ *
+ * Distances and projections of many points on one segment, and
+ * distances from one point to many segments, are computed both point
+ * by point (distancePointToSegment, projectionOnSegment) and with the
+ * batched kernels. Results are written as JSON, with the speedup of
+ * the batched kernels and the SIMD instruction sets used by Eigen.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <roboptim/capsule/util.hh>
+
+#include "benchmark.hh"
+
+using namespace roboptim;
+using namespace roboptim::capsule;
+using namespace roboptim::capsule::benchmark;
+
+namespace
+{
+  /// \brief One benchmark record.
+  struct Record
+  {
+    std::string operation;
+    size_t points;
+    size_t repeat;
+    double scalarTime;
+    double batchedTime;
+    double maxError;
+
+    void writeJson (std::ostream& os) const
+    {
+      os << "\"operation\": \"" << operation << "\""
+	 << ", \"points\": " << points
+	 << ", \"repeat\": " << repeat
+	 << ", \"scalar_time\": " << scalarTime
+	 << ", \"batched_time\": " << batchedTime
+	 << ", \"speedup\": "
+	 << (batchedTime > 0. ? scalarTime / batchedTime : 0.)
+	 << ", \"max_error\": " << maxError;
+    }
+  };
+
+  struct ScalarDistances
+  {
+    const points_t* points;
+    point_t a, b;
+    vector_t* distances;
+
+    void operator() () const
+    {
+      for (size_type i = 0; i < points->cols (); ++i)
+	(*distances)[i] = distancePointToSegment (points->col (i), a, b);
+    }
+  };
+
+  struct BatchedDistances
+  {
+    const points_t* points;
+    point_t a, b;
+    vector_t* distances;
+
+    void operator() () const
+    {
+      distancesPointsToSegment (*points, a, b, *distances);
+    }
+  };
+
+  struct ScalarProjections
+  {
+    const points_t* points;
+    point_t a, b;
+    points_t* projections;
+
+    void operator() () const
+    {
+      for (size_type i = 0; i < points->cols (); ++i)
+	projections->col (i) = projectionOnSegment (points->col (i), a, b);
+    }
+  };
+
+  struct BatchedProjections
+  {
+    const points_t* points;
+    point_t a, b;
+    points_t* projections;
+
+    void operator() () const
+    {
+      projectionsOnSegment (*points, a, b, *projections);
+    }
+  };
+
+  struct ScalarSegments
+  {
+    point_t p;
+    const points_t* starts;
+    const points_t* ends;
+    vector_t* distances;
+
+    void operator() () const
+    {
+      for (size_type i = 0; i < starts->cols (); ++i)
+	(*distances)[i] = distancePointToSegment (p, starts->col (i),
+						  ends->col (i));
+    }
+  };
+
+  struct BatchedSegments
+  {
+    point_t p;
+    const points_t* starts;
+    const points_t* ends;
+    vector_t* distances;
+
+    void operator() () const
+    {
+      distancesPointToSegments (p, *starts, *ends, *distances);
+    }
+  };
+} // end of anonymous namespace.
+
+int main (int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  po::options_description desc ("Options");
+  desc.add_options ()
+    ("help", "Print this help and exit")
+    ("output", po::value<std::string> ()->default_value ("distance-benchmark.json"),
+     "JSON output file")
+    ("max-points", po::value<size_t> ()->default_value (1000000),
+     "Largest number of points")
+    ("repeat", po::value<size_t> ()->default_value (5),
+     "Number of runs of each measurement, the fastest one is kept");
+
+  po::variables_map vm;
+  try
+    {
+      po::store (po::parse_command_line (argc, argv, desc), vm);
+      po::notify (vm);
+    }
+  catch (po::error& e)
+    {
+      std::cerr << "Error: " << e.what () << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  if (vm.count ("help"))
+    {
+      std::cout << desc;
+      return EXIT_SUCCESS;
+    }
+
+  const size_t maxPoints = vm["max-points"].as<size_t> ();
+  const size_t repeat = std::max (vm["repeat"].as<size_t> (),
+				  static_cast<size_t> (1));
+
+  // Sizes: 1000, 10000, ..., up to the maximum size.
+  std::vector<size_t> sizes;
+  for (size_t n = 1000; n < maxPoints; n *= 10)
+    sizes.push_back (n);
+  sizes.push_back (maxPoints);
+
+  std::cerr << "SIMD: " << Eigen::SimdInstructionSetsInUse () << std::endl;
+
+  std::vector<Record> records;
+  for (size_t k = 0; k < sizes.size (); ++k)
+    {
+      const size_type n = static_cast<size_type> (sizes[k]);
+      std::cerr << n << " points" << std::endl;
+
+      std::srand (42);
+      const points_t points = points_t::Random (3, n);
+      const point_t a (-0.5, 0.2, 0.1);
+      const point_t b (0.7, -0.3, 0.4);
+
+      Record record;
+      record.points = sizes[k];
+      record.repeat = repeat;
+
+      // Distances from many points to one segment.
+      vector_t scalar (n);
+      vector_t batched (n);
+      ScalarDistances scalarDistances = {&points, a, b, &scalar};
+      BatchedDistances batchedDistances = {&points, a, b, &batched};
+      record.operation = "distancesPointsToSegment";
+      record.scalarTime = bestTime (scalarDistances, repeat);
+      record.batchedTime = bestTime (batchedDistances, repeat);
+      record.maxError = (scalar - batched).cwiseAbs ().maxCoeff ();
+      records.push_back (record);
+
+      // Projections of many points on one segment.
+      points_t scalarProjections (3, n);
+      points_t batchedProjections (3, n);
+      ScalarProjections scalarProjection
+	= {&points, a, b, &scalarProjections};
+      BatchedProjections batchedProjection
+	= {&points, a, b, &batchedProjections};
+      record.operation = "projectionsOnSegment";
+      record.scalarTime = bestTime (scalarProjection, repeat);
+      record.batchedTime = bestTime (batchedProjection, repeat);
+      record.maxError = (scalarProjections - batchedProjections)
+	.cwiseAbs ().maxCoeff ();
+      records.push_back (record);
+
+      // Distances from one point to many segments.
+      const points_t ends = points_t::Random (3, n);
+      const point_t p (0.3, -0.1, 0.8);
+      ScalarSegments scalarSegments = {p, &points, &ends, &scalar};
+      BatchedSegments batchedSegments = {p, &points, &ends, &batched};
+      record.operation = "distancesPointToSegments";
+      record.scalarTime = bestTime (scalarSegments, repeat);
+      record.batchedTime = bestTime (batchedSegments, repeat);
+      record.maxError = (scalar - batched).cwiseAbs ().maxCoeff ();
+      records.push_back (record);
+    }
+
+  std::ofstream output (vm["output"].as<std::string> ().c_str ());
+  output.precision (10);
+  benchmark::writeJson (output, "distance", records,
+		       std::string ("\"simd\": \"")
+		       + Eigen::SimdInstructionSetsInUse () + "\"");
+
+  return EXIT_SUCCESS;
+}
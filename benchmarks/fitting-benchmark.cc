@@ -0,0 +1,329 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file benchmarks/fitting-benchmark.cc
+ *
+ * \brief Throughput and latency of the capsule fitting pipeline.
+ *
+ * Synthetic meshes of increasing size are generated, and each stage of
+ * the pipeline (convex hull, PCA capsule, bounding capsule, optimal
+ * capsule) is timed separately. Results are written as JSON.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/util.hh>
+
+#include "benchmark.hh"
+
+using namespace roboptim;
+using namespace roboptim::capsule;
+using namespace roboptim::capsule::benchmark;
+
+namespace
+{
+  typedef boost::random::mt19937 generator_t;
+
+  value_type uniform (generator_t& generator, value_type min, value_type max)
+  {
+    return boost::random::uniform_real_distribution<value_type>
+      (min, max) (generator);
+  }
+
+  /// \brief Uniform random unit vector.
+  vector3_t unitVector (generator_t& generator)
+  {
+    boost::random::normal_distribution<value_type> normal;
+    vector3_t v (normal (generator), normal (generator), normal (generator));
+    return v.normalized ();
+  }
+
+  /// \brief Generate a synthetic mesh.
+  ///
+  /// \param shape one of "cube", "cylinder", "random", "elongated" or
+  /// "degenerate".
+  /// \param n number of points.
+  polyhedron_t generateMesh (const std::string& shape, size_t n,
+			     generator_t& generator)
+  {
+    polyhedron_t points;
+    points.reserve (n);
+
+    if (shape == "cube")
+      {
+	// Cube corners, then random points inside.
+	for (size_t i = 0; i < std::min (n, static_cast<size_t> (8)); ++i)
+	  points.push_back (point_t ((i & 1) ? 0.5 : -0.5,
+				     (i & 2) ? 0.5 : -0.5,
+				     (i & 4) ? 0.5 : -0.5));
+	while (points.size () < n)
+	  points.push_back (point_t (uniform (generator, -0.5, 0.5),
+				     uniform (generator, -0.5, 0.5),
+				     uniform (generator, -0.5, 0.5)));
+      }
+    else if (shape == "cylinder")
+      {
+	// Points on the surface of a cylinder of radius 0.5 and length
+	// 2 along x.
+	while (points.size () < n)
+	  {
+	    value_type angle = uniform (generator, 0., 2. * M_PI);
+	    points.push_back (point_t (uniform (generator, -1., 1.),
+				       0.5 * std::cos (angle),
+				       0.5 * std::sin (angle)));
+	  }
+      }
+    else if (shape == "random")
+      {
+	// Gaussian cloud.
+	boost::random::normal_distribution<value_type> normal;
+	while (points.size () < n)
+	  points.push_back (point_t (normal (generator), normal (generator),
+				     normal (generator)));
+      }
+    else if (shape == "elongated")
+      {
+	// Points on the surface of a 10:1:1 ellipsoid.
+	while (points.size () < n)
+	  points.push_back (unitVector (generator).cwiseProduct
+			    (point_t (5., 0.5, 0.5)));
+      }
+    else if (shape == "degenerate")
+      {
+	// Coplanar points on a disk, with many duplicates.
+	while (points.size () < n)
+	  {
+	    value_type angle = uniform (generator, 0., 2. * M_PI);
+	    value_type radius = std::sqrt (uniform (generator, 0., 1.));
+	    point_t p (radius * std::cos (angle), radius * std::sin (angle), 0.);
+	    points.push_back (p);
+	    if (points.size () < n)
+	      points.push_back (p);
+	  }
+      }
+    else
+      throw std::runtime_error ("unknown shape: " + shape);
+
+    return points;
+  }
+
+  /// \brief One benchmark record.
+  struct Record
+  {
+    std::string shape;
+    std::string operation;
+    size_t points;
+    size_t repeat;
+    double wallTime;
+    std::string extra;
+
+    void writeJson (std::ostream& os) const
+    {
+      os << "\"shape\": \"" << shape << "\""
+	 << ", \"operation\": \"" << operation << "\""
+	 << ", \"points\": " << points
+	 << ", \"repeat\": " << repeat
+	 << ", \"wall_time\": " << wallTime
+	 << ", \"points_per_second\": "
+	 << (wallTime > 0. ? static_cast<double> (points) / wallTime : 0.)
+	 << extra;
+    }
+  };
+} // end of anonymous namespace.
+
+int main (int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  po::options_description desc ("Options");
+  desc.add_options ()
+    ("help", "Print this help and exit")
+    ("output", po::value<std::string> ()->default_value ("fitting-benchmark.json"),
+     "JSON output file")
+    ("shapes", po::value<std::vector<std::string> > ()->multitoken (),
+     "Shapes to benchmark (cube, cylinder, random, elongated, degenerate)")
+    ("max-points", po::value<size_t> ()->default_value (1000000),
+     "Largest mesh size")
+    ("fit-max-points", po::value<size_t> ()->default_value (100000),
+     "Largest mesh size for which the optimal capsule is computed")
+    ("repeat", po::value<size_t> ()->default_value (3),
+     "Number of runs of each measurement, the fastest one is kept")
+    ("solver", po::value<std::string> ()->default_value ("ipopt"),
+     "Nonlinear solver used");
+
+  po::variables_map vm;
+  try
+    {
+      po::store (po::parse_command_line (argc, argv, desc), vm);
+      po::notify (vm);
+    }
+  catch (po::error& e)
+    {
+      std::cerr << "Error: " << e.what () << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  if (vm.count ("help"))
+    {
+      std::cout << desc;
+      return EXIT_SUCCESS;
+    }
+
+  std::vector<std::string> shapes;
+  if (vm.count ("shapes"))
+    shapes = vm["shapes"].as<std::vector<std::string> > ();
+  else
+    {
+      shapes.push_back ("cube");
+      shapes.push_back ("cylinder");
+      shapes.push_back ("random");
+      shapes.push_back ("elongated");
+      shapes.push_back ("degenerate");
+    }
+
+  const size_t maxPoints = vm["max-points"].as<size_t> ();
+  const size_t fitMaxPoints = vm["fit-max-points"].as<size_t> ();
+  const size_t repeat = std::max (vm["repeat"].as<size_t> (),
+				  static_cast<size_t> (1));
+  const std::string solver = vm["solver"].as<std::string> ();
+
+  // Mesh sizes: 8, 64, ..., up to the maximum size.
+  std::vector<size_t> sizes;
+  for (size_t n = 8; n < maxPoints; n *= 8)
+    sizes.push_back (n);
+  sizes.push_back (maxPoints);
+
+  std::vector<Record> records;
+
+  try
+    {
+      for (size_t s = 0; s < shapes.size (); ++s)
+	for (size_t k = 0; k < sizes.size (); ++k)
+	  {
+	    generator_t generator (42);
+	    const polyhedron_t points = generateMesh (shapes[s], sizes[k],
+						      generator);
+	    const polyhedrons_t polyhedrons (1, points);
+
+	    std::cerr << shapes[s] << ": " << points.size () << " points"
+		      << std::endl;
+
+	    Record record;
+	    record.shape = shapes[s];
+	    record.points = points.size ();
+	    record.repeat = repeat;
+
+	    // Convex hull.
+	    size_t hullSize = 0;
+	    double best = 0.;
+	    for (size_t r = 0; r < repeat; ++r)
+	      {
+		double start = now ();
+		hullSize = convexHullFromPoints (points).size ();
+		double t = now () - start;
+		best = (r == 0) ? t : std::min (best, t);
+	      }
+	    std::stringstream extra;
+	    extra << ", \"hull_points\": " << hullSize;
+	    record.operation = "convexHullFromPoints";
+	    record.wallTime = best;
+	    record.extra = extra.str ();
+	    records.push_back (record);
+
+	    // PCA capsule.
+	    for (size_t r = 0; r < repeat; ++r)
+	      {
+		double start = now ();
+		Capsule capsule = capsuleFromPoints (points);
+		double t = now () - start;
+		best = (r == 0) ? t : std::min (best, t);
+		(void)capsule;
+	      }
+	    record.operation = "capsuleFromPoints";
+	    record.wallTime = best;
+	    record.extra.clear ();
+	    records.push_back (record);
+
+	    // Bounding capsule.
+	    point_t endPoint1, endPoint2;
+	    value_type radius = 0.;
+	    for (size_t r = 0; r < repeat; ++r)
+	      {
+		double start = now ();
+		computeBoundingCapsulePolyhedron (polyhedrons,
+						  endPoint1, endPoint2, radius);
+		double t = now () - start;
+		best = (r == 0) ? t : std::min (best, t);
+	      }
+	    record.operation = "computeBoundingCapsulePolyhedron";
+	    record.wallTime = best;
+	    records.push_back (record);
+
+	    // Optimal capsule.
+	    if (points.size () > fitMaxPoints)
+	      continue;
+
+	    size_t iterations = 0;
+	    value_type volume = 0.;
+	    int status = 0;
+	    for (size_t r = 0; r < repeat; ++r)
+	      {
+		Fitter fitter (polyhedrons, solver);
+		double start = now ();
+		fitter.computeBestFitCapsule ();
+		double t = now () - start;
+		best = (r == 0) ? t : std::min (best, t);
+
+		iterations = fitter.solverIterations ();
+		volume = fitter.solutionVolume ();
+		status = static_cast<int> (fitter.status ());
+	      }
+	    std::stringstream fitExtra;
+	    fitExtra << ", \"hull_points\": " << hullSize
+		     << ", \"iterations\": " << iterations
+		     << ", \"volume\": " << volume
+		     << ", \"status\": " << status;
+	    record.operation = "Fitter::computeBestFitCapsule";
+	    record.wallTime = best;
+	    record.extra = fitExtra.str ();
+	    records.push_back (record);
+	  }
+    }
+  catch (std::exception& e)
+    {
+      std::cerr << "Error: " << e.what () << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  std::ofstream output (vm["output"].as<std::string> ().c_str ());
+  output.precision (10);
+  benchmark::writeJson (output, "fitting", records);
+
+  return EXIT_SUCCESS;
+}
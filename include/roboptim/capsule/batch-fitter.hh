@@ -0,0 +1,195 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of BatchFitter class that computes the best
+ * fitting capsules of many independent polyhedron vectors in
+ * parallel.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_BATCH_FITTER_HH
+# define ROBOPTIM_CAPSULE_BATCH_FITTER_HH
+
+# include <string>
+# include <vector>
+
+# include <boost/function.hpp>
+# include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Batch capsule fitter class.
+    ///
+    /// This class fits one capsule per polyhedron vector, spreading
+    /// the independent fits over a pool of worker threads. Each fit
+    /// uses its own Fitter (and thus its own solver instance), so that
+    /// workers do not share any mutable state.
+    ///
+    /// With the default MUMPS linear solver, which is not reentrant,
+    /// the optimizations themselves are serialized: only the convex
+    /// hulls, the initial capsules and the problem setups run in
+    /// parallel. Select another linear solver in the options to
+    /// optimize in parallel (see FitterOptions::parameters).
+    class BatchFitter
+    {
+    public:
+      /// \brief Result of one fit.
+      struct result_t
+      {
+	/// \brief Initial capsule parameters.
+	argument_t initParam;
+
+	/// \brief Solution capsule parameters.
+	argument_t solutionParam;
+
+	/// \brief Capsule volume for initial parameters.
+	value_type initVolume;
+
+	/// \brief Capsule volume for solution parameters.
+	value_type solutionVolume;
+
+	/// \brief Status of the optimization.
+	GenericSolver::solutions status;
+
+	/// \brief Error message, empty unless status is SOLVER_ERROR.
+	std::string errorMessage;
+
+	/// \brief Statistics of the fit.
+	FitStats stats;
+
+	/// \brief Wall-clock time in seconds spent loading the problem,
+	/// 0 unless it was given by a loader.
+	double loadTime;
+
+	result_t ()
+	  : initParam (argument_t::Zero (7)),
+	    solutionParam (argument_t::Zero (7)),
+	    initVolume (0.),
+	    solutionVolume (0.),
+	    status (GenericSolver::SOLVER_NO_SOLUTION),
+	    errorMessage (),
+	    stats (),
+	    loadTime (0.)
+	{}
+      };
+
+      typedef std::vector<result_t> results_t;
+
+      /// \brief Callback loading the i-th problem.
+      ///
+      /// Loaders are called concurrently by the worker threads.
+      typedef boost::function<polyhedrons_t (size_t)> problemLoader_t;
+
+      /// \brief Constructor.
+      ///
+      /// \param solver nonlinear solver used by each fit.
+      /// \param nbThreads number of worker threads. If 0, the number
+      /// of hardware threads is used.
+      BatchFitter (std::string solver = "ipopt",
+		   size_t nbThreads = 0);
+
+      ~BatchFitter ();
+
+      /// \brief Get the number of worker threads.
+      size_t nbThreads () const;
+
+      /// \brief Set the number of worker threads (0 for the number of
+      /// hardware threads).
+      void nbThreads (size_t n);
+
+      /// \brief Get the optional solver log directory.
+      ///
+      /// If set, the solver output of the i-th fit is written to
+      /// "fit-i-ipopt.log" in this directory. Default: unset.
+      boost::optional<std::string>& solverLogDirectory ();
+      const boost::optional<std::string>& solverLogDirectory () const;
+
+      /// \brief Get the options of each fit.
+      ///
+      /// The solver log file of the options is ignored, since fits
+      /// run concurrently: use solverLogDirectory instead. Default:
+      /// FitterOptions::quiet ().
+      FitterOptions& options ();
+      const FitterOptions& options () const;
+
+      /// \brief Get the optional fit cache, shared by all the fits.
+      ///
+      /// \see Fitter::cache
+      boost::shared_ptr<FitCache>& cache ();
+      const boost::shared_ptr<FitCache>& cache () const;
+
+      /// \brief Whether sparse matrices are used by the solvers.
+      bool& useSparseMatrices ();
+      bool useSparseMatrices () const;
+
+      /// \brief Fit one capsule per polyhedron vector.
+      ///
+      /// Each fit runs Fitter::computeBestFitCapsule (), i.e. on the
+      /// convex hull of the polyhedrons and starting from their
+      /// bounding capsule. Errors are reported per fit and do not
+      /// interrupt the other fits.
+      ///
+      /// \param problems polyhedron vectors, one per capsule.
+      /// \return results, in the same order as the problems.
+      results_t fit (const std::vector<polyhedrons_t>& problems) const;
+
+      /// \brief Fit one capsule per problem, loading the problems in
+      /// the worker threads.
+      ///
+      /// Each problem is loaded right before its fit and released
+      /// afterwards, so that only nbThreads () problems are in memory
+      /// at once. Exceptions thrown by the loader are reported as
+      /// errors of the corresponding fit.
+      ///
+      /// \param nbProblems number of problems.
+      /// \param loader callback loading the i-th problem.
+      /// \return results, in the same order as the problems.
+      results_t fit (size_t nbProblems, const problemLoader_t& loader) const;
+
+    private:
+      /// \brief Run the fits, with either given or loaded problems.
+      results_t run (size_t nbProblems,
+		     const std::vector<polyhedrons_t>* problems,
+		     const problemLoader_t& loader) const;
+
+      /// \brief Nonlinear solver.
+      std::string solver_;
+
+      /// \brief Number of worker threads.
+      size_t nbThreads_;
+
+      /// \brief Optional solver log directory.
+      boost::optional<std::string> solverLogDir_;
+
+      /// \brief Options of each fit.
+      FitterOptions options_;
+
+      /// \brief Optional fit cache.
+      boost::shared_ptr<FitCache> cache_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_BATCH_FITTER_HH
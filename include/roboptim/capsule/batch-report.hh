@@ -0,0 +1,77 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of the structured reports of batch fits.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_BATCH_REPORT_HH
+# define ROBOPTIM_CAPSULE_BATCH_REPORT_HH
+
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <roboptim/capsule/batch-fitter.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Report formats.
+    enum ReportFormat
+      {
+	/// \brief JSON array, with one object per fit on each line.
+	REPORT_FORMAT_JSON,
+	/// \brief CSV table with a header line.
+	REPORT_FORMAT_CSV
+      };
+
+    /// \brief Get a report format from its name.
+    ///
+    /// \param name "json" or "csv".
+    /// \throw std::runtime_error if the name is unknown.
+    ReportFormat reportFormatFromString (const std::string& name);
+
+    /// \brief Get the name of a solver status.
+    ///
+    /// \return "no_solution", "solution", "solution_with_warnings" or
+    /// "error".
+    const char* solverStatusName (GenericSolver::solutions status);
+
+    /// \brief Write one record per fit.
+    ///
+    /// Each record holds the name of the fit, its status and error
+    /// message, the initial and solution parameters and volumes, and
+    /// the statistics of the fit (times in seconds, iterations,
+    /// constraint violation, cache hit).
+    ///
+    /// \param os output stream.
+    /// \param names names of the fits.
+    /// \param results results of the fits, in the same order.
+    /// \param format report format.
+    /// \throw std::runtime_error if names and results differ in size.
+    void writeBatchReport (std::ostream& os,
+			   const std::vector<std::string>& names,
+			   const BatchFitter::results_t& results,
+			   ReportFormat format);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_BATCH_REPORT_HH
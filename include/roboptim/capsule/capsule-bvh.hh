@@ -0,0 +1,201 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \brief Declaration of the bounding volume hierarchy over capsules.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_CAPSULE_BVH_HH
+# define ROBOPTIM_CAPSULE_CAPSULE_BVH_HH
+
+# include <vector>
+
+# include <boost/cstdint.hpp>
+
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Bounding volume hierarchy over capsules.
+    ///
+    /// The hierarchy is a binary tree of axis-aligned bounding boxes,
+    /// built top-down by median splits along the largest spread of the
+    /// capsule centers. Large subtrees are built by several threads.
+    ///
+    /// Nodes are stored in depth-first order in a single array: the
+    /// left child of an inner node follows it, so that each node only
+    /// stores the index of its right child. After a rigid motion of
+    /// the capsules, the boxes can be refitted without rebuilding the
+    /// tree.
+    ///
+    /// Queries traverse the tree with a fixed-size stack and do not
+    /// allocate memory, except for the indices they return.
+    class CapsuleBvh
+    {
+    public:
+      /// \brief Node of the hierarchy (56 bytes).
+      struct Node
+      {
+	/// \brief Bounding box of the capsules of the subtree.
+	point_t lower, upper;
+
+	/// \brief Index of the right child for inner nodes, index of the
+	/// first capsule in order () for leaves.
+	boost::uint32_t index;
+
+	/// \brief Number of capsules of a leaf, 0 for inner nodes.
+	boost::uint32_t count;
+
+	/// \brief Empty leaf with a degenerate box at the origin.
+	Node ()
+	  : lower (point_t::Zero ()),
+	    upper (point_t::Zero ()),
+	    index (0),
+	    count (0)
+	{}
+
+	bool isLeaf () const
+	{
+	  return count > 0;
+	}
+      };
+
+      typedef std::vector<Node> nodes_t;
+
+      /// \brief Maximum number of capsules per leaf.
+      static const size_type leafSize = 4;
+
+      /// \brief Empty hierarchy.
+      CapsuleBvh ();
+
+      /// \brief Build the hierarchy of the given capsules.
+      ///
+      /// \param capsules capsules.
+      /// \param nbThreads maximum number of threads used for the build.
+      /// If 0, the number of hardware threads is used.
+      explicit CapsuleBvh (const std::vector<Capsule>& capsules,
+			   size_t nbThreads = 0);
+
+      /// \brief Rebuild the hierarchy.
+      ///
+      /// \param capsules capsules.
+      /// \param nbThreads maximum number of threads used for the build.
+      /// If 0, the number of hardware threads is used.
+      void build (const std::vector<Capsule>& capsules,
+		  size_t nbThreads = 0);
+
+      /// \brief Replace a capsule, e.g. after a rigid motion.
+      ///
+      /// The boxes are only updated by refit ().
+      void capsule (size_type i, const Capsule& capsule);
+
+      /// \brief Update the boxes after the capsules moved.
+      ///
+      /// The tree is kept, so queries remain exact but get slower if
+      /// the capsules moved a lot relative to each other.
+      void refit ();
+
+      /// \brief Replace all the capsules and update the boxes.
+      ///
+      /// \param capsules capsules, as many as the hierarchy has.
+      void refit (const std::vector<Capsule>& capsules);
+
+      /// \brief Number of capsules.
+      size_type size () const;
+
+      /// \brief Get a capsule.
+      const Capsule& capsule (size_type i) const;
+
+      /// \brief Nodes of the hierarchy, the root first.
+      const nodes_t& nodes () const;
+
+      /// \brief Indices of the capsules, in the order of the leaves.
+      const std::vector<boost::uint32_t>& order () const;
+
+      /// \brief Whether a point is inside any capsule.
+      bool inside (const point_t& point) const;
+
+      /// \brief Find the capsules containing a point.
+      ///
+      /// \return indices sorted indices of the capsules.
+      void containing (const point_t& point,
+		       std::vector<size_type>& indices) const;
+
+      /// \brief Find the capsule nearest to a point.
+      ///
+      /// \return distance signed distance from the point to the
+      /// capsule surface, negative inside, or infinity if there is no
+      /// capsule.
+      /// \return index of the nearest capsule, or -1 if there is no
+      /// capsule.
+      size_type nearest (const point_t& point, value_type& distance) const;
+
+      /// \brief Whether a capsule overlaps any capsule of the hierarchy.
+      bool overlapsAny (const Capsule& capsule) const;
+
+      /// \brief Find the capsules overlapping a capsule.
+      ///
+      /// \return indices sorted indices of the capsules.
+      void overlapping (const Capsule& capsule,
+			std::vector<size_type>& indices) const;
+
+      /// \brief Find the first capsule hit by a ray.
+      ///
+      /// A ray starting inside a capsule hits it at distance 0.
+      ///
+      /// \param origin origin of the ray.
+      /// \param direction unit direction of the ray.
+      /// \param maxDistance length of the ray.
+      /// \return distance distance from the origin to the hit point.
+      /// \return index index of the capsule hit.
+      /// \return whether a capsule is hit.
+      bool raycast (const point_t& origin, const vector3_t& direction,
+		    value_type maxDistance,
+		    value_type& distance, size_type& index) const;
+
+    private:
+      /// \brief Capsules, in the input order.
+      std::vector<Capsule> capsules_;
+
+      /// \brief Capsule indices, in the order of the leaves.
+      std::vector<boost::uint32_t> order_;
+
+      /// \brief Nodes, in depth-first order.
+      nodes_t nodes_;
+    };
+
+    /// \brief Compute the distance along a ray to a capsule.
+    ///
+    /// \param origin origin of the ray.
+    /// \param direction unit direction of the ray.
+    /// \param capsule capsule.
+    /// \return distance distance from the origin to the first point of
+    /// the capsule, 0 if the origin is inside.
+    /// \return whether the ray hits the capsule.
+    bool rayCapsuleIntersection (const point_t& origin,
+				 const vector3_t& direction,
+				 const Capsule& capsule,
+				 value_type& distance);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_CAPSULE_BVH_HH
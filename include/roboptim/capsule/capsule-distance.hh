@@ -0,0 +1,196 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \brief Declaration of the capsule-capsule distance and overlap
+ * queries.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_HH
+# define ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_HH
+
+# include <utility>
+# include <vector>
+
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Pairs of capsules that are tested, e.g. to skip the
+    /// capsules of adjacent robot links.
+    ///
+    /// Entry (i, j) with i < j tells whether capsules i and j are
+    /// tested. An empty mask tests all pairs.
+    typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> pairMask_t;
+
+    /// \brief Pair of capsule indices.
+    typedef std::pair<size_type, size_type> capsulePair_t;
+
+    /// \brief Set of capsules, stored as a structure of arrays.
+    ///
+    /// Each capsule parameter (ax, ay, az, bx, by, bz, radius, in the
+    /// order of the solver parameters) is stored contiguously, so that
+    /// the batched queries load blocks of capsules into SIMD lanes
+    /// without gathering.
+    class CapsuleSet
+    {
+    public:
+      /// \brief Capsule parameters, one row per capsule.
+      typedef Eigen::Matrix<value_type, Eigen::Dynamic, 7> parameters_t;
+
+      /// \brief Empty set.
+      CapsuleSet ();
+
+      /// \brief Set of the given capsules.
+      explicit CapsuleSet (const std::vector<Capsule>& capsules);
+
+      /// \brief Add a capsule.
+      void add (const Capsule& capsule);
+
+      /// \brief Remove all the capsules.
+      void clear ();
+
+      /// \brief Number of capsules.
+      size_type size () const;
+
+      /// \brief Get a capsule.
+      Capsule capsule (size_type i) const;
+
+      /// \brief Replace a capsule, e.g. after a rigid motion.
+      void capsule (size_type i, const Capsule& capsule);
+
+      /// \brief Parameters of the capsules.
+      ///
+      /// Only the first size () rows are meaningful.
+      const parameters_t& parameters () const;
+
+    private:
+      /// \brief Parameters, with room for more capsules.
+      parameters_t parameters_;
+
+      /// \brief Number of capsules.
+      size_type size_;
+    };
+
+    /// \brief Compute the closest points of segments [p0,p1] and
+    /// [q0,q1].
+    ///
+    /// The closest points are \f$p_0 + s (p_1 - p_0)\f$ and
+    /// \f$q_0 + t (q_1 - q_0)\f$ with \f$s, t \in [0,1]\f$. Degenerate
+    /// segments are handled as points, with projectionParameterOnSegment.
+    /// For parallel segments, one of the closest pairs is returned.
+    ///
+    /// \return s parameter of the closest point on [p0,p1].
+    /// \return t parameter of the closest point on [q0,q1].
+    /// \return distance between the segments.
+    value_type closestPointsOnSegments (const point_t& p0,
+					const point_t& p1,
+					const point_t& q0,
+					const point_t& q1,
+					value_type& s,
+					value_type& t);
+
+    /// \brief Compute the distance between segments [p0,p1] and
+    /// [q0,q1].
+    value_type distanceSegmentToSegment (const point_t& p0,
+					 const point_t& p1,
+					 const point_t& q0,
+					 const point_t& q1);
+
+    /// \brief Compute the signed distance between two capsules.
+    ///
+    /// \return distance between the capsule surfaces, negative if they
+    /// overlap.
+    value_type distanceCapsuleToCapsule (const Capsule& a,
+					 const Capsule& b);
+
+    /// \brief Whether two capsules overlap (or touch).
+    bool capsulesOverlap (const Capsule& a, const Capsule& b);
+
+    /// \brief Compute the signed distances from a capsule to many
+    /// capsules.
+    ///
+    /// Capsules are processed by blocks whose parameters are loaded
+    /// into SIMD lanes, as in distancesPointsToSegment.
+    ///
+    /// \param capsule capsule.
+    /// \param capsules capsules.
+    /// \return distances signed distance to each capsule.
+    void distancesCapsuleToCapsules (const Capsule& capsule,
+				     const CapsuleSet& capsules,
+				     Eigen::Ref<vector_t> distances);
+
+    /// \brief Compute the signed distances between pairs of capsules.
+    ///
+    /// The i-th distance is the distance between the i-th capsules of
+    /// both sets, which must have the same size.
+    ///
+    /// \return distances signed distance of each pair.
+    void distancesCapsulePairs (const CapsuleSet& first,
+				const CapsuleSet& second,
+				Eigen::Ref<vector_t> distances);
+
+    /// \brief Whether a capsule overlaps any of many capsules.
+    ///
+    /// The query returns as soon as a block of capsules contains an
+    /// overlap, and does not compute any square root.
+    bool overlapsAny (const Capsule& capsule, const CapsuleSet& capsules);
+
+    /// \brief Find the capsules overlapping a capsule.
+    ///
+    /// \return indices sorted indices of the overlapping capsules.
+    void overlappingCapsules (const Capsule& capsule,
+			      const CapsuleSet& capsules,
+			      std::vector<size_type>& indices);
+
+    /// \brief Compute the signed distances between all the pairs of a
+    /// set of capsules.
+    ///
+    /// \param capsules capsules.
+    /// \param mask pairs tested, or an empty mask for all pairs.
+    /// \return distances symmetric matrix of distances, with infinity
+    /// on the diagonal and for the pairs that are not tested.
+    void selfDistances (const CapsuleSet& capsules,
+			const pairMask_t& mask,
+			matrix_t& distances);
+
+    /// \brief Find the overlapping pairs of a set of capsules.
+    ///
+    /// \param capsules capsules.
+    /// \param mask pairs tested, or an empty mask for all pairs.
+    /// \return pairs overlapping pairs (i, j) with i < j, in
+    /// lexicographic order.
+    void selfOverlaps (const CapsuleSet& capsules,
+		       const pairMask_t& mask,
+		       std::vector<capsulePair_t>& pairs);
+
+    /// \brief Whether any pair of a set of capsules overlaps.
+    ///
+    /// The query returns as soon as an overlap is found.
+    ///
+    /// \param capsules capsules.
+    /// \param mask pairs tested, or an empty mask for all pairs.
+    bool selfOverlapsAny (const CapsuleSet& capsules, const pairMask_t& mask);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_HH
@@ -0,0 +1,148 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of DirectFitter class that computes the best
+ * fitting capsule of a polyhedron without a nonlinear solver.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DIRECT_FITTER_HH
+# define ROBOPTIM_CAPSULE_DIRECT_FITTER_HH
+
+# include <roboptim/core/io.hh>
+
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Compute the minimum-volume capsule with a given axis
+    /// direction.
+    ///
+    /// The points are projected on the plane orthogonal to the
+    /// direction: the axis goes through the center of the minimum
+    /// enclosing circle of the projections, whose radius is a lower
+    /// bound of the capsule radius. For a given radius, the end points
+    /// follow from the extreme points along the axis, and the radius
+    /// is then chosen to minimize the volume.
+    ///
+    /// \param points points contained in the capsule.
+    /// \param direction unit axis direction.
+    /// \return param capsule parameters (see convertCapsuleToSolverParam).
+    /// \return volume of the capsule.
+    value_type bestCapsuleAlongDirection (const std::vector<point_t>& points,
+					  const vector3_t& direction,
+					  argument_ref param);
+
+    /// \brief Direct capsule fitter class.
+    ///
+    /// This class computes the minimum-volume capsule over a polyhedron
+    /// vector without any nonlinear solver. Since the best capsule for
+    /// a fixed axis direction is given by bestCapsuleAlongDirection,
+    /// only the direction needs to be searched: directions evenly
+    /// spread on the unit sphere and the principal axes of the points
+    /// are evaluated, then the best ones are refined with a pattern
+    /// search on the sphere.
+    ///
+    /// The result contains all the points, and its volume is usually
+    /// equal to or lower than the one found by Fitter.
+    class DirectFitter
+    {
+    public:
+      /// \brief Constructor.
+      explicit DirectFitter (const polyhedrons_t& polyhedrons);
+
+      ~DirectFitter ();
+
+      /// \brief Get polyhedron attribute.
+      const polyhedrons_t polyhedrons () const;
+
+      /// \brief Set polyhedron attribute.
+      void polyhedrons (const polyhedrons_t& polyhedrons);
+
+      /// \brief Number of directions sampled on the half unit sphere.
+      ///
+      /// Default: 256.
+      size_t& nbDirections ();
+      size_t nbDirections () const;
+
+      /// \brief Number of sampled directions refined by the pattern
+      /// search.
+      ///
+      /// Default: 3.
+      size_t& nbRefinedDirections ();
+      size_t nbRefinedDirections () const;
+
+      /// \brief Angular step (in radians) below which the refinement
+      /// of a direction stops.
+      ///
+      /// Default: 1e-6.
+      value_type& angularTolerance ();
+      value_type angularTolerance () const;
+
+      /// \brief Get capsule volume for solution parameters.
+      value_type solutionVolume () const;
+
+      /// \brief Get solution capsule parameters.
+      const argument_t& solutionParam () const;
+
+      /// \brief Compute best fitting capsule over polyhedron vector.
+      ///
+      /// The search runs on the convex hull of the polyhedrons.
+      void computeBestFitCapsule ();
+
+    private:
+      /// \brief Polyhedron vector attribute.
+      polyhedrons_t polyhedrons_;
+
+      /// \brief Number of directions sampled on the half unit sphere.
+      size_t nbDirections_;
+
+      /// \brief Number of sampled directions that are refined.
+      size_t nbRefinedDirections_;
+
+      /// \brief Angular tolerance of the refinement.
+      value_type angularTolerance_;
+
+      /// \brief Solution volume attribute.
+      value_type solutionVolume_;
+
+      /// \brief Capsule solution parameters attribute.
+      argument_t solutionParam_;
+    };
+
+    /// \brief Print direct fitter after optimal capsule has been
+    /// computed.
+    inline std::ostream& operator<< (std::ostream& os,
+				     const DirectFitter& fitter)
+    {
+      using namespace roboptim;
+      using roboptim::operator <<;
+
+      os << "Capsule parameters:" << incindent;
+      os << iendl << "Solution parameters: " << fitter.solutionParam ();
+      os << iendl << "Solution volume: " << fitter.solutionVolume ();
+      os << decendl;
+
+      return os;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DIRECT_FITTER_HH
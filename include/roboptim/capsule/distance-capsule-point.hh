@@ -24,7 +24,7 @@
 #ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINT_HH
 # define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINT_HH
 
-# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/twice-differentiable-function.hh>
 
 # include <roboptim/capsule/types.hh>
 
@@ -34,7 +34,7 @@ namespace roboptim
   {
     /// \brief Distance to point RobOptim function.
     class DistanceCapsulePoint
-      : public roboptim::DifferentiableFunction
+      : public roboptim::TwiceDifferentiableFunction
     {
     public:
       /// \brief Constructor.
@@ -76,6 +76,18 @@ namespace roboptim
 		     const_argument_ref argument,
 		     size_type functionId = 0) const;
 
+      /// \brief Compute of the distance hessian with respect to the
+      /// capsule parameters.
+      ///
+      /// \param argument vector containing the capsule parameters. It
+      /// contains in this order: the segment first end point
+      /// coordinates, the segment second end point coordinates, the
+      /// capsule radius.
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+
     private:
       /// \brief Point attribute.
       point_t point_;
@@ -0,0 +1,136 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of DistanceCapsulePoints class that computes
+ * the distances between a capsule and a set of points.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
+# define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
+
+# include <roboptim/core/twice-differentiable-function.hh>
+
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Distance to a set of points RobOptim function.
+    ///
+    /// This is the vectorized version of DistanceCapsulePoint: the
+    /// i-th output is the distance between the capsule and the i-th
+    /// point. All points are stored in a contiguous 3xN matrix, so
+    /// that the N distances and the Nx7 jacobian are computed in a
+    /// single pass.
+    ///
+    /// With sparse matrices, the 7 entries of each jacobian row are
+    /// always stored, even when they are zero, so that the jacobian
+    /// structure does not change between evaluations.
+    ///
+    /// \tparam T matrix type (dense or sparse).
+    template <typename T>
+    class GenericDistanceCapsulePoints
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (roboptim::GenericTwiceDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      ///
+      /// \param points 3xN matrix whose columns are the points that
+      /// will be used in computing distances, e.g. a points_t or a
+      /// pointsMap view.
+      GenericDistanceCapsulePoints (const_points_ref points,
+				    std::string name
+				    = "distance to points");
+
+      /// \brief Constructor.
+      ///
+      /// \param polyhedrons vector of polyhedrons whose vertices are
+      /// the points that will be used in computing distances.
+      GenericDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+				    std::string name
+				    = "distance to points");
+
+      ~GenericDistanceCapsulePoints ();
+
+      /// \brief Get points attribute.
+      virtual const points_t& points () const;
+
+    protected:
+      /// \brief Computes the distances from capsule to the points.
+      ///
+      /// If a result is negative, the corresponding point is inside
+      /// the capsule, otherwise it is outside the capsule.
+      ///
+      /// \param argument vector containing the capsule parameters. It
+      /// contains in this order: the segment first end point
+      /// coordinates, the segment second end point coordinates, the
+      /// capsule radius.
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      /// \brief Compute the gradient of one distance with respect to
+      /// the capsule parameters.
+      ///
+      /// \param argument vector containing the capsule parameters.
+      /// \param functionId index of the point.
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      /// \brief Compute the jacobian of all distances with respect to
+      /// the capsule parameters.
+      ///
+      /// \param argument vector containing the capsule parameters.
+      virtual void
+      impl_jacobian (jacobian_ref jacobian,
+		     const_argument_ref argument) const;
+
+      /// \brief Compute the hessian of one distance with respect to
+      /// the capsule parameters.
+      ///
+      /// \param argument vector containing the capsule parameters.
+      /// \param functionId index of the point.
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+
+    private:
+      /// \brief Points attribute.
+      points_t points_;
+    };
+
+    /// \brief Distance to a set of points with dense matrices.
+    typedef GenericDistanceCapsulePoints<roboptim::EigenMatrixDense>
+    DistanceCapsulePoints;
+
+    /// \brief Distance to a set of points with sparse matrices.
+    typedef GenericDistanceCapsulePoints<roboptim::EigenMatrixSparse>
+    SparseDistanceCapsulePoints;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
@@ -0,0 +1,144 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of FitCache class that stores fitted capsules on
+ * disk.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_FIT_CACHE_HH
+# define ROBOPTIM_CAPSULE_FIT_CACHE_HH
+
+# include <string>
+
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/scoped_ptr.hpp>
+# include <boost/thread/mutex.hpp>
+
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class mapped_region;
+  } // end of namespace interprocess.
+} // end of namespace boost.
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Persistent cache of fitted capsules.
+    ///
+    /// Fits are indexed by a hash of the polyhedrons, the solver and
+    /// the options that affect the solution. Records are appended to a
+    /// binary file, which is memory-mapped for lookups: the latest
+    /// record of a key wins, and a record partially written (e.g. by
+    /// an interrupted process) is ignored.
+    ///
+    /// A cache can be shared by several fitters and threads.
+    class FitCache : private boost::noncopyable
+    {
+    public:
+      /// \brief Type of the cache keys.
+      typedef boost::uint64_t key_t;
+
+      /// \brief Cached fit.
+      struct entry_t
+      {
+	/// \brief Initial capsule parameters.
+	argument_t initParam;
+
+	/// \brief Capsule volume for initial parameters.
+	value_type initVolume;
+
+	/// \brief Solution capsule parameters.
+	argument_t solutionParam;
+
+	/// \brief Capsule volume for solution parameters.
+	value_type solutionVolume;
+
+	entry_t ()
+	  : initParam (argument_t::Zero (7)),
+	    initVolume (0.),
+	    solutionParam (argument_t::Zero (7)),
+	    solutionVolume (0.)
+	{}
+      };
+
+      /// \brief Open a cache file, or create it if it does not exist.
+      ///
+      /// \param path path of the cache file.
+      /// \throw std::runtime_error if the file cannot be created or is
+      /// not a cache file.
+      explicit FitCache (const std::string& path);
+
+      ~FitCache ();
+
+      /// \brief Path of the cache file.
+      const std::string& path () const;
+
+      /// \brief Compute the key of a fit.
+      ///
+      /// The key is a 64-bit FNV-1a hash of the point coordinates, of
+      /// the polyhedron sizes, of the solver name, and of the options
+      /// affecting the solution (solver parameters, sparse matrices
+      /// and active-set strategy). Log files, verbosity and the solver
+      /// parameters only affecting the output ("ipopt.print_*",
+      /// "ipopt.file_print_level", "ipopt.output_file", "ipopt.sb" and
+      /// "ipopt.derivative_test*") are not part of the key.
+      static key_t key (const polyhedrons_t& polyhedrons,
+			const std::string& solver,
+			const FitterOptions& options);
+
+      /// \brief Find a fit.
+      ///
+      /// \param key key of the fit.
+      /// \return entry cached fit.
+      /// \return whether the fit was found.
+      bool find (key_t key, entry_t& entry) const;
+
+      /// \brief Append a fit to the cache file.
+      void insert (key_t key, const entry_t& entry);
+
+      /// \brief Number of records in the cache file.
+      size_t size () const;
+
+    private:
+      /// \brief Map the cache file again if it grew.
+      void remap () const;
+
+      /// \brief Path of the cache file.
+      std::string path_;
+
+      /// \brief Mapped cache file.
+      mutable boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+
+      /// \brief Size of the mapped file.
+      mutable size_t mappedSize_;
+
+      /// \brief Mutex protecting the mapping and the appends.
+      mutable boost::mutex mutex_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_FIT_CACHE_HH
@@ -24,29 +24,200 @@
 #ifndef ROBOPTIM_CAPSULE_FITTER_HH
 # define ROBOPTIM_CAPSULE_FITTER_HH
 
+# include <map>
+# include <string>
+
+# include <boost/function.hpp>
 # include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
 
+# include <roboptim/core/solver.hh>
 # include <roboptim/core/solver-factory.hh>
 
+# include <roboptim/capsule/fwd.hh>
 # include <roboptim/capsule/types.hh>
 # include <roboptim/capsule/volume.hh>
 # include <roboptim/capsule/distance-capsule-point.hh>
+# include <roboptim/capsule/distance-capsule-points.hh>
 
 namespace roboptim
 {
   namespace capsule
   {
+    /// \brief Options of a capsule fitting.
+    ///
+    /// Two presets are provided: quiet () for production use, and
+    /// debug () for solver diagnostics. Any solver parameter can then
+    /// be overridden through the parameters map.
+    struct FitterOptions
+    {
+      /// \brief Solver parameters, indexed by name (e.g. "ipopt.tol").
+      typedef std::map<std::string, Parameter::parameterValues_t>
+      parameters_t;
+
+      /// \brief Solver parameters, applied on top of the default
+      /// parameters of the fitter (tolerances, linear solver, exact
+      /// hessians).
+      ///
+      /// The default linear solver ("ipopt.linear_solver") is MUMPS,
+      /// which is not reentrant: concurrent optimizations using it
+      /// are serialized. Select another linear solver, e.g. "ma27"
+      /// if Ipopt is built with the HSL solvers, to optimize in
+      /// parallel.
+      parameters_t parameters;
+
+      /// \brief Optional solver log file.
+      ///
+      /// If set, Ipopt writes its output to this file. Each fitter
+      /// running concurrently should use its own file.
+      boost::optional<std::string> solverLogFile;
+
+      /// \brief Whether sparse matrices are used by the solver.
+      bool useSparseMatrices;
+
+      /// \brief Whether the active-set strategy is used.
+      bool useActiveSet;
+
+      /// \brief Whether the points deep inside the initial capsule are
+      /// pruned before the optimization.
+      bool usePruning;
+
+      /// \brief Depth inside the initial capsule, relative to its
+      /// radius, beyond which a point is pruned.
+      value_type pruningDepth;
+
+      /// \brief Whether the fitter prints the outcome of each
+      /// optimization.
+      bool verbose;
+
+      FitterOptions ()
+	: parameters (),
+	  solverLogFile (),
+	  useSparseMatrices (false),
+	  useActiveSet (false),
+	  usePruning (false),
+	  pruningDepth (0.1),
+	  verbose (false)
+      {}
+
+      /// \brief Production preset.
+      ///
+      /// Ipopt prints nothing, no derivative test is run and no log
+      /// file is written. This is the default.
+      static FitterOptions quiet ();
+
+      /// \brief Debug preset.
+      ///
+      /// Ipopt prints its progress (print level 5) to the console and
+      /// to "fitter-ipopt.log", checks the gradients against finite
+      /// differences before solving and prints the user options.
+      static FitterOptions debug ();
+    };
+
+    /// \brief Statistics of a capsule fitting.
+    ///
+    /// Times are wall-clock times in seconds. Evaluation counts are
+    /// summed over the cost (capsule volume) and over the constraints
+    /// (distances to the points).
+    struct FitStats
+    {
+      /// \brief Time spent computing the convex hull.
+      double hullTime;
+
+      /// \brief Time spent computing the initial guess.
+      double initTime;
+
+      /// \brief Time spent solving the optimization problems.
+      double solveTime;
+
+      /// \brief Number of cost evaluations.
+      size_t costEvaluations;
+
+      /// \brief Number of cost gradient evaluations.
+      size_t costGradientEvaluations;
+
+      /// \brief Number of cost hessian evaluations.
+      size_t costHessianEvaluations;
+
+      /// \brief Number of constraint evaluations.
+      size_t constraintEvaluations;
+
+      /// \brief Number of constraint jacobian evaluations.
+      size_t constraintJacobianEvaluations;
+
+      /// \brief Number of constraint hessian evaluations.
+      size_t constraintHessianEvaluations;
+
+      /// \brief Number of solver iterations.
+      size_t iterations;
+
+      /// \brief Number of points left out of the optimization problems
+      /// by the pruning stage.
+      size_t prunedPoints;
+
+      /// \brief Largest constraint violation of the solution, i.e.
+      /// distance from the capsule to the furthest point outside.
+      value_type constraintViolation;
+
+      /// \brief Status of the optimization.
+      GenericSolver::solutions status;
+
+      /// \brief Whether the solution was read from the fit cache, in
+      /// which case no optimization was run.
+      bool cached;
+
+      FitStats ()
+	: hullTime (0.),
+	  initTime (0.),
+	  solveTime (0.),
+	  costEvaluations (0),
+	  costGradientEvaluations (0),
+	  costHessianEvaluations (0),
+	  constraintEvaluations (0),
+	  constraintJacobianEvaluations (0),
+	  constraintHessianEvaluations (0),
+	  iterations (0),
+	  prunedPoints (0),
+	  constraintViolation (0.),
+	  status (GenericSolver::SOLVER_NO_SOLUTION),
+	  cached (false)
+      {}
+    };
+
     /// \brief Capsule fitter class.
     ///
     /// This class computes the best fitting capsule over a
     /// polyhedron.
+    ///
+    /// Several fitters can run concurrently, provided that they do not
+    /// share their solver log file. Since MUMPS is not reentrant,
+    /// concurrent optimizations using it are serialized; other linear
+    /// solvers run in parallel.
     class Fitter
     {
     public:
+      /// \brief Callback called with the statistics of each fit.
+      typedef boost::function<void (const FitStats&)> statsCallback_t;
+
+      /// \brief Callback called around each evaluation of the cost or
+      /// of the constraints, with true before the evaluation and false
+      /// after it.
+      typedef boost::function<void (bool)> evaluationCallback_t;
+
       /// \brief Constructor.
       Fitter (const polyhedrons_t& polyhedrons,
               std::string solver = "ipopt");
 
+      /// \brief Constructor from a matrix of points.
+      ///
+      /// The points are stored as a single polyhedron.
+      ///
+      /// \param points points, as the columns of a matrix, e.g. a
+      /// points_t or a pointsMap view over a caller buffer.
+      /// \param solver nonlinear solver.
+      Fitter (const_points_ref points,
+              std::string solver = "ipopt");
+
       ~Fitter ();
 
       /// \brief Get polyhedron attribute.
@@ -67,10 +238,126 @@ namespace roboptim
       /// \brief Get solution capsule parameters.
       const argument_t& solutionParam () const;
 
+      /// \brief Get the status of the last optimization.
+      ///
+      /// SOLVER_NO_SOLUTION is returned if no optimization was run.
+      GenericSolver::solutions status () const;
+
+      /// \brief Get the error message of the last optimization.
+      ///
+      /// The message is empty unless status () is SOLVER_ERROR.
+      const std::string& errorMessage () const;
+
+      /// \brief Get the number of solver iterations of the last
+      /// optimization.
+      ///
+      /// With the active-set strategy, iterations of all the
+      /// optimization problems are summed. Iterations are counted with
+      /// the solver iteration callback, which is taken over by the
+      /// optimization logger: the count is 0 if a log directory is set.
+      size_t solverIterations () const;
+
+      /// \brief Get the statistics of the last fit.
+      ///
+      /// The hull and initial guess times are only measured by
+      /// computeBestFitCapsule ().
+      const FitStats& stats () const;
+
+      /// \brief Optional callback called with the statistics at the
+      /// end of each fit.
+      statsCallback_t& statsCallback ();
+      const statsCallback_t& statsCallback () const;
+
+      /// \brief Optional callback called around each evaluation of the
+      /// cost, of the constraints and of their derivatives.
+      ///
+      /// It delimits the time spent in the functions of the problem,
+      /// e.g. to profile them or to check that they do not allocate.
+      /// It is not part of the fit cache key.
+      evaluationCallback_t& evaluationCallback ();
+      const evaluationCallback_t& evaluationCallback () const;
+
       /// \brief Get the optional optimization log directory.
       boost::optional<std::string>& logDirectory ();
       const boost::optional<std::string>& logDirectory () const;
 
+      /// \brief Get the fitting options.
+      ///
+      /// Default: FitterOptions::quiet ().
+      FitterOptions& options ();
+      const FitterOptions& options () const;
+
+      /// \brief Get the optional fit cache.
+      ///
+      /// If set, computeBestFitCapsule () first looks the polyhedrons,
+      /// solver and options up in the cache, and only runs the
+      /// optimization if they are not found. Successful fits are then
+      /// added to the cache. Default: unset.
+      boost::shared_ptr<FitCache>& cache ();
+      const boost::shared_ptr<FitCache>& cache () const;
+
+      /// \brief Get the optional solver log file.
+      ///
+      /// \see FitterOptions::solverLogFile
+      boost::optional<std::string>& solverLogFile ();
+      const boost::optional<std::string>& solverLogFile () const;
+
+      /// \brief Whether sparse matrices are used by the solver.
+      ///
+      /// Sparse matrices let large problems use Ipopt's sparse
+      /// linear algebra. If the solver is "ipopt", the "ipopt-sparse"
+      /// plugin is used instead. Default: false.
+      ///
+      /// \see FitterOptions::useSparseMatrices
+      bool& useSparseMatrices ();
+      bool useSparseMatrices () const;
+
+      /// \brief Whether the active-set strategy is used.
+      ///
+      /// Instead of constraining every point at once, the capsule is
+      /// first fitted over a few extreme points (see activeSetSeed).
+      /// The points left outside of the solution are then added to the
+      /// constraints, and the problem is solved again from the previous
+      /// solution, until all points are inside the capsule. Since only
+      /// a few points bind at the optimum, the optimization problems
+      /// are much smaller. Default: false.
+      ///
+      /// \see FitterOptions::useActiveSet
+      bool& useActiveSet ();
+      bool useActiveSet () const;
+
+      /// \brief Whether the points deep inside the initial capsule are
+      /// pruned.
+      ///
+      /// Before the optimization, the points deeper than pruningDepth
+      /// times the radius inside the initial capsule are removed from
+      /// the constraints, since the capsule mostly shrinks from there.
+      /// Once solved, the pruned points are checked against the
+      /// solution: those left outside are restored and the problem is
+      /// solved again from the previous solution, so that the solution
+      /// always contains all the points. The number of points finally
+      /// pruned is given by FitStats::prunedPoints. Default: false.
+      ///
+      /// \see FitterOptions::usePruning
+      bool& usePruning ();
+      bool usePruning () const;
+
+      /// \brief Get the number of points constraining the last
+      /// optimization problem.
+      ///
+      /// Without the active-set strategy, this is the total number of
+      /// points.
+      size_t activeSetSize () const;
+
+      /// \brief Compute best fitting capsule over polyhedron.
+      ///
+      /// Polyhedron vector attribute is used to compute capsule and set
+      /// capsuleParam attribute. The optimization runs on the convex
+      /// hull of the polyhedrons and starts from their bounding
+      /// capsule (see computeBoundingCapsulePolyhedron). If a fit
+      /// cache is set, it is used before and after the optimization.
+      void computeBestFitCapsule ();
+
       /// \brief Compute best fitting capsule over polyhedron.
       ///
       /// Polyhedron vector attribute is used to compute capsule and set
@@ -108,6 +395,20 @@ namespace roboptim
 						   const_argument_ref
 						   initParam);
 
+      /// \brief Refit the capsule after the polyhedrons changed.
+      ///
+      /// The polyhedron attribute is replaced, and the previous
+      /// solution is used as a warm start, with its radius enlarged so
+      /// that it contains the new points. If all the new points are
+      /// inside the current capsule and the points binding the current
+      /// solution are still present, the volume cannot decrease and the
+      /// current capsule is kept without solving. Without a previous
+      /// solution, this is equivalent to computeBestFitCapsule ().
+      ///
+      /// \param polyhedrons new polyhedron vector.
+      /// \return whether an optimization was run.
+      bool refit (const polyhedrons_t& polyhedrons);
+
     protected:
       /// \brief Implementation of best fitting capsule computation.
       /// \param polyhedrons Polyhedron vector over which the capsule is
@@ -119,6 +420,71 @@ namespace roboptim
 					    argument_ref solutionParam);
 
     private:
+      /// \brief Check the solution against all the points.
+      ///
+      /// The constraint violation statistics and the points binding
+      /// the solution are updated.
+      void checkSolution (const polyhedrons_t& polyhedrons,
+			  const_argument_ref solutionParam);
+
+      /// \brief Whether all the points binding the last solution are
+      /// in the given polyhedrons.
+      bool containsActivePoints (const polyhedrons_t& polyhedrons) const;
+
+      /// \brief Solve the problem over the points that are not deep
+      /// inside the initial capsule.
+      ///
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param initParam initial capsule parameters
+      /// \return solutionParam solution capsule parameters
+      void solvePruned (const polyhedrons_t& polyhedrons,
+			const_argument_ref initParam,
+			argument_ref solutionParam);
+
+      /// \brief Solve the problem with the active-set strategy if
+      /// enabled, or over all the points.
+      ///
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param initParam initial capsule parameters
+      /// \return solutionParam solution capsule parameters
+      void solvePoints (const polyhedrons_t& polyhedrons,
+			const_argument_ref initParam,
+			argument_ref solutionParam);
+
+      /// \brief Solve the problem with the active-set strategy.
+      ///
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param initParam initial capsule parameters
+      /// \return solutionParam solution capsule parameters
+      void solveActiveSet (const polyhedrons_t& polyhedrons,
+			   const_argument_ref initParam,
+			   argument_ref solutionParam);
+
+      /// \brief Solve the problem with dense or sparse matrices.
+      ///
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param initParam initial capsule parameters
+      /// \return solutionParam solution capsule parameters
+      void solveProblem (const polyhedrons_t& polyhedrons,
+			 const_argument_ref initParam,
+			 argument_ref solutionParam);
+
+      /// \brief Build and solve the optimization problem.
+      ///
+      /// \tparam T matrix type used by the solver (dense or sparse).
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param initParam initial capsule parameters
+      /// \return solutionParam solution capsule parameters
+      template <typename T>
+      void solve (const polyhedrons_t& polyhedrons,
+		  const_argument_ref initParam,
+		  argument_ref solutionParam);
+
       /// \brief Polyhedron vector attribute.
       polyhedrons_t polyhedrons_;
 
@@ -139,6 +505,36 @@ namespace roboptim
 
       /// \brief Optional optimization log directory.
       boost::optional<std::string> logDir_;
+
+      /// \brief Fitting options.
+      FitterOptions options_;
+
+      /// \brief Optional fit cache.
+      boost::shared_ptr<FitCache> cache_;
+
+      /// \brief Number of points constraining the last optimization.
+      size_t activeSetSize_;
+
+      /// \brief Points binding the last solution.
+      polyhedron_t activePoints_;
+
+      /// \brief Whether the next optimization is warm-started.
+      bool warmStart_;
+
+      /// \brief Status of the last optimization.
+      GenericSolver::solutions status_;
+
+      /// \brief Error message of the last optimization.
+      std::string errorMessage_;
+
+      /// \brief Statistics of the last fit.
+      FitStats stats_;
+
+      /// \brief Optional statistics callback.
+      statsCallback_t statsCallback_;
+
+      /// \brief Optional evaluation callback.
+      evaluationCallback_t evaluationCallback_;
     };
 
     /// \brief Print fitter after optimal capsule has been computed.
@@ -22,13 +22,38 @@
 #ifndef KCD_ROBOPTIM_FWD_HH
 # define KCD_ROBOPTIM_FWD_HH
 
+# include <roboptim/core/fwd.hh>
+
 namespace roboptim
 {
   namespace capsule
   {
-    class Volume;
+    template <typename T>
+    class GenericVolume;
+    typedef GenericVolume<EigenMatrixDense> Volume;
+    typedef GenericVolume<EigenMatrixSparse> SparseVolume;
+
     class DistanceCapsulePoint;
+
+    template <typename T>
+    class GenericGeometry;
+    typedef GenericGeometry<double> Geometry;
+    typedef GenericGeometry<float> FloatGeometry;
+
+    template <typename T>
+    class GenericDistanceCapsulePoints;
+    typedef GenericDistanceCapsulePoints<EigenMatrixDense>
+    DistanceCapsulePoints;
+    typedef GenericDistanceCapsulePoints<EigenMatrixSparse>
+    SparseDistanceCapsulePoints;
+
     class Fitter;
+    class BatchFitter;
+    class DirectFitter;
+    class MultiFitter;
+    class FitCache;
+    class CapsuleSet;
+    class CapsuleBvh;
   } // end of namespace capsule.
 } // end of namespace kcd.
 
@@ -0,0 +1,219 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \brief Declaration of the geometry functions templated on the scalar
+ * type.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_GEOMETRY_HH
+# define ROBOPTIM_CAPSULE_GEOMETRY_HH
+
+# include <limits>
+
+# include <Eigen/Core>
+
+# include <roboptim/capsule/fwd.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Geometry functions on points stored with scalar type T.
+    ///
+    /// These are the streaming functions that preprocess point clouds
+    /// before the optimization: distances and projections on segments,
+    /// extremes along a direction, statistics and bounding capsules.
+    /// They are instantiated for double (Geometry), which backs the
+    /// functions of util.hh, and for float (FloatGeometry): single
+    /// precision halves the memory traffic and doubles the number of
+    /// lanes of each SIMD instruction.
+    ///
+    /// The optimization itself (Fitter) always runs in double
+    /// precision. A capsule computed in single precision is turned
+    /// into a conservative double precision capsule by
+    /// boundingCapsule (FloatGeometry::const_points_ref), which can
+    /// then be polished by the fitter.
+    template <typename T>
+    class GenericGeometry
+    {
+    public:
+      typedef T value_type;
+      typedef Eigen::Matrix<value_type, 3, 1> point_t;
+      typedef Eigen::Matrix<value_type, 3, 1> vector3_t;
+      typedef Eigen::Matrix<value_type, 3, 3> matrix3_t;
+      typedef Eigen::Matrix<value_type, 3, Eigen::Dynamic> points_t;
+      typedef Eigen::Ref<const points_t> const_points_ref;
+      typedef Eigen::Matrix<value_type, Eigen::Dynamic, 1> vector_t;
+
+      /// \brief Capsule with scalar type T.
+      struct capsule_t
+      {
+	/// \brief End points of the segment.
+	point_t P0, P1;
+
+	/// \brief Radius.
+	value_type radius;
+      };
+
+      /// \brief Unit roundoff of the scalar type, i.e. the largest
+      /// relative error of a rounded operation.
+      static value_type unitRoundoff ()
+      {
+	return std::numeric_limits<value_type>::epsilon () / 2;
+      }
+
+      /// \brief Compute the distance from point p to segment [a,b].
+      ///
+      /// \see capsule::distancePointToSegment
+      static value_type distancePointToSegment (const point_t& p,
+						const point_t& a,
+						const point_t& b);
+
+      /// \brief Compute the projection of point p on segment [a,b].
+      ///
+      /// \see capsule::projectionOnSegment
+      static point_t projectionOnSegment (const point_t& p,
+					  const point_t& a,
+					  const point_t& b);
+
+      /// \brief Compute the parameter of the projection of point p on
+      /// segment [a,b].
+      ///
+      /// \see capsule::projectionParameterOnSegment
+      static value_type projectionParameterOnSegment (const point_t& p,
+						      const point_t& a,
+						      const point_t& b);
+
+      /// \brief Compute the distances from many points to segment [a,b].
+      ///
+      /// \see capsule::distancesPointsToSegment
+      static void distancesPointsToSegment (const_points_ref points,
+					    const point_t& a,
+					    const point_t& b,
+					    Eigen::Ref<vector_t> distances);
+
+      /// \brief Compute the projections of many points on segment [a,b].
+      ///
+      /// \see capsule::projectionsOnSegment
+      static void projectionsOnSegment (const_points_ref points,
+					const point_t& a,
+					const point_t& b,
+					Eigen::Ref<points_t> projections);
+
+      /// \brief Compute the projection parameters of many points on
+      /// segment [a,b].
+      ///
+      /// \see capsule::projectionParametersOnSegment
+      static void projectionParametersOnSegment (const_points_ref points,
+						 const point_t& a,
+						 const point_t& b,
+						 Eigen::Ref<vector_t> lambdas);
+
+      /// \brief Compute the distances from a point to many segments.
+      ///
+      /// \see capsule::distancesPointToSegments
+      static void distancesPointToSegments (const point_t& p,
+					    const_points_ref starts,
+					    const_points_ref ends,
+					    Eigen::Ref<vector_t> distances);
+
+      /// \brief Find the extreme points along a direction.
+      ///
+      /// \see capsule::extremePointsAlongDirection
+      static void extremePointsAlongDirection (const vector3_t& dir,
+					       const_points_ref points,
+					       int& imin, int& imax);
+
+      /// \brief Compute the mean, covariance and bounding box of points.
+      ///
+      /// Each block of points is centered on the first point and summed
+      /// with scalar type T; the sums of the blocks are accumulated in
+      /// double precision, so that the rounding errors do not grow with
+      /// the number of points.
+      ///
+      /// \param points points, as the columns of a non-empty matrix.
+      /// \return mean mean of the points.
+      /// \return covariance covariance of the points.
+      /// \return lower componentwise minimum of the points.
+      /// \return upper componentwise maximum of the points.
+      static void statistics (const_points_ref points,
+			      point_t& mean,
+			      matrix3_t& covariance,
+			      point_t& lower,
+			      point_t& upper);
+
+      /// \brief Compute a bounding capsule of points.
+      ///
+      /// The axis of the capsule is the largest spread direction of the
+      /// points, through their mean. The radius is the largest distance
+      /// to the axis, and the end points are placed as far inwards as
+      /// the spherical ends still contain the points. All the points are
+      /// inside the capsule up to the rounding errors of scalar type T.
+      ///
+      /// \param points points, as the columns of a non-empty matrix.
+      /// \return bounding capsule.
+      static capsule_t boundingCapsule (const_points_ref points);
+
+      /// \brief Radius inflation making a capsule computed with scalar
+      /// type T conservative.
+      ///
+      /// \param scale largest norm of the points and of the capsule end
+      /// points.
+      /// \return inflation of the radius.
+      static value_type radiusInflation (value_type scale);
+    };
+
+    /// \brief Compute a conservative bounding capsule of single
+    /// precision points.
+    ///
+    /// The capsule is computed by FloatGeometry::boundingCapsule, then
+    /// its radius is checked against the distances of the points to
+    /// its segment, computed by FloatGeometry::distancesPointsToSegment.
+    /// The capsule is finally converted to double precision: float
+    /// values are exact in double precision, so the conversion of the
+    /// end points is exact.
+    ///
+    /// Let \f$u = 2^{-24}\f$ be the unit roundoff of float, and
+    /// \f$M\f$ the largest norm of the points and of the end points,
+    /// bounded by \f$\max(|P_0|, |P_1|) + r\f$. The projection
+    /// parameter computed in float is clamped to [0,1], so the
+    /// computed projection is a point of the segment up to a few
+    /// roundings of coordinates bounded by \f$2M\f$; the difference,
+    /// the squared norm and the square root (including the approximate
+    /// SIMD square root of Eigen) add a few more relative errors. Each
+    /// distance computed in float thus exceeds the exact distance by
+    /// less than \f$16 u M\f$. The radius is inflated by twice this
+    /// bound, \f$32 u M \approx 1.9 \times 10^{-6} M\f$
+    /// (FloatGeometry::radiusInflation), so that every point is inside
+    /// the returned capsule in exact arithmetic.
+    ///
+    /// The inflation is relative to the distance of the points to the
+    /// origin: clouds far from the origin should be centered before
+    /// they are converted to float.
+    ///
+    /// \param points points, as the columns of a non-empty matrix.
+    /// \return conservative bounding capsule.
+    Capsule boundingCapsule (FloatGeometry::const_points_ref points);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_GEOMETRY_HH
@@ -0,0 +1,99 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \brief Declaration of the mesh and point cloud readers.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MESH_READER_HH
+# define ROBOPTIM_CAPSULE_MESH_READER_HH
+
+# include <iosfwd>
+# include <string>
+
+# include <boost/function.hpp>
+
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Input mesh formats.
+    enum MeshFormat
+      {
+	/// \brief Detected from the file extension, or from the content
+	/// for PLY and STL files.
+	MESH_FORMAT_AUTO,
+	/// \brief ASCII or binary (little/big endian) PLY vertices.
+	MESH_FORMAT_PLY,
+	/// \brief ASCII or binary STL triangle vertices.
+	MESH_FORMAT_STL,
+	/// \brief Wavefront OBJ vertices ("v" lines).
+	MESH_FORMAT_OBJ,
+	/// \brief Raw little-endian float64 x y z triplets. This format
+	/// is never detected, and must be given explicitly.
+	MESH_FORMAT_XYZ
+      };
+
+    /// \brief Callback receiving the points read, by chunks.
+    typedef boost::function<void (const polyhedron_t&)> pointSink_t;
+
+    /// \brief Get a mesh format from its name.
+    ///
+    /// \param name one of "auto", "ply", "stl", "obj" or "xyz".
+    /// \throw std::runtime_error if the name is unknown.
+    MeshFormat meshFormatFromString (const std::string& name);
+
+    /// \brief Get a mesh format from a file extension.
+    ///
+    /// Only the "ply", "stl" and "obj" extensions are recognized, in
+    /// any case.
+    ///
+    /// \return MESH_FORMAT_AUTO if the extension is not recognized.
+    MeshFormat meshFormatFromPath (const std::string& path);
+
+    /// \brief Read the points of a mesh from a stream.
+    ///
+    /// The stream is parsed incrementally: only the current chunk of
+    /// points is kept in memory, and it is passed to the sink whenever
+    /// it is full. Mesh faces are ignored, and the vertices of STL
+    /// triangles are passed as many times as they appear.
+    ///
+    /// \param input input stream, opened in binary mode.
+    /// \param format mesh format.
+    /// \param sink callback receiving the points.
+    /// \param chunkSize maximum number of points passed to the sink at
+    /// once.
+    /// \return number of points read.
+    /// \throw std::runtime_error if the input is malformed.
+    size_t readMesh (std::istream& input, MeshFormat format,
+		     const pointSink_t& sink, size_t chunkSize = 1 << 16);
+
+    /// \brief Read the points of a mesh file.
+    ///
+    /// Files are memory-mapped, and "-" reads the standard input.
+    ///
+    /// \see readMesh
+    size_t readMeshFile (const std::string& path, MeshFormat format,
+			 const pointSink_t& sink, size_t chunkSize = 1 << 16);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MESH_READER_HH
@@ -0,0 +1,179 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \brief Declaration of MultiFitter class that covers a polyhedron
+ * with several capsules.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MULTI_FITTER_HH
+# define ROBOPTIM_CAPSULE_MULTI_FITTER_HH
+
+# include <string>
+# include <vector>
+
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Multi-capsule fitter class.
+    ///
+    /// A single capsule wastes a lot of volume over elongated, bent or
+    /// branching shapes. This class splits the points of a polyhedron
+    /// into clusters and fits one capsule per cluster, so that the
+    /// capsules together contain all the points.
+    ///
+    /// Starting from a single cluster, the cluster with the largest
+    /// capsule is split in two halves along its largest spread
+    /// direction (a recursive PCA split). The split is then
+    /// refined by assigning each point to the capsule it is deepest
+    /// in (a k-means on the capsule axes) and fitting again, as long
+    /// as the total volume decreases. The capsules of the clusters are
+    /// fitted in parallel by a BatchFitter (see BatchFitter for the
+    /// choice of the linear solver).
+    ///
+    /// The number of capsules is either fixed (nbCapsules), or chosen
+    /// automatically: clusters are split until the total volume is
+    /// below volumeRatio times the volume of a single capsule, until
+    /// maxCapsules is reached, or until a split does not decrease the
+    /// total volume.
+    class MultiFitter
+    {
+    public:
+      /// \brief Constructor.
+      ///
+      /// \param polyhedron points covered by the capsules.
+      /// \param solver nonlinear solver used by each fit.
+      explicit MultiFitter (const polyhedron_t& polyhedron,
+			    std::string solver = "ipopt");
+
+      ~MultiFitter ();
+
+      /// \brief Get polyhedron attribute.
+      const polyhedron_t& polyhedron () const;
+
+      /// \brief Set polyhedron attribute.
+      void polyhedron (const polyhedron_t& polyhedron);
+
+      /// \brief Number of capsules, or 0 to choose it automatically.
+      ///
+      /// Default: 0.
+      size_t& nbCapsules ();
+      size_t nbCapsules () const;
+
+      /// \brief Largest number of capsules when it is chosen
+      /// automatically.
+      ///
+      /// Default: 8.
+      size_t& maxCapsules ();
+      size_t maxCapsules () const;
+
+      /// \brief Target ratio of the total volume of the capsules to
+      /// the volume of a single capsule, when the number of capsules
+      /// is chosen automatically.
+      ///
+      /// Default: 0.5.
+      value_type& volumeRatio ();
+      value_type volumeRatio () const;
+
+      /// \brief Largest number of refinements after each split.
+      ///
+      /// Default: 5.
+      size_t& nbRefinements ();
+      size_t nbRefinements () const;
+
+      /// \brief Number of threads fitting the clusters, or 0 for the
+      /// number of hardware threads.
+      ///
+      /// Default: 0.
+      size_t& nbThreads ();
+      size_t nbThreads () const;
+
+      /// \brief Get the options of each fit.
+      ///
+      /// \see BatchFitter::options
+      FitterOptions& options ();
+      const FitterOptions& options () const;
+
+      /// \brief Compute the capsules covering the polyhedron.
+      void computeBestFitCapsules ();
+
+      /// \brief Get the solution parameters, one vector per capsule
+      /// (see convertCapsuleToSolverParam).
+      const std::vector<argument_t>& solutionParams () const;
+
+      /// \brief Get the solution capsules.
+      std::vector<Capsule> capsules () const;
+
+      /// \brief Get the total volume of the solution capsules.
+      value_type solutionVolume () const;
+
+      /// \brief Get the volume of the single capsule fitted first.
+      value_type singleVolume () const;
+
+      /// \brief Get the capsule of each point of the polyhedron.
+      ///
+      /// Each point is contained in its capsule.
+      const std::vector<size_t>& labels () const;
+
+    private:
+      /// \brief Polyhedron attribute.
+      polyhedron_t polyhedron_;
+
+      /// \brief Nonlinear solver.
+      std::string solver_;
+
+      /// \brief Fixed number of capsules, 0 if automatic.
+      size_t nbCapsules_;
+
+      /// \brief Largest automatic number of capsules.
+      size_t maxCapsules_;
+
+      /// \brief Target volume ratio.
+      value_type volumeRatio_;
+
+      /// \brief Largest number of refinements after a split.
+      size_t nbRefinements_;
+
+      /// \brief Number of threads.
+      size_t nbThreads_;
+
+      /// \brief Options of each fit.
+      FitterOptions options_;
+
+      /// \brief Solution parameters attribute.
+      std::vector<argument_t> solutionParams_;
+
+      /// \brief Solution volume attribute.
+      value_type solutionVolume_;
+
+      /// \brief Single capsule volume attribute.
+      value_type singleVolume_;
+
+      /// \brief Capsule of each point.
+      std::vector<size_t> labels_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MULTI_FITTER_HH
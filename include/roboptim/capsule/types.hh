@@ -39,14 +39,31 @@ namespace roboptim
     typedef roboptim::Function::vector_t          vector_t;
     typedef roboptim::Function::matrix_t          matrix_t;
 
-    /// \brief Import solver type.
+    /// \brief Import solver types.
     typedef roboptim::Solver<roboptim::EigenMatrixDense> solver_t;
+    typedef roboptim::Solver<roboptim::EigenMatrixSparse> sparseSolver_t;
 
     /// \brief Define geometry types.
     typedef Eigen::Matrix<value_type,3,1>         point_t;
     typedef Eigen::Matrix<value_type,3,1>         vector3_t;
+    typedef Eigen::Matrix<value_type,6,1>         vector6_t;
+    typedef Eigen::Matrix<value_type,6,6>         matrix6_t;
+
+    /// \brief Capsule parameters (see convertCapsuleToSolverParam)
+    /// and their second derivatives, with fixed sizes so that they
+    /// live on the stack.
+    typedef Eigen::Matrix<value_type,7,1>         vector7_t;
+    typedef Eigen::Matrix<value_type,7,7>         matrix7_t;
     typedef std::vector<point_t>                  polyhedron_t;
     typedef std::vector<polyhedron_t>             polyhedrons_t;
+    typedef Eigen::Matrix<value_type,3,Eigen::Dynamic> points_t;
+
+    /// \brief Read-only view over contiguous points.
+    ///
+    /// Points are stored as the columns of a 3xN matrix. The view
+    /// binds without copy to a points_t, to a block of it, or to an
+    /// Eigen::Map over a caller buffer (see pointsMap).
+    typedef Eigen::Ref<const points_t>            const_points_ref;
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
@@ -27,16 +27,144 @@
 
 # include <roboptim/capsule/fwd.hh>
 # include <roboptim/capsule/types.hh>
-# include <roboptim/capsule/qhull.hh>
 
 namespace roboptim
 {
   namespace capsule
   {
 
-    /// Creates a convex hull from a set of points.
+    /// \brief Creates a convex hull from a set of points.
+    ///
+    /// The hull is computed with a built-in quickhull implementation
+    /// and only its vertices are returned. Degenerate inputs are
+    /// handled: coincident points yield a single point, collinear
+    /// points the two end points and coplanar points the vertices of
+    /// their planar hull.
+    ///
+    /// \param points input points.
+    /// \return vertices of the convex hull.
     polyhedron_t convexHullFromPoints (const std::vector<point_t>& points);
 
+    /// \brief Creates a convex hull from a set of points.
+    ///
+    /// \param points input points, as the columns of a matrix.
+    /// \return vertices of the convex hull.
+    polyhedron_t convexHullFromPoints (const_points_ref points);
+
+    /// \brief Convex hull of a stream of points.
+    ///
+    /// Points are added by chunks, and the buffered points are reduced
+    /// to their convex hull whenever the buffer is full, so that the
+    /// memory used only depends on the hull size and on the buffer
+    /// size, not on the number of points.
+    class ConvexHullAccumulator
+    {
+    public:
+      /// \brief Constructor.
+      ///
+      /// \param bufferSize number of points buffered before the hull
+      /// is updated.
+      explicit ConvexHullAccumulator (size_t bufferSize = 1 << 16);
+
+      /// \brief Add points.
+      void add (const std::vector<point_t>& points);
+
+      /// \brief Add a point.
+      void add (const point_t& point);
+
+      /// \brief Compute the vertices of the convex hull of all the
+      /// points added so far.
+      const polyhedron_t& hull ();
+
+      /// \brief Number of points added so far.
+      size_t nbPoints () const;
+
+    private:
+      /// \brief Reduce the buffered points to their convex hull.
+      void reduce ();
+
+      /// \brief Hull vertices followed by the buffered points.
+      polyhedron_t points_;
+
+      /// \brief Number of points buffered before the hull is updated.
+      size_t bufferSize_;
+
+      /// \brief Number of hull vertices at the beginning of points_.
+      size_t hullSize_;
+
+      /// \brief Number of points added so far.
+      size_t nbPoints_;
+    };
+
+    /// \brief Mergeable first and second order statistics of a set of
+    /// points.
+    ///
+    /// The mean and the scatter matrix are updated with the pairwise
+    /// formulas of Chan et al., which remain accurate for clouds far
+    /// from the origin, unlike the accumulation of raw moments. The
+    /// statistics of disjoint sets of points can be merged, so that
+    /// they are computed in one pass, by chunks or in parallel. The
+    /// axis-aligned bounds of the points are kept as well.
+    class PointStatistics
+    {
+    public:
+      /// \brief Statistics of an empty set of points.
+      PointStatistics ();
+
+      /// \brief Add a point.
+      void add (const point_t& point);
+
+      /// \brief Add points.
+      ///
+      /// \param points points, as the columns of a matrix.
+      void addPoints (const_points_ref points);
+
+      /// \brief Merge the statistics of another set of points.
+      void merge (const PointStatistics& other);
+
+      /// \brief Number of points.
+      size_type count () const;
+
+      /// \brief Average of the points.
+      const point_t& mean () const;
+
+      /// \brief Covariance matrix of the points, as computed by
+      /// covarianceMatrix.
+      Eigen::Matrix3d covariance () const;
+
+      /// \brief Smallest coordinates of the points.
+      const point_t& lower () const;
+
+      /// \brief Largest coordinates of the points.
+      const point_t& upper () const;
+
+    private:
+      /// \brief Number of points.
+      size_type count_;
+
+      /// \brief Average of the points.
+      point_t mean_;
+
+      /// \brief Sum of the outer products of the centered points.
+      Eigen::Matrix3d scatter_;
+
+      /// \brief Axis-aligned bounds of the points.
+      point_t lower_, upper_;
+    };
+
+    /// \brief Compute the statistics of a set of points.
+    ///
+    /// Points are read once. Large sets are split in chunks reduced by
+    /// several threads, whose statistics are merged in order, so that
+    /// the result does not depend on the scheduling.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \param nbThreads maximum number of threads. If 0, the number of
+    /// hardware threads is used. Sets of less than 65536 points per
+    /// thread are reduced with fewer threads.
+    PointStatistics pointStatistics (const_points_ref points,
+				     size_t nbThreads = 0);
+
     /// \brief Structure containing Capsule data (start point, end point and
     // radius).
     struct Capsule
@@ -51,6 +179,24 @@ namespace roboptim
       {}
     };
 
+    /// \brief Zero-copy view over the points of a polyhedron.
+    ///
+    /// Eigen 3D vectors are stored without padding, so the points of a
+    /// polyhedron are already contiguous. The view is only valid as
+    /// long as the polyhedron is not modified.
+    ///
+    /// \param polyhedron polyhedron.
+    /// \return view over the points, as the columns of a 3xN matrix.
+    Eigen::Map<const points_t> pointsMap (const polyhedron_t& polyhedron);
+
+    /// \brief Zero-copy view over a caller buffer of points.
+    ///
+    /// \param data coordinates x0 y0 z0 x1 y1 z1 etc.
+    /// \param nbPoints number of points.
+    /// \return view over the points, as the columns of a 3xN matrix.
+    Eigen::Map<const points_t> pointsMap (const value_type* data,
+					  size_type nbPoints);
+
     /// \brief Compute the distance from point p to segment [a,b].
     ///
     /// \param p point.
@@ -73,6 +219,106 @@ namespace roboptim
                                  const point_t& a,
                                  const point_t& b);
 
+    /// \brief Compute the parameter of the projection of point p on
+    /// segment [a,b].
+    ///
+    /// The projection of p is \f$a + \lambda (b - a)\f$ with
+    /// \f$\lambda \in [0,1]\f$. If the segment is degenerate,
+    /// i.e. a = b, both end points are weighted evenly and 0.5 is
+    /// returned.
+    ///
+    /// \param p point.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    ///
+    /// \return projection parameter \f$\lambda\f$.
+    value_type projectionParameterOnSegment (const point_t& p,
+                                             const point_t& a,
+                                             const point_t& b);
+
+    /// \brief Compute the distances from many points to segment [a,b].
+    ///
+    /// Batched version of distancePointToSegment. Points are processed
+    /// by blocks whose coordinates are transposed into x, y and z
+    /// lanes, so that Eigen vectorizes the computation with the SIMD
+    /// instruction set enabled at compile time (SSE, AVX, AVX-512 or
+    /// NEON), or falls back to scalar code.
+    ///
+    /// This is Geometry::distancesPointsToSegment; FloatGeometry
+    /// provides the same kernels on single precision points.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    /// \return distances distance from each point to the segment.
+    void distancesPointsToSegment (const_points_ref points,
+                                   const point_t& a,
+                                   const point_t& b,
+                                   Eigen::Ref<vector_t> distances);
+
+    /// \brief Compute the projections of many points on segment [a,b].
+    ///
+    /// Batched version of projectionOnSegment.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    /// \return projections projection of each point on the segment.
+    void projectionsOnSegment (const_points_ref points,
+                               const point_t& a,
+                               const point_t& b,
+                               Eigen::Ref<points_t> projections);
+
+    /// \brief Compute the projection parameters of many points on
+    /// segment [a,b].
+    ///
+    /// Batched version of projectionParameterOnSegment.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    /// \return lambdas projection parameter of each point.
+    void projectionParametersOnSegment (const_points_ref points,
+                                        const point_t& a,
+                                        const point_t& b,
+                                        Eigen::Ref<vector_t> lambdas);
+
+    /// \brief Compute the distances from a point to many segments.
+    ///
+    /// The i-th segment goes from the i-th column of starts to the i-th
+    /// column of ends. Segments are vectorized as in
+    /// distancesPointsToSegment.
+    ///
+    /// \param p point.
+    /// \param starts start points of the segments.
+    /// \param ends end points of the segments.
+    /// \return distances distance from p to each segment.
+    void distancesPointToSegments (const point_t& p,
+                                   const_points_ref starts,
+                                   const_points_ref ends,
+                                   Eigen::Ref<vector_t> distances);
+
+    /// \brief Compute the gradient and the hessian of the distance
+    /// from point p to segment [a,b] with respect to the segment end
+    /// points.
+    ///
+    /// Derivatives are taken with respect to the vector
+    /// \f$(a, b) \in \mathbb{R}^6\f$. As for the gradient of
+    /// DistanceCapsulePoint, a degenerate segment (a = b) is handled by
+    /// weighting both end points evenly. If p lies on the segment, the
+    /// distance is not differentiable and zero derivatives are returned.
+    ///
+    /// \param p point.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    /// \return gradient gradient of the distance.
+    /// \return hessian hessian of the distance.
+    void distancePointToSegmentDerivatives (const point_t& p,
+                                            const point_t& a,
+                                            const point_t& b,
+                                            vector6_t& gradient,
+                                            matrix6_t& hessian);
+
     /// \brief Distance from a point to a line described as a point and a
     // direction.
     value_type distancePointToLine (const point_t& point,
@@ -82,12 +328,59 @@ namespace roboptim
     /// \brief Compute the covariance matrix of a set of points.
     Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points);
 
+    /// \brief Compute the covariance matrix of a set of points.
+    ///
+    /// The points are read once, in parallel for large sets (see
+    /// pointStatistics).
+    ///
+    /// \param points points, as the columns of a matrix.
+    Eigen::Matrix3d covarianceMatrix (const_points_ref points);
+
     // Returns indices imin and imax into pt[] array of the least and
     // most, respectively, distant points along the direction dir
     void extremePointsAlongDirection (vector3_t dir,
                                       const std::vector<point_t>& points,
                                       int& imin, int& imax);
 
+    /// \brief Find the least and most distant points along a direction.
+    ///
+    /// \param dir direction.
+    /// \param points points, as the columns of a matrix.
+    /// \return imin index of the least distant point.
+    /// \return imax index of the most distant point.
+    void extremePointsAlongDirection (const vector3_t& dir,
+                                      const_points_ref points,
+                                      int& imin, int& imax);
+
+    /// \brief Compute the direction of largest spread of a set of
+    /// points, i.e. the principal axis of their covariance matrix.
+    vector3_t largestSpreadDirection (const std::vector<point_t>& points);
+
+    /// \brief Compute the direction of largest spread of a set of
+    /// points.
+    ///
+    /// \param points points, as the columns of a matrix.
+    vector3_t largestSpreadDirection (const_points_ref points);
+
+    /// \brief Select the points seeding an active-set capsule fitting.
+    ///
+    /// The selected points are the extreme points along the largest
+    /// spread direction, the point furthest from the corresponding
+    /// axis, and the extreme points along two directions orthogonal to
+    /// that axis.
+    ///
+    /// \param points input points.
+    /// \return indices sorted indices of the selected points.
+    void activeSetSeed (const std::vector<point_t>& points,
+			std::vector<size_t>& indices);
+
+    /// \brief Select the points seeding an active-set capsule fitting.
+    ///
+    /// \param points input points, as the columns of a matrix.
+    /// \return indices sorted indices of the selected points.
+    void activeSetSeed (const_points_ref points,
+			std::vector<size_t>& indices);
+
     /// Computes a capsule from a set of points.
     /// The algorithm currently used relies on the search of the largest spread
     /// direction (PCA).
@@ -96,6 +389,15 @@ namespace roboptim
     /// could be shortened to have a better fit.
     Capsule capsuleFromPoints (const std::vector<point_t>& points);
 
+    /// \brief Computes a capsule from a set of points.
+    ///
+    /// The points are read three times, in parallel for large sets:
+    /// once for their statistics, once for their extremes along the
+    /// axis and their distance to it, and once to fit the end caps.
+    ///
+    /// \param points points, as the columns of a matrix.
+    Capsule capsuleFromPoints (const_points_ref points);
+
     /// \brief Convert Capsule parameters to RobOptim solver
     /// parameters vector.
     ///
@@ -136,6 +438,25 @@ namespace roboptim
     convertPolyhedronVectorToPolyhedron (polyhedron_t& polyhedron,
 					 const polyhedrons_t& polyhedrons);
 
+    /// \brief Convert a polyhedron vector to a matrix of points.
+    ///
+    /// \param polyhedrons polyhedron vector containing all
+    /// polyhedrons.
+    ///
+    /// \return points points of all polyhedrons, as the columns of a
+    /// matrix.
+    void
+    convertPolyhedronVectorToPoints (points_t& points,
+				     const polyhedrons_t& polyhedrons);
+
+    /// \brief Convert a matrix of points to a polyhedron.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \return polyhedron polyhedron containing the points.
+    void
+    convertPointsToPolyhedron (polyhedron_t& polyhedron,
+			       const_points_ref points);
+
     /// \brief Compute bounding capsule of a vector of polyhedrons.
     ///
     /// Compute axis of capsule segment using least-squares fit. Radius
@@ -153,6 +474,18 @@ namespace roboptim
 				      point_t& endPoint2,
 				      value_type& radius);
 
+    /// \brief Compute bounding capsule of a set of points.
+    ///
+    /// \param points points, as the columns of a matrix.
+    /// \return endPoint1 bounding capsule segment first end point
+    /// \return endPoint2 bounding capsule segment second end point
+    /// \return radius bounding capsule radius
+    void
+    computeBoundingCapsulePolyhedron (const_points_ref points,
+				      point_t& endPoint1,
+				      point_t& endPoint2,
+				      value_type& radius);
+
     /// \brief Compute the convex polyhedron over a vector of
     /// polyhedrons.
     ///
@@ -24,7 +24,7 @@
 #ifndef ROBOPTIM_CAPSULE_VOLUME_HH
 # define ROBOPTIM_CAPSULE_VOLUME_HH
 
-# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/twice-differentiable-function.hh>
 
 # include "roboptim/capsule/types.hh"
 
@@ -36,14 +36,20 @@ namespace roboptim
     ///
     /// This class computes the volume of a capsule defined by a
     /// segment and a radius.
-    class Volume
-      : public roboptim::DifferentiableFunction
+    ///
+    /// \tparam T matrix type (dense or sparse).
+    template <typename T>
+    class GenericVolume
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
     {
     public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (roboptim::GenericTwiceDifferentiableFunction<T>);
+
       /// \brief Constructor.
-      Volume (std::string name = "capsule volume");
+      GenericVolume (std::string name = "capsule volume");
 
-      ~Volume ();
+      ~GenericVolume ();
 
     protected:
       /// \brief Compute the volume of the capsule.
@@ -62,8 +68,21 @@ namespace roboptim
       impl_gradient (gradient_ref gradient,
 		     const_argument_ref argument,
 		     size_type functionId = 0) const;
+
+      /// \brief Compute hessian of the capsule volume with respect
+      /// to the argument vector.
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
     };
 
+    /// \brief Capsule volume function with dense matrices.
+    typedef GenericVolume<roboptim::EigenMatrixDense> Volume;
+
+    /// \brief Capsule volume function with sparse matrices.
+    typedef GenericVolume<roboptim::EigenMatrixSparse> SparseVolume;
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
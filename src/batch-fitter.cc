@@ -0,0 +1,288 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/batch-fitter.cc
+ *
+ * \brief Implementation of BatchFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_BATCH_FITTER_CC_
+# define ROBOPTIM_CAPSULE_BATCH_FITTER_CC_
+
+# include <algorithm>
+# include <exception>
+# include <sstream>
+
+# include <boost/bind.hpp>
+# include <boost/thread/locks.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
+
+# include <roboptim/capsule/batch-fitter.hh>
+
+# include "wall-time.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Work shared by the worker threads.
+      ///
+      /// Problems are either given (problems) or loaded on demand
+      /// (loader).
+      struct BatchWork
+      {
+	size_t nbProblems;
+	const std::vector<polyhedrons_t>* problems;
+	BatchFitter::problemLoader_t loader;
+	BatchFitter::results_t* results;
+	std::string solver;
+	boost::optional<std::string> solverLogDir;
+	FitterOptions options;
+	boost::shared_ptr<FitCache> cache;
+
+	/// \brief Index of the next problem to solve.
+	size_t next;
+	boost::mutex mutex;
+      };
+
+      /// \brief Fit a single problem.
+      void fitOne (const polyhedrons_t& polyhedrons,
+		   const std::string& solver,
+		   const FitterOptions& options,
+		   const boost::shared_ptr<FitCache>& cache,
+		   BatchFitter::result_t& result)
+      {
+	if (polyhedrons.empty ())
+	  {
+	    result.status = GenericSolver::SOLVER_ERROR;
+	    result.errorMessage = "Empty polyhedron vector.";
+	    result.stats.status = result.status;
+	    return;
+	  }
+
+	try
+	  {
+	    Fitter fitter (polyhedrons, solver);
+	    fitter.options () = options;
+	    fitter.cache () = cache;
+	    fitter.computeBestFitCapsule ();
+
+	    result.initParam = fitter.initParam ();
+	    result.solutionParam = fitter.solutionParam ();
+	    result.initVolume = fitter.initVolume ();
+	    result.solutionVolume = fitter.solutionVolume ();
+	    result.status = fitter.status ();
+	    result.errorMessage = fitter.errorMessage ();
+	    result.stats = fitter.stats ();
+	  }
+	catch (std::exception& e)
+	  {
+	    result.status = GenericSolver::SOLVER_ERROR;
+	    result.errorMessage = e.what ();
+	    result.stats.status = result.status;
+	  }
+      }
+
+      /// \brief Worker loop: fit problems until none is left.
+      void worker (BatchWork& work)
+      {
+	while (true)
+	  {
+	    size_t i;
+	    {
+	      boost::lock_guard<boost::mutex> lock (work.mutex);
+	      if (work.next >= work.nbProblems)
+		return;
+	      i = work.next++;
+	    }
+
+	    // Each fit gets its own log file.
+	    FitterOptions options = work.options;
+	    options.solverLogFile.reset ();
+	    if (work.solverLogDir)
+	      {
+		std::stringstream ss;
+		ss << *work.solverLogDir << "/fit-" << i << "-ipopt.log";
+		options.solverLogFile = ss.str ();
+	      }
+
+	    // Each worker only writes to its own result.
+	    BatchFitter::result_t& result = (*work.results)[i];
+	    if (work.problems)
+	      {
+		fitOne ((*work.problems)[i], work.solver, options, work.cache,
+			result);
+		continue;
+	      }
+
+	    polyhedrons_t polyhedrons;
+	    double start = detail::wallTime ();
+	    try
+	      {
+		polyhedrons = work.loader (i);
+	      }
+	    catch (std::exception& e)
+	      {
+		result.status = GenericSolver::SOLVER_ERROR;
+		result.errorMessage = e.what ();
+		result.stats.status = result.status;
+		result.loadTime = detail::wallTime () - start;
+		continue;
+	      }
+	    result.loadTime = detail::wallTime () - start;
+
+	    fitOne (polyhedrons, work.solver, options, work.cache, result);
+	  }
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    BatchFitter::
+    BatchFitter (std::string solver, size_t nbThreads)
+      : solver_ (solver),
+	nbThreads_ (nbThreads),
+	options_ (FitterOptions::quiet ())
+    {
+    }
+
+    BatchFitter::
+    ~BatchFitter ()
+    {
+    }
+
+    size_t BatchFitter::
+    nbThreads () const
+    {
+      if (nbThreads_ > 0)
+	return nbThreads_;
+
+      // hardware_concurrency may return 0 if the information is not
+      // available.
+      return std::max<size_t> (1, boost::thread::hardware_concurrency ());
+    }
+
+    void BatchFitter::
+    nbThreads (size_t n)
+    {
+      nbThreads_ = n;
+    }
+
+    boost::optional<std::string>& BatchFitter::
+    solverLogDirectory ()
+    {
+      return solverLogDir_;
+    }
+
+    const boost::optional<std::string>& BatchFitter::
+    solverLogDirectory () const
+    {
+      return solverLogDir_;
+    }
+
+    FitterOptions& BatchFitter::
+    options ()
+    {
+      return options_;
+    }
+
+    const FitterOptions& BatchFitter::
+    options () const
+    {
+      return options_;
+    }
+
+    boost::shared_ptr<FitCache>& BatchFitter::
+    cache ()
+    {
+      return cache_;
+    }
+
+    const boost::shared_ptr<FitCache>& BatchFitter::
+    cache () const
+    {
+      return cache_;
+    }
+
+    bool& BatchFitter::
+    useSparseMatrices ()
+    {
+      return options_.useSparseMatrices;
+    }
+
+    bool BatchFitter::
+    useSparseMatrices () const
+    {
+      return options_.useSparseMatrices;
+    }
+
+    BatchFitter::results_t BatchFitter::
+    fit (const std::vector<polyhedrons_t>& problems) const
+    {
+      return run (problems.size (), &problems, problemLoader_t ());
+    }
+
+    BatchFitter::results_t BatchFitter::
+    fit (size_t nbProblems, const problemLoader_t& loader) const
+    {
+      return run (nbProblems, 0, loader);
+    }
+
+    BatchFitter::results_t BatchFitter::
+    run (size_t nbProblems, const std::vector<polyhedrons_t>* problems,
+	 const problemLoader_t& loader) const
+    {
+      results_t results (nbProblems);
+
+      BatchWork work;
+      work.nbProblems = nbProblems;
+      work.problems = problems;
+      work.loader = loader;
+      work.results = &results;
+      work.solver = solver_;
+      work.solverLogDir = solverLogDir_;
+      work.options = options_;
+      work.cache = cache_;
+      work.next = 0;
+
+      size_t nbWorkers = std::min (nbThreads (), nbProblems);
+
+      // Run the fits in the calling thread if there is nothing to
+      // parallelize.
+      if (nbWorkers <= 1)
+	{
+	  worker (work);
+	  return results;
+	}
+
+      boost::thread_group workers;
+      for (size_t i = 0; i < nbWorkers; ++i)
+	workers.create_thread (boost::bind (&worker, boost::ref (work)));
+      workers.join_all ();
+
+      return results;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_BATCH_FITTER_CC_
@@ -0,0 +1,229 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/batch-report.cc
+ *
+ * \brief Implementation of the structured reports of batch fits.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_BATCH_REPORT_CC_
+# define ROBOPTIM_CAPSULE_BATCH_REPORT_CC_
+
+# include <cmath>
+# include <cstdio>
+# include <limits>
+# include <ostream>
+# include <sstream>
+# include <stdexcept>
+
+# include <roboptim/capsule/batch-report.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Names of the capsule parameters, in order.
+      const char* const parameterNames[] =
+	{"ax", "ay", "az", "bx", "by", "bz", "radius"};
+
+      /// \brief Format a number so that it is read back exactly.
+      ///
+      /// Non-finite numbers are written as JSON null, or left empty in
+      /// CSV.
+      std::string number (double value, ReportFormat format)
+      {
+	if (!(std::fabs (value) <= std::numeric_limits<double>::max ()))
+	  return format == REPORT_FORMAT_JSON ? "null" : "";
+
+	std::ostringstream ss;
+	ss.precision (17);
+	ss << value;
+	return ss.str ();
+      }
+
+      std::string jsonString (const std::string& s)
+      {
+	std::string escaped = "\"";
+	for (size_t i = 0; i < s.size (); ++i)
+	  {
+	    unsigned char c = static_cast<unsigned char> (s[i]);
+	    switch (c)
+	      {
+	      case '"': escaped += "\\\""; break;
+	      case '\\': escaped += "\\\\"; break;
+	      case '\n': escaped += "\\n"; break;
+	      case '\r': escaped += "\\r"; break;
+	      case '\t': escaped += "\\t"; break;
+	      default:
+		if (c < 0x20)
+		  {
+		    char buffer[8];
+		    std::sprintf (buffer, "\\u%04x", c);
+		    escaped += buffer;
+		  }
+		else
+		  escaped += s[i];
+	      }
+	  }
+	return escaped + "\"";
+      }
+
+      /// \brief Quote a CSV field if needed (RFC 4180).
+      std::string csvString (const std::string& s)
+      {
+	if (s.find_first_of (",\"\r\n") == std::string::npos)
+	  return s;
+
+	std::string quoted = "\"";
+	for (size_t i = 0; i < s.size (); ++i)
+	  {
+	    if (s[i] == '"')
+	      quoted += '"';
+	    quoted += s[i];
+	  }
+	return quoted + "\"";
+      }
+
+      void writeJsonParameters (std::ostream& os, const argument_t& param)
+      {
+	os << "[";
+	for (argument_t::Index i = 0; i < param.size (); ++i)
+	  os << (i > 0 ? ", " : "") << number (param[i], REPORT_FORMAT_JSON);
+	os << "]";
+      }
+
+      void writeJson (std::ostream& os,
+		      const std::vector<std::string>& names,
+		      const BatchFitter::results_t& results)
+      {
+	os << "[";
+	for (size_t i = 0; i < results.size (); ++i)
+	  {
+	    const BatchFitter::result_t& result = results[i];
+	    const FitStats& stats = result.stats;
+
+	    os << (i > 0 ? ",\n " : "\n ") << "{"
+	       << "\"name\": " << jsonString (names[i])
+	       << ", \"status\": \"" << solverStatusName (result.status)
+	       << "\", \"error\": " << jsonString (result.errorMessage)
+	       << ", \"initParam\": ";
+	    writeJsonParameters (os, result.initParam);
+	    os << ", \"initVolume\": "
+	       << number (result.initVolume, REPORT_FORMAT_JSON)
+	       << ", \"solutionParam\": ";
+	    writeJsonParameters (os, result.solutionParam);
+	    os << ", \"solutionVolume\": "
+	       << number (result.solutionVolume, REPORT_FORMAT_JSON)
+	       << ", \"loadTime\": "
+	       << number (result.loadTime, REPORT_FORMAT_JSON)
+	       << ", \"hullTime\": "
+	       << number (stats.hullTime, REPORT_FORMAT_JSON)
+	       << ", \"initTime\": "
+	       << number (stats.initTime, REPORT_FORMAT_JSON)
+	       << ", \"solveTime\": "
+	       << number (stats.solveTime, REPORT_FORMAT_JSON)
+	       << ", \"iterations\": " << stats.iterations
+	       << ", \"constraintViolation\": "
+	       << number (stats.constraintViolation, REPORT_FORMAT_JSON)
+	       << ", \"cached\": " << (stats.cached ? "true" : "false")
+	       << "}";
+	  }
+	os << (results.empty () ? "]\n" : "\n]\n");
+      }
+
+      void writeCsv (std::ostream& os,
+		     const std::vector<std::string>& names,
+		     const BatchFitter::results_t& results)
+      {
+	os << "name,status,error";
+	for (int k = 0; k < 7; ++k)
+	  os << ",init_" << parameterNames[k];
+	os << ",init_volume";
+	for (int k = 0; k < 7; ++k)
+	  os << ",solution_" << parameterNames[k];
+	os << ",solution_volume,load_time,hull_time,init_time,solve_time"
+	   << ",iterations,constraint_violation,cached\n";
+
+	for (size_t i = 0; i < results.size (); ++i)
+	  {
+	    const BatchFitter::result_t& result = results[i];
+	    const FitStats& stats = result.stats;
+
+	    os << csvString (names[i])
+	       << "," << solverStatusName (result.status)
+	       << "," << csvString (result.errorMessage);
+	    for (argument_t::Index k = 0; k < 7; ++k)
+	      os << "," << number (result.initParam[k], REPORT_FORMAT_CSV);
+	    os << "," << number (result.initVolume, REPORT_FORMAT_CSV);
+	    for (argument_t::Index k = 0; k < 7; ++k)
+	      os << "," << number (result.solutionParam[k], REPORT_FORMAT_CSV);
+	    os << "," << number (result.solutionVolume, REPORT_FORMAT_CSV)
+	       << "," << number (result.loadTime, REPORT_FORMAT_CSV)
+	       << "," << number (stats.hullTime, REPORT_FORMAT_CSV)
+	       << "," << number (stats.initTime, REPORT_FORMAT_CSV)
+	       << "," << number (stats.solveTime, REPORT_FORMAT_CSV)
+	       << "," << stats.iterations
+	       << "," << number (stats.constraintViolation, REPORT_FORMAT_CSV)
+	       << "," << (stats.cached ? 1 : 0) << "\n";
+	  }
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    ReportFormat reportFormatFromString (const std::string& name)
+    {
+      if (name == "json") return REPORT_FORMAT_JSON;
+      if (name == "csv") return REPORT_FORMAT_CSV;
+      throw std::runtime_error ("unknown report format: " + name);
+    }
+
+    const char* solverStatusName (GenericSolver::solutions status)
+    {
+      switch (status)
+	{
+	case GenericSolver::SOLVER_NO_SOLUTION: return "no_solution";
+	case GenericSolver::SOLVER_VALUE: return "solution";
+	case GenericSolver::SOLVER_VALUE_WARNINGS:
+	  return "solution_with_warnings";
+	case GenericSolver::SOLVER_ERROR: return "error";
+	}
+      return "unknown";
+    }
+
+    void writeBatchReport (std::ostream& os,
+			   const std::vector<std::string>& names,
+			   const BatchFitter::results_t& results,
+			   ReportFormat format)
+    {
+      if (names.size () != results.size ())
+	throw std::runtime_error ("there should be one name per result");
+
+      if (format == REPORT_FORMAT_JSON)
+	writeJson (os, names, results);
+      else
+	writeCsv (os, names, results);
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_BATCH_REPORT_CC_
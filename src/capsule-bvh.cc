@@ -0,0 +1,693 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/capsule-bvh.cc
+ *
+ * \brief Implementation of the bounding volume hierarchy over capsules.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_CAPSULE_BVH_CC_
+# define ROBOPTIM_CAPSULE_CAPSULE_BVH_CC_
+
+# include <algorithm>
+# include <cassert>
+# include <cmath>
+# include <limits>
+
+# include <boost/bind.hpp>
+# include <boost/ref.hpp>
+# include <boost/thread.hpp>
+
+# include <roboptim/capsule/capsule-bvh.hh>
+# include <roboptim/capsule/capsule-distance.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef CapsuleBvh::Node Node;
+      typedef CapsuleBvh::nodes_t nodes_t;
+
+      /// \brief Subtrees with fewer capsules are built by a single
+      /// thread.
+      const size_t minCapsulesPerThread = 1 << 12;
+
+      /// \brief Size of the traversal stacks. Median splits keep the
+      /// depth of the tree logarithmic in the number of capsules.
+      const size_t stackSize = 64;
+
+      /// \brief Relative squared sine below which a ray is parallel to
+      /// a capsule axis.
+      const value_type parallelTolerance = 1e-12;
+
+      const value_type inf = std::numeric_limits<value_type>::infinity ();
+
+      /// \brief Compute the bounding box of a capsule.
+      void capsuleBounds (const Capsule& capsule,
+			  point_t& lower, point_t& upper)
+      {
+	lower = (capsule.P0.cwiseMin (capsule.P1).array ()
+		 - capsule.radius).matrix ();
+	upper = (capsule.P0.cwiseMax (capsule.P1).array ()
+		 + capsule.radius).matrix ();
+      }
+
+      /// \brief Grow a node box to contain another box.
+      void merge (Node& node, const point_t& lower, const point_t& upper)
+      {
+	node.lower = node.lower.cwiseMin (lower);
+	node.upper = node.upper.cwiseMax (upper);
+      }
+
+      /// \brief Squared distance from a point to a node box, 0 inside.
+      value_type boxDistance2 (const Node& node, const point_t& point)
+      {
+	return (node.lower - point).cwiseMax (point - node.upper)
+	  .cwiseMax (point_t::Zero ()).squaredNorm ();
+      }
+
+      /// \brief Lower bound of the signed distance from a point to the
+      /// capsules of a node.
+      ///
+      /// The capsules are inside the box, so they are at least as far
+      /// as the box from an outer point. Nothing is known for a point
+      /// inside the box.
+      value_type distanceBound (const Node& node, const point_t& point)
+      {
+	value_type d2 = boxDistance2 (node, point);
+	return d2 > 0. ? std::sqrt (d2) : -inf;
+      }
+
+      bool boxContains (const Node& node, const point_t& point)
+      {
+	return (point.array () >= node.lower.array ()).all ()
+	  && (point.array () <= node.upper.array ()).all ();
+      }
+
+      bool boxesOverlap (const Node& node,
+			 const point_t& lower, const point_t& upper)
+      {
+	return (node.lower.array () <= upper.array ()).all ()
+	  && (lower.array () <= node.upper.array ()).all ();
+      }
+
+      /// \brief Distance along a ray to a node box (slab test).
+      ///
+      /// \param inverse inverse of the ray direction, with infinite
+      /// components for axis-parallel rays.
+      /// \return entry distance along the ray to the box, 0 inside.
+      /// \return whether the box is hit before maxDistance.
+      bool rayBox (const point_t& origin, const vector3_t& inverse,
+		   const Node& node, value_type maxDistance,
+		   value_type& entry)
+      {
+	value_type tmin = 0.;
+	value_type tmax = maxDistance;
+	for (size_type k = 0; k < 3; ++k)
+	  {
+	    value_type t0 = (node.lower[k] - origin[k]) * inverse[k];
+	    value_type t1 = (node.upper[k] - origin[k]) * inverse[k];
+	    if (inverse[k] < 0.)
+	      std::swap (t0, t1);
+
+	    // An origin on a slab of an axis-parallel ray gives NaN,
+	    // which std::max and std::min ignore: the slab is kept.
+	    tmin = std::max (tmin, t0);
+	    tmax = std::min (tmax, t1);
+	    if (tmin > tmax)
+	      return false;
+	  }
+	entry = tmin;
+	return true;
+      }
+
+      /// \brief Distance along a ray to a sphere, if the origin is
+      /// outside and the sphere ahead.
+      bool raySphere (const vector3_t& offset, const vector3_t& direction,
+		      value_type radius2, value_type& distance)
+      {
+	value_type b = direction.dot (offset);
+	value_type h = b * b - offset.squaredNorm () + radius2;
+	if (h < 0.)
+	  return false;
+	distance = -b - std::sqrt (h);
+	return distance >= 0.;
+      }
+
+      /// \brief Top-down builder of the hierarchy.
+      class Builder
+      {
+      public:
+	Builder (const std::vector<Capsule>& capsules,
+		 std::vector<boost::uint32_t>& order,
+		 size_t parallelDepth)
+	  : order_ (order),
+	    lowers_ (capsules.size ()),
+	    uppers_ (capsules.size ()),
+	    centers_ (capsules.size ()),
+	    parallelDepth_ (parallelDepth)
+	{
+	  for (size_t i = 0; i < capsules.size (); ++i)
+	    {
+	      capsuleBounds (capsules[i], lowers_[i], uppers_[i]);
+	      centers_[i] = 0.5 * (lowers_[i] + uppers_[i]);
+	    }
+	}
+
+	/// \brief Build the subtree of capsules order[begin, end).
+	///
+	/// Child indices are relative to the start of nodes, so that
+	/// subtrees built by other threads can be appended.
+	void build (size_t begin, size_t end, size_t depth, nodes_t& nodes)
+	{
+	  const size_t p = nodes.size ();
+	  nodes.push_back (Node ());
+	  nodes[p].lower = lowers_[order_[begin]];
+	  nodes[p].upper = uppers_[order_[begin]];
+	  for (size_t i = begin + 1; i < end; ++i)
+	    merge (nodes[p], lowers_[order_[i]], uppers_[order_[i]]);
+
+	  if (end - begin <= static_cast<size_t> (CapsuleBvh::leafSize))
+	    {
+	      nodes[p].index = static_cast<boost::uint32_t> (begin);
+	      nodes[p].count = static_cast<boost::uint32_t> (end - begin);
+	      return;
+	    }
+	  nodes[p].count = 0;
+
+	  // Median split along the largest spread of the centers.
+	  point_t lower = centers_[order_[begin]];
+	  point_t upper = lower;
+	  for (size_t i = begin + 1; i < end; ++i)
+	    {
+	      lower = lower.cwiseMin (centers_[order_[i]]);
+	      upper = upper.cwiseMax (centers_[order_[i]]);
+	    }
+	  size_type axis;
+	  (upper - lower).maxCoeff (&axis);
+
+	  const size_t middle = begin + (end - begin) / 2;
+	  std::nth_element (order_.begin () + begin,
+			    order_.begin () + middle,
+			    order_.begin () + end,
+			    CenterLess (centers_, axis));
+
+	  if (depth < parallelDepth_
+	      && end - begin >= 2 * minCapsulesPerThread)
+	    {
+	      // Both halves touch disjoint ranges of order.
+	      nodes_t left;
+	      nodes_t right;
+	      boost::thread thread (boost::bind (&Builder::build, this,
+						 begin, middle, depth + 1,
+						 boost::ref (left)));
+	      build (middle, end, depth + 1, right);
+	      thread.join ();
+
+	      append (nodes, left);
+	      nodes[p].index = static_cast<boost::uint32_t> (nodes.size ());
+	      append (nodes, right);
+	    }
+	  else
+	    {
+	      build (begin, middle, depth + 1, nodes);
+	      nodes[p].index = static_cast<boost::uint32_t> (nodes.size ());
+	      build (middle, end, depth + 1, nodes);
+	    }
+	}
+
+      private:
+	struct CenterLess
+	{
+	  CenterLess (const std::vector<point_t>& centers, size_type axis)
+	    : centers_ (centers),
+	      axis_ (axis)
+	  {}
+
+	  bool operator() (boost::uint32_t i, boost::uint32_t j) const
+	  {
+	    return centers_[i][axis_] < centers_[j][axis_];
+	  }
+
+	  const std::vector<point_t>& centers_;
+	  size_type axis_;
+	};
+
+	/// \brief Append a subtree, shifting its child indices.
+	static void append (nodes_t& nodes, const nodes_t& subtree)
+	{
+	  const boost::uint32_t offset
+	    = static_cast<boost::uint32_t> (nodes.size ());
+	  nodes.reserve (nodes.size () + subtree.size ());
+	  for (size_t i = 0; i < subtree.size (); ++i)
+	    {
+	      nodes.push_back (subtree[i]);
+	      if (!nodes.back ().isLeaf ())
+		nodes.back ().index += offset;
+	    }
+	}
+
+	std::vector<boost::uint32_t>& order_;
+	std::vector<point_t> lowers_;
+	std::vector<point_t> uppers_;
+	std::vector<point_t> centers_;
+	size_t parallelDepth_;
+      };
+
+      /// \brief Capsules containing a point.
+      struct PointQuery
+      {
+	PointQuery (const std::vector<Capsule>& capsules,
+		    const point_t& point,
+		    std::vector<size_type>* indices)
+	  : capsules_ (capsules),
+	    point_ (point),
+	    indices_ (indices)
+	{}
+
+	bool box (const Node& node) const
+	{
+	  return boxContains (node, point_);
+	}
+
+	/// \brief Test a capsule, return true to stop the traversal.
+	bool capsule (size_type i) const
+	{
+	  const Capsule& c = capsules_[i];
+	  if (distancePointToSegment (point_, c.P0, c.P1) > c.radius)
+	    return false;
+	  if (!indices_)
+	    return true;
+	  indices_->push_back (i);
+	  return false;
+	}
+
+	const std::vector<Capsule>& capsules_;
+	const point_t& point_;
+	std::vector<size_type>* indices_;
+      };
+
+      /// \brief Capsules overlapping a capsule.
+      struct CapsuleQuery
+      {
+	CapsuleQuery (const std::vector<Capsule>& capsules,
+		      const Capsule& capsule,
+		      std::vector<size_type>* indices)
+	  : capsules_ (capsules),
+	    capsule_ (capsule),
+	    indices_ (indices)
+	{
+	  capsuleBounds (capsule, lower_, upper_);
+	}
+
+	bool box (const Node& node) const
+	{
+	  return boxesOverlap (node, lower_, upper_);
+	}
+
+	/// \brief Test a capsule, return true to stop the traversal.
+	bool capsule (size_type i) const
+	{
+	  if (!capsulesOverlap (capsule_, capsules_[i]))
+	    return false;
+	  if (!indices_)
+	    return true;
+	  indices_->push_back (i);
+	  return false;
+	}
+
+	const std::vector<Capsule>& capsules_;
+	const Capsule& capsule_;
+	point_t lower_;
+	point_t upper_;
+	std::vector<size_type>* indices_;
+      };
+
+      /// \brief Test the capsules of the leaves whose box passes the
+      /// query, until the query stops the traversal.
+      ///
+      /// \return whether the traversal was stopped.
+      template <typename Q>
+      bool traverse (const nodes_t& nodes,
+		     const std::vector<boost::uint32_t>& order,
+		     const Q& query)
+      {
+	if (nodes.empty ())
+	  return false;
+
+	boost::uint32_t stack[stackSize];
+	size_t top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	  {
+	    const boost::uint32_t i = stack[--top];
+	    const Node& node = nodes[i];
+	    if (!query.box (node))
+	      continue;
+
+	    if (node.isLeaf ())
+	      {
+		for (boost::uint32_t k = 0; k < node.count; ++k)
+		  if (query.capsule (order[node.index + k]))
+		    return true;
+		continue;
+	      }
+
+	    assert (top + 2 <= stackSize);
+	    stack[top++] = node.index;
+	    stack[top++] = i + 1;
+	  }
+	return false;
+      }
+    } // end of anonymous namespace.
+
+    CapsuleBvh::CapsuleBvh ()
+      : capsules_ (),
+	order_ (),
+	nodes_ ()
+    {
+    }
+
+    CapsuleBvh::CapsuleBvh (const std::vector<Capsule>& capsules,
+			    size_t nbThreads)
+      : capsules_ (),
+	order_ (),
+	nodes_ ()
+    {
+      build (capsules, nbThreads);
+    }
+
+    void CapsuleBvh::build (const std::vector<Capsule>& capsules,
+			    size_t nbThreads)
+    {
+      // Indices are stored on 32 bits to keep the nodes compact.
+      assert (capsules.size ()
+	      < std::numeric_limits<boost::uint32_t>::max ());
+
+      capsules_ = capsules;
+      order_.resize (capsules.size ());
+      for (size_t i = 0; i < order_.size (); ++i)
+	order_[i] = static_cast<boost::uint32_t> (i);
+      nodes_.clear ();
+      if (capsules.empty ())
+	return;
+
+      if (nbThreads == 0)
+	// hardware_concurrency may return 0 if the information is not
+	// available.
+	nbThreads = std::max<size_t>
+	  (1, boost::thread::hardware_concurrency ());
+
+      // Subtrees are split between two threads down to this depth.
+      size_t parallelDepth = 0;
+      while ((static_cast<size_t> (1) << parallelDepth) < nbThreads)
+	++parallelDepth;
+
+      // Leaves hold at least 2 capsules, so there are fewer nodes than
+      // capsules.
+      nodes_.reserve (capsules.size ());
+      Builder builder (capsules_, order_, parallelDepth);
+      builder.build (0, capsules.size (), 0, nodes_);
+    }
+
+    void CapsuleBvh::capsule (size_type i, const Capsule& capsule)
+    {
+      assert (i >= 0 && i < size ());
+      capsules_[static_cast<size_t> (i)] = capsule;
+    }
+
+    void CapsuleBvh::refit ()
+    {
+      point_t lower;
+      point_t upper;
+
+      // Children follow their parent, so a reverse sweep updates them
+      // first.
+      for (size_t i = nodes_.size (); i-- > 0;)
+	{
+	  Node& node = nodes_[i];
+	  if (node.isLeaf ())
+	    {
+	      capsuleBounds (capsules_[order_[node.index]],
+			     node.lower, node.upper);
+	      for (boost::uint32_t k = 1; k < node.count; ++k)
+		{
+		  capsuleBounds (capsules_[order_[node.index + k]],
+				 lower, upper);
+		  merge (node, lower, upper);
+		}
+	    }
+	  else
+	    {
+	      node.lower = nodes_[i + 1].lower;
+	      node.upper = nodes_[i + 1].upper;
+	      merge (node, nodes_[node.index].lower, nodes_[node.index].upper);
+	    }
+	}
+    }
+
+    void CapsuleBvh::refit (const std::vector<Capsule>& capsules)
+    {
+      assert (capsules.size () == capsules_.size ());
+      capsules_ = capsules;
+      refit ();
+    }
+
+    size_type CapsuleBvh::size () const
+    {
+      return static_cast<size_type> (capsules_.size ());
+    }
+
+    const Capsule& CapsuleBvh::capsule (size_type i) const
+    {
+      assert (i >= 0 && i < size ());
+      return capsules_[static_cast<size_t> (i)];
+    }
+
+    const CapsuleBvh::nodes_t& CapsuleBvh::nodes () const
+    {
+      return nodes_;
+    }
+
+    const std::vector<boost::uint32_t>& CapsuleBvh::order () const
+    {
+      return order_;
+    }
+
+    bool CapsuleBvh::inside (const point_t& point) const
+    {
+      return traverse (nodes_, order_, PointQuery (capsules_, point, 0));
+    }
+
+    void CapsuleBvh::containing (const point_t& point,
+				 std::vector<size_type>& indices) const
+    {
+      indices.clear ();
+      traverse (nodes_, order_, PointQuery (capsules_, point, &indices));
+      std::sort (indices.begin (), indices.end ());
+    }
+
+    size_type CapsuleBvh::nearest (const point_t& point,
+				   value_type& distance) const
+    {
+      distance = inf;
+      size_type index = -1;
+      if (nodes_.empty ())
+	return index;
+
+      boost::uint32_t stack[stackSize];
+      size_t top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+	{
+	  const boost::uint32_t i = stack[--top];
+	  const Node& node = nodes_[i];
+	  if (distanceBound (node, point) >= distance)
+	    continue;
+
+	  if (node.isLeaf ())
+	    {
+	      for (boost::uint32_t k = 0; k < node.count; ++k)
+		{
+		  const boost::uint32_t j = order_[node.index + k];
+		  const Capsule& c = capsules_[j];
+		  value_type d = distancePointToSegment (point, c.P0, c.P1)
+		    - c.radius;
+		  if (d < distance)
+		    {
+		      distance = d;
+		      index = static_cast<size_type> (j);
+		    }
+		}
+	      continue;
+	    }
+
+	  // Visit the nearest child first, to shrink the distance early.
+	  boost::uint32_t near = i + 1;
+	  boost::uint32_t far = node.index;
+	  if (distanceBound (nodes_[far], point)
+	      < distanceBound (nodes_[near], point))
+	    std::swap (near, far);
+
+	  assert (top + 2 <= stackSize);
+	  stack[top++] = far;
+	  stack[top++] = near;
+	}
+      return index;
+    }
+
+    bool CapsuleBvh::overlapsAny (const Capsule& capsule) const
+    {
+      return traverse (nodes_, order_, CapsuleQuery (capsules_, capsule, 0));
+    }
+
+    void CapsuleBvh::overlapping (const Capsule& capsule,
+				  std::vector<size_type>& indices) const
+    {
+      indices.clear ();
+      traverse (nodes_, order_,
+		CapsuleQuery (capsules_, capsule, &indices));
+      std::sort (indices.begin (), indices.end ());
+    }
+
+    bool CapsuleBvh::raycast (const point_t& origin,
+			      const vector3_t& direction,
+			      value_type maxDistance,
+			      value_type& distance, size_type& index) const
+    {
+      if (nodes_.empty ())
+	return false;
+
+      const vector3_t inverse = direction.cwiseInverse ();
+      value_type best = maxDistance;
+      bool hit = false;
+      value_type entry;
+
+      boost::uint32_t stack[stackSize];
+      size_t top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+	{
+	  const boost::uint32_t i = stack[--top];
+	  const Node& node = nodes_[i];
+	  if (!rayBox (origin, inverse, node, best, entry))
+	    continue;
+
+	  if (node.isLeaf ())
+	    {
+	      for (boost::uint32_t k = 0; k < node.count; ++k)
+		{
+		  const boost::uint32_t j = order_[node.index + k];
+		  value_type t;
+		  if (rayCapsuleIntersection (origin, direction,
+					      capsules_[j], t)
+		      && t <= best)
+		    {
+		      best = t;
+		      index = static_cast<size_type> (j);
+		      hit = true;
+		    }
+		}
+	      continue;
+	    }
+
+	  // Visit the child entered first, to shorten the ray early.
+	  value_type nearEntry = inf;
+	  value_type farEntry = inf;
+	  boost::uint32_t near = i + 1;
+	  boost::uint32_t far = node.index;
+	  bool hitNear = rayBox (origin, inverse, nodes_[near], best,
+				 nearEntry);
+	  bool hitFar = rayBox (origin, inverse, nodes_[far], best, farEntry);
+	  if (farEntry < nearEntry)
+	    {
+	      std::swap (near, far);
+	      std::swap (hitNear, hitFar);
+	    }
+
+	  assert (top + 2 <= stackSize);
+	  if (hitFar)
+	    stack[top++] = far;
+	  if (hitNear)
+	    stack[top++] = near;
+	}
+
+      if (hit)
+	distance = best;
+      return hit;
+    }
+
+    bool rayCapsuleIntersection (const point_t& origin,
+				 const vector3_t& direction,
+				 const Capsule& capsule,
+				 value_type& distance)
+    {
+      if (distancePointToSegment (origin, capsule.P0, capsule.P1)
+	  <= capsule.radius)
+	{
+	  distance = 0.;
+	  return true;
+	}
+
+      // The capsule is the union of a cylinder and two spheres, and the
+      // flat ends of the cylinder are inside the spheres: the first hit
+      // is on the lateral surface or on a sphere.
+      const value_type r2 = capsule.radius * capsule.radius;
+      const vector3_t axis = capsule.P1 - capsule.P0;
+      const vector3_t offset = origin - capsule.P0;
+      value_type best = inf;
+
+      // Squared distance to the axis line along the ray, times the
+      // squared axis length: a t^2 + 2 b t + c = 0.
+      const value_type aa = axis.squaredNorm ();
+      const value_type ad = axis.dot (direction);
+      const value_type ao = axis.dot (offset);
+      const value_type a = aa - ad * ad;
+      if (a > parallelTolerance * aa && aa > 0.)
+	{
+	  value_type b = aa * direction.dot (offset) - ao * ad;
+	  value_type c = aa * offset.squaredNorm () - ao * ao - r2 * aa;
+	  value_type h = b * b - a * c;
+	  if (h >= 0.)
+	    {
+	      value_type t = (-b - std::sqrt (h)) / a;
+	      value_type y = ao + t * ad;
+	      if (t >= 0. && y >= 0. && y <= aa)
+		best = t;
+	    }
+	}
+
+      value_type t;
+      if (raySphere (offset, direction, r2, t))
+	best = std::min (best, t);
+      if (raySphere (origin - capsule.P1, direction, r2, t))
+	best = std::min (best, t);
+
+      if (best == inf)
+	return false;
+      distance = best;
+      return true;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_CAPSULE_BVH_CC_
@@ -0,0 +1,478 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/capsule-distance.cc
+ *
+ * \brief Implementation of the capsule-capsule distance and overlap
+ * queries.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_CC_
+# define ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_CC_
+
+# include <algorithm>
+# include <cassert>
+# include <cmath>
+# include <limits>
+
+# include <roboptim/capsule/capsule-distance.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Number of capsules processed at once by the batched
+      /// queries.
+      const size_type blockSize = 256;
+
+      /// \brief Squared length below which a segment is a point.
+      const value_type degenerateLength2 = 1e-12;
+
+      /// \brief Stack-allocated lane of values, one per capsule.
+      typedef Eigen::Array<value_type, Eigen::Dynamic, 1, 0, blockSize, 1>
+      lane_t;
+
+      /// \brief Stack-allocated lane of booleans, one per capsule.
+      typedef Eigen::Array<bool, Eigen::Dynamic, 1, 0, blockSize, 1>
+      mask_t;
+
+      /// \brief Segments and radii of a block of capsules, one lane per
+      /// coordinate.
+      struct CapsuleLanes
+      {
+	/// \brief Load capsules j to j + n - 1 of a set.
+	void load (const CapsuleSet& capsules, size_type j, size_type n)
+	{
+	  const CapsuleSet::parameters_t& p = capsules.parameters ();
+	  x = p.col (0).segment (j, n).array ();
+	  y = p.col (1).segment (j, n).array ();
+	  z = p.col (2).segment (j, n).array ();
+	  dx = p.col (3).segment (j, n).array () - x;
+	  dy = p.col (4).segment (j, n).array () - y;
+	  dz = p.col (5).segment (j, n).array () - z;
+	  radius = p.col (6).segment (j, n).array ();
+	}
+
+	/// \brief Repeat a capsule n times.
+	void broadcast (const Capsule& capsule, size_type n)
+	{
+	  x.setConstant (n, capsule.P0[0]);
+	  y.setConstant (n, capsule.P0[1]);
+	  z.setConstant (n, capsule.P0[2]);
+	  dx.setConstant (n, capsule.P1[0] - capsule.P0[0]);
+	  dy.setConstant (n, capsule.P1[1] - capsule.P0[1]);
+	  dz.setConstant (n, capsule.P1[2] - capsule.P0[2]);
+	  radius.setConstant (n, capsule.radius);
+	}
+
+	/// \brief Start points.
+	lane_t x, y, z;
+
+	/// \brief Vectors from the start points to the end points.
+	lane_t dx, dy, dz;
+
+	lane_t radius;
+      };
+
+      lane_t clamp01 (const lane_t& v)
+      {
+	return v.max (0.).min (1.);
+      }
+
+      /// \brief Squared distances between the segments of two blocks
+      /// of capsules, lane by lane.
+      ///
+      /// This is closestPointsOnSegments with the branches replaced by
+      /// selections, so that Eigen vectorizes it.
+      void segmentDistances2 (const CapsuleLanes& p, const CapsuleLanes& q,
+			      lane_t& d2)
+      {
+	lane_t rx = p.x - q.x;
+	lane_t ry = p.y - q.y;
+	lane_t rz = p.z - q.z;
+
+	lane_t a = p.dx.square () + p.dy.square () + p.dz.square ();
+	lane_t e = q.dx.square () + q.dy.square () + q.dz.square ();
+	lane_t b = p.dx * q.dx + p.dy * q.dy + p.dz * q.dz;
+	lane_t c = p.dx * rx + p.dy * ry + p.dz * rz;
+	lane_t f = q.dx * rx + q.dy * ry + q.dz * rz;
+
+	mask_t pointP = a <= degenerateLength2;
+	mask_t pointQ = e <= degenerateLength2;
+	lane_t aSafe = pointP.select (1., a);
+	lane_t eSafe = pointQ.select (1., e);
+
+	// General case: closest points of the lines, clamped on the
+	// first segment, then on the second one.
+	lane_t denom = a * e - b * b;
+	mask_t parallel = denom <= degenerateLength2 * a * e;
+	lane_t s = parallel.select
+	  (0., clamp01 ((b * f - c * e) / parallel.select (1., denom)));
+	lane_t t = (b * s + f) / eSafe;
+	s = (t < 0.).select (clamp01 (-c / aSafe),
+			     (t > 1.).select (clamp01 ((b - c) / aSafe), s));
+	t = clamp01 (t);
+
+	// The second segment is a point.
+	s = pointQ.select (clamp01 (-c / aSafe), s);
+	t = pointQ.select (0., t);
+
+	// The first segment is a point.
+	t = pointP.select (pointQ.select (0., clamp01 (f / eSafe)), t);
+	s = pointP.select (0., s);
+
+	d2 = (rx + s * p.dx - t * q.dx).square ()
+	  + (ry + s * p.dy - t * q.dy).square ()
+	  + (rz + s * p.dz - t * q.dz).square ();
+      }
+
+      /// \brief Overlaps between a capsule and capsules j to j + n - 1
+      /// of a set.
+      void overlaps (const CapsuleLanes& p, const CapsuleSet& capsules,
+		     size_type j, size_type n, mask_t& overlap)
+      {
+	CapsuleLanes q;
+	q.load (capsules, j, n);
+	lane_t d2;
+	segmentDistances2 (p, q, d2);
+	overlap = d2 <= (p.radius + q.radius).square ();
+      }
+
+      /// \brief Whether the pair (i, j) is tested.
+      bool tested (const pairMask_t& mask, size_type i, size_type j)
+      {
+	return mask.size () == 0 || mask (i, j);
+      }
+
+      void checkMask (const CapsuleSet& capsules, const pairMask_t& mask)
+      {
+	assert ((mask.size () == 0
+		 || (mask.rows () == capsules.size ()
+		     && mask.cols () == capsules.size ()))
+		&& "Pair mask size should match the number of capsules.");
+	(void)capsules;
+	(void)mask;
+      }
+    } // end of anonymous namespace.
+
+    CapsuleSet::CapsuleSet ()
+      : parameters_ (),
+	size_ (0)
+    {
+    }
+
+    CapsuleSet::CapsuleSet (const std::vector<Capsule>& capsules)
+      : parameters_ (static_cast<size_type> (capsules.size ()), 7),
+	size_ (0)
+    {
+      for (size_t i = 0; i < capsules.size (); ++i)
+	add (capsules[i]);
+    }
+
+    void CapsuleSet::add (const Capsule& capsule)
+    {
+      // Capacity grows geometrically.
+      if (size_ == parameters_.rows ())
+	parameters_.conservativeResize (std::max<size_type> (16, 2 * size_),
+					Eigen::NoChange);
+
+      ++size_;
+      this->capsule (size_ - 1, capsule);
+    }
+
+    void CapsuleSet::clear ()
+    {
+      size_ = 0;
+    }
+
+    size_type CapsuleSet::size () const
+    {
+      return size_;
+    }
+
+    Capsule CapsuleSet::capsule (size_type i) const
+    {
+      assert (i < size_);
+
+      Capsule capsule;
+      capsule.P0 = parameters_.row (i).segment<3> (0).transpose ();
+      capsule.P1 = parameters_.row (i).segment<3> (3).transpose ();
+      capsule.radius = parameters_ (i, 6);
+      return capsule;
+    }
+
+    void CapsuleSet::capsule (size_type i, const Capsule& capsule)
+    {
+      assert (i < size_);
+
+      parameters_.row (i).segment<3> (0) = capsule.P0.transpose ();
+      parameters_.row (i).segment<3> (3) = capsule.P1.transpose ();
+      parameters_ (i, 6) = capsule.radius;
+    }
+
+    const CapsuleSet::parameters_t& CapsuleSet::parameters () const
+    {
+      return parameters_;
+    }
+
+    value_type closestPointsOnSegments (const point_t& p0,
+					const point_t& p1,
+					const point_t& q0,
+					const point_t& q1,
+					value_type& s,
+					value_type& t)
+    {
+      vector3_t d1 = p1 - p0;
+      vector3_t d2 = q1 - q0;
+      vector3_t r = p0 - q0;
+      value_type a = d1.squaredNorm ();
+      value_type e = d2.squaredNorm ();
+
+      if (a <= degenerateLength2)
+	{
+	  // The first segment is a point.
+	  s = 0.;
+	  t = (e <= degenerateLength2) ? 0.
+	    : projectionParameterOnSegment (p0, q0, q1);
+	  return distancePointToSegment (p0, q0, q1);
+	}
+      if (e <= degenerateLength2)
+	{
+	  // The second segment is a point.
+	  s = projectionParameterOnSegment (q0, p0, p1);
+	  t = 0.;
+	  return distancePointToSegment (q0, p0, p1);
+	}
+
+      value_type b = d1.dot (d2);
+      value_type c = d1.dot (r);
+      value_type f = d2.dot (r);
+
+      // Closest points of the lines, clamped on the first segment. For
+      // parallel segments, any point of the first segment is a
+      // candidate.
+      value_type denom = a * e - b * b;
+      s = (denom <= degenerateLength2 * a * e) ? 0.
+	: std::min (std::max ((b * f - c * e) / denom, 0.), 1.);
+
+      // Closest point of the second segment, and of the first segment
+      // if it had to be clamped.
+      t = (b * s + f) / e;
+      if (t < 0.)
+	{
+	  t = 0.;
+	  s = std::min (std::max (-c / a, 0.), 1.);
+	}
+      else if (t > 1.)
+	{
+	  t = 1.;
+	  s = std::min (std::max ((b - c) / a, 0.), 1.);
+	}
+
+      return (r + s * d1 - t * d2).norm ();
+    }
+
+    value_type distanceSegmentToSegment (const point_t& p0,
+					 const point_t& p1,
+					 const point_t& q0,
+					 const point_t& q1)
+    {
+      value_type s, t;
+      return closestPointsOnSegments (p0, p1, q0, q1, s, t);
+    }
+
+    value_type distanceCapsuleToCapsule (const Capsule& a, const Capsule& b)
+    {
+      return distanceSegmentToSegment (a.P0, a.P1, b.P0, b.P1)
+	- a.radius - b.radius;
+    }
+
+    bool capsulesOverlap (const Capsule& a, const Capsule& b)
+    {
+      return distanceCapsuleToCapsule (a, b) <= 0.;
+    }
+
+    void distancesCapsuleToCapsules (const Capsule& capsule,
+				     const CapsuleSet& capsules,
+				     Eigen::Ref<vector_t> distances)
+    {
+      assert (distances.size () == capsules.size ());
+
+      CapsuleLanes p, q;
+      lane_t d2;
+      for (size_type j = 0; j < capsules.size (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, capsules.size () - j);
+	  p.broadcast (capsule, n);
+	  q.load (capsules, j, n);
+	  segmentDistances2 (p, q, d2);
+	  distances.segment (j, n) = (d2.sqrt () - p.radius - q.radius)
+	    .matrix ();
+	}
+    }
+
+    void distancesCapsulePairs (const CapsuleSet& first,
+				const CapsuleSet& second,
+				Eigen::Ref<vector_t> distances)
+    {
+      assert (first.size () == second.size ()
+	      && "Both sets should have the same size.");
+      assert (distances.size () == first.size ());
+
+      CapsuleLanes p, q;
+      lane_t d2;
+      for (size_type j = 0; j < first.size (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, first.size () - j);
+	  p.load (first, j, n);
+	  q.load (second, j, n);
+	  segmentDistances2 (p, q, d2);
+	  distances.segment (j, n) = (d2.sqrt () - p.radius - q.radius)
+	    .matrix ();
+	}
+    }
+
+    bool overlapsAny (const Capsule& capsule, const CapsuleSet& capsules)
+    {
+      CapsuleLanes p;
+      mask_t overlap;
+      for (size_type j = 0; j < capsules.size (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, capsules.size () - j);
+	  p.broadcast (capsule, n);
+	  overlaps (p, capsules, j, n, overlap);
+	  if (overlap.any ())
+	    return true;
+	}
+      return false;
+    }
+
+    void overlappingCapsules (const Capsule& capsule,
+			      const CapsuleSet& capsules,
+			      std::vector<size_type>& indices)
+    {
+      indices.clear ();
+
+      CapsuleLanes p;
+      mask_t overlap;
+      for (size_type j = 0; j < capsules.size (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, capsules.size () - j);
+	  p.broadcast (capsule, n);
+	  overlaps (p, capsules, j, n, overlap);
+	  for (size_type i = 0; i < n; ++i)
+	    if (overlap[i])
+	      indices.push_back (j + i);
+	}
+    }
+
+    void selfDistances (const CapsuleSet& capsules,
+			const pairMask_t& mask,
+			matrix_t& distances)
+    {
+      checkMask (capsules, mask);
+
+      const size_type size = capsules.size ();
+      distances.setConstant (size, size,
+			     std::numeric_limits<value_type>::infinity ());
+
+      // Capsule i against capsules i + 1 to size - 1.
+      CapsuleLanes p, q;
+      lane_t d2;
+      for (size_type i = 0; i < size; ++i)
+	{
+	  Capsule capsule = capsules.capsule (i);
+	  for (size_type j = i + 1; j < size; j += blockSize)
+	    {
+	      size_type n = std::min (blockSize, size - j);
+	      p.broadcast (capsule, n);
+	      q.load (capsules, j, n);
+	      segmentDistances2 (p, q, d2);
+	      d2 = d2.sqrt () - p.radius - q.radius;
+
+	      for (size_type k = 0; k < n; ++k)
+		if (tested (mask, i, j + k))
+		  distances (i, j + k) = distances (j + k, i) = d2[k];
+	    }
+	}
+    }
+
+    void selfOverlaps (const CapsuleSet& capsules,
+		       const pairMask_t& mask,
+		       std::vector<capsulePair_t>& pairs)
+    {
+      checkMask (capsules, mask);
+      pairs.clear ();
+
+      const size_type size = capsules.size ();
+      CapsuleLanes p;
+      mask_t overlap;
+      for (size_type i = 0; i < size; ++i)
+	{
+	  Capsule capsule = capsules.capsule (i);
+	  for (size_type j = i + 1; j < size; j += blockSize)
+	    {
+	      size_type n = std::min (blockSize, size - j);
+	      p.broadcast (capsule, n);
+	      overlaps (p, capsules, j, n, overlap);
+
+	      for (size_type k = 0; k < n; ++k)
+		if (overlap[k] && tested (mask, i, j + k))
+		  pairs.push_back (capsulePair_t (i, j + k));
+	    }
+	}
+    }
+
+    bool selfOverlapsAny (const CapsuleSet& capsules, const pairMask_t& mask)
+    {
+      checkMask (capsules, mask);
+
+      const size_type size = capsules.size ();
+      CapsuleLanes p;
+      mask_t overlap;
+      for (size_type i = 0; i < size; ++i)
+	{
+	  Capsule capsule = capsules.capsule (i);
+	  for (size_type j = i + 1; j < size; j += blockSize)
+	    {
+	      size_type n = std::min (blockSize, size - j);
+	      p.broadcast (capsule, n);
+	      overlaps (p, capsules, j, n, overlap);
+
+	      if (mask.size () == 0)
+		{
+		  if (overlap.any ())
+		    return true;
+		  continue;
+		}
+
+	      for (size_type k = 0; k < n; ++k)
+		if (overlap[k] && mask (i, j + k))
+		  return true;
+	    }
+	}
+      return false;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_CAPSULE_DISTANCE_CC_
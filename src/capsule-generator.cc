@@ -22,17 +22,114 @@
  * \brief CLI capsule generator.
  */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/program_options.hpp>
 
+#include <roboptim/capsule/batch-fitter.hh>
+#include <roboptim/capsule/batch-report.hh>
+#include <roboptim/capsule/direct-fitter.hh>
+#include <roboptim/capsule/fit-cache.hh>
 #include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/mesh-reader.hh>
 #include <roboptim/capsule/util.hh>
 
 using namespace roboptim;
 using namespace roboptim::capsule;
 
+namespace
+{
+  /// \brief Mesh files of a batch, with the names of their records.
+  struct BatchInput
+  {
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+  };
+
+  /// \brief List the meshes of a batch.
+  ///
+  /// A directory gives all its files with a known mesh extension,
+  /// sorted by name; the ".xyz" files are only listed if the raw xyz
+  /// format is given explicitly. Otherwise, the file is a manifest
+  /// giving one mesh path per line, relative to the manifest
+  /// directory; empty lines and lines starting with '#' are skipped.
+  BatchInput listBatch (const std::string& batch, MeshFormat format)
+  {
+    namespace fs = boost::filesystem;
+
+    BatchInput input;
+    fs::path batchPath (batch);
+
+    if (fs::is_directory (batchPath))
+      {
+	std::vector<fs::path> files;
+	for (fs::directory_iterator it (batchPath), end; it != end; ++it)
+	  if (fs::is_regular_file (it->status ())
+	      && (meshFormatFromPath (it->path ().string ())
+		  != MESH_FORMAT_AUTO
+		  || (format == MESH_FORMAT_XYZ
+		      && boost::iequals (it->path ().extension ().string (),
+					 ".xyz"))))
+	    files.push_back (it->path ());
+	std::sort (files.begin (), files.end ());
+
+	for (size_t i = 0; i < files.size (); ++i)
+	  {
+	    input.paths.push_back (files[i].string ());
+	    input.names.push_back (files[i].filename ().string ());
+	  }
+	return input;
+      }
+
+    std::ifstream manifest (batch.c_str ());
+    if (!manifest)
+      throw std::runtime_error ("cannot open " + batch);
+
+    std::string line;
+    while (std::getline (manifest, line))
+      {
+	// Trim the line.
+	std::string::size_type begin = line.find_first_not_of (" \t\r");
+	if (begin == std::string::npos || line[begin] == '#')
+	  continue;
+	std::string::size_type end = line.find_last_not_of (" \t\r");
+	std::string name = line.substr (begin, end - begin + 1);
+
+	fs::path path (name);
+	if (path.is_relative ())
+	  path = batchPath.parent_path () / path;
+
+	input.paths.push_back (path.string ());
+	input.names.push_back (name);
+      }
+    return input;
+  }
+
+  /// \brief Load the convex hull of a mesh file.
+  polyhedrons_t loadMesh (const std::vector<std::string>& paths,
+			  MeshFormat format, size_t i)
+  {
+    ConvexHullAccumulator hull;
+    void (ConvexHullAccumulator::*add) (const polyhedron_t&)
+      = &ConvexHullAccumulator::add;
+    readMeshFile (paths[i], format, boost::bind (add, &hull, _1));
+
+    if (hull.nbPoints () == 0)
+      throw std::runtime_error ("no point was read from " + paths[i]);
+
+    return polyhedrons_t (1, hull.hull ());
+  }
+} // end of anonymous namespace.
+
 int main(int argc, char** argv)
 {
   try
@@ -42,12 +139,34 @@ int main(int argc, char** argv)
       po::options_description desc ("Options");
       desc.add_options ()
 	("help", "Print this help and exit")
-	("solver", po::value<std::string> (), "Nonlinear solver used")
+	("solver", po::value<std::string> (),
+	 "Nonlinear solver used, or \"direct\" for the direct fitter")
 	("log-dir", po::value<std::string> (), "Path to optimization logs")
-	("points", po::value<std::vector<double> > ()->multitoken ()->required (),
-	 "Points that will be encapsulated");
+	("cache", po::value<std::string> (),
+	 "Cache file of fitted capsules, reused across runs")
+	("verbose", "Print solver diagnostics and write them to "
+	 "fitter-ipopt.log; in batch mode, only write them to the "
+	 "per-fit logs of --log-dir")
+	("input", po::value<std::vector<std::string> > ()->multitoken (),
+	 "Mesh or point cloud files that will be encapsulated (PLY, STL, "
+	 "OBJ or raw float64 xyz), \"-\" for the standard input")
+	("format", po::value<std::string> ()->default_value ("auto"),
+	 "Format of the input files: auto, ply, stl, obj or xyz (raw "
+	 "float64, never detected automatically)")
+	("points", po::value<std::vector<double> > ()->multitoken (),
+	 "Points that will be encapsulated")
+	("batch", po::value<std::string> (),
+	 "Fit one capsule per mesh of a directory, or of a manifest file "
+	 "listing one mesh path per line")
+	("threads", po::value<size_t> ()->default_value (0),
+	 "Number of worker threads in batch mode, 0 for the number of cores")
+	("output", po::value<std::string> (),
+	 "Output file of the batch report (default: standard output)")
+	("output-format", po::value<std::string> ()->default_value ("json"),
+	 "Format of the batch report: json or csv");
 
       po::positional_options_description positionalOptions;
+      positionalOptions.add ("input", -1);
 
       po::variables_map vm;
 
@@ -78,58 +197,166 @@ int main(int argc, char** argv)
 	      solver = vm["solver"].as<std::string> ();
 	    }
 
+	  // Batch mode: one record per mesh
+	  if (vm.count ("batch"))
+	    {
+	      if (solver == "direct")
+		{
+		  std::cerr << "Error: the batch mode needs a nonlinear "
+			    << "solver." << std::endl;
+		  return EXIT_FAILURE;
+		}
+
+	      MeshFormat format
+		= meshFormatFromString (vm["format"].as<std::string> ());
+	      BatchInput input = listBatch (vm["batch"].as<std::string> (),
+					    format);
+	      ReportFormat reportFormat = reportFormatFromString
+		(vm["output-format"].as<std::string> ());
+
+	      if (vm.count ("verbose") && !vm.count ("log-dir"))
+		{
+		  std::cerr << "Error: --verbose needs --log-dir in batch "
+			    << "mode." << std::endl;
+		  return EXIT_FAILURE;
+		}
+
+	      BatchFitter batchFitter (solver, vm["threads"].as<size_t> ());
+
+	      // Diagnostics only go to the per-fit log files: the
+	      // console output of concurrent fits would be interleaved,
+	      // and mixed with the report.
+	      if (vm.count ("verbose"))
+		{
+		  FitterOptions options = FitterOptions::debug ();
+		  options.parameters["ipopt.print_level"] = 0;
+		  options.parameters["ipopt.sb"] = std::string ("yes");
+		  options.verbose = false;
+		  batchFitter.options () = options;
+		}
+	      if (vm.count ("log-dir"))
+		batchFitter.solverLogDirectory ()
+		  = vm["log-dir"].as<std::string> ();
+	      if (vm.count ("cache"))
+		batchFitter.cache () = boost::make_shared<FitCache>
+		  (vm["cache"].as<std::string> ());
+
+	      // Meshes are loaded by the workers, right before their fit
+	      BatchFitter::results_t results = batchFitter.fit
+		(input.paths.size (),
+		 boost::bind (&loadMesh, boost::cref (input.paths),
+			      format, _1));
+
+	      if (vm.count ("output"))
+		{
+		  const std::string& output = vm["output"].as<std::string> ();
+		  std::ofstream file (output.c_str ());
+		  if (!file)
+		    {
+		      std::cerr << "Error: cannot open " << output
+				<< std::endl;
+		      return EXIT_FAILURE;
+		    }
+		  writeBatchReport (file, input.names, results, reportFormat);
+		}
+	      else
+		writeBatchReport (std::cout, input.names, results,
+				  reportFormat);
+
+	      // Fail if any fit failed
+	      for (size_t i = 0; i < results.size (); ++i)
+		if (results[i].status == GenericSolver::SOLVER_ERROR)
+		  return EXIT_FAILURE;
+	      return EXIT_SUCCESS;
+	    }
+
 	  // Check that points data was given
-	  if (!vm.count ("points"))
+	  if (!vm.count ("points") && !vm.count ("input"))
 	    {
 	      std::cerr << "Error: missing mandatory point data." << std::endl;
 	      return EXIT_FAILURE;
 	    }
 
+	  // Only the convex hull of the points is kept in memory, the
+	  // input files being read by chunks
+	  ConvexHullAccumulator hull;
+
 	  // Get points from CLI options
-	  const std::vector<double>&
-	    points = vm["points"].as<std::vector<double> > ();
+	  if (vm.count ("points"))
+	    {
+	      const std::vector<double>&
+		points = vm["points"].as<std::vector<double> > ();
+
+	      if (points.size ()%3 != 0)
+		{
+		  std::cerr << "Error: points should be an array of 3D points, "
+			    << "e.g. x0 y0 z0 x1 y1 z1 etc." << std::endl;
+		  return EXIT_FAILURE;
+		}
 
-	  if (points.size ()%3 != 0)
+	      for (size_t i = 0; i < points.size (); i+=3)
+		hull.add (point_t (points[i], points[i+1], points[i+2]));
+	    }
+
+	  // Get points from input files
+	  if (vm.count ("input"))
 	    {
-	      std::cerr << "Error: points should be an array of 3D points, "
-			<< "e.g. x0 y0 z0 x1 y1 z1 etc." << std::endl;
-	      return EXIT_FAILURE;
+	      const std::vector<std::string>&
+		inputs = vm["input"].as<std::vector<std::string> > ();
+	      MeshFormat format
+		= meshFormatFromString (vm["format"].as<std::string> ());
+
+	      void (ConvexHullAccumulator::*add) (const polyhedron_t&)
+		= &ConvexHullAccumulator::add;
+	      for (size_t i = 0; i < inputs.size (); ++i)
+		readMeshFile (inputs[i], format, boost::bind (add, &hull, _1));
 	    }
 
-	  // Load polyhedron
-	  polyhedron_t polyhedron;
-	  for (size_t i = 0; i < points.size (); i+=3)
+	  if (hull.nbPoints () == 0)
 	    {
-	      point_t p (points[i], points[i+1], points[i+2]);
-	      polyhedron.push_back (p);
+	      std::cerr << "Error: no point was read." << std::endl;
+	      return EXIT_FAILURE;
 	    }
 
 	  // Fitter expects a vector of polyhedrons
 	  polyhedrons_t polyhedrons;
-	  polyhedrons.push_back (polyhedron);
+	  polyhedrons.push_back (hull.hull ());
+
+	  // The direct fitter does not need any nonlinear solver
+	  if (solver == "direct")
+	    {
+	      DirectFitter directFitter (polyhedrons);
+	      directFitter.computeBestFitCapsule ();
+
+	      std::cout << "Solution: " << directFitter.solutionParam ()
+			<< std::endl;
+	      return EXIT_SUCCESS;
+	    }
 
 	  // Create fitter
 	  Fitter fitter (polyhedrons, solver);
 
+	  // Print solver diagnostics if requested
+	  if (vm.count ("verbose"))
+	    {
+	      fitter.options () = FitterOptions::debug ();
+	    }
+
 	  // Load (optional) log directory
 	  if (vm.count ("log-dir"))
 	    {
 	      fitter.logDirectory () = vm["log-dir"].as<std::string> ();
 	    }
 
-	  // Compute initial guess
-	  point_t P0;
-	  point_t P1;
-	  value_type r = 0.;
-	  argument_t initParam (7);
-
-	  polyhedrons_t convexPolyhedrons;
-	  computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
-	  computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
-	  convertCapsuleToSolverParam (initParam, P0, P1, r);
+	  // Load (optional) fit cache
+	  if (vm.count ("cache"))
+	    {
+	      fitter.cache () = boost::make_shared<FitCache>
+		(vm["cache"].as<std::string> ());
+	    }
 
-	  // Compute optimal capsule
-	  fitter.computeBestFitCapsule (initParam);
+	  // Compute optimal capsule, starting from the bounding capsule
+	  fitter.computeBestFitCapsule ();
 
 	  // Display result
 	  std::cout << "Initial: " << fitter.initParam () << std::endl;
@@ -0,0 +1,545 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/convex-hull.cc
+ *
+ * \brief Implementation of the 3D quickhull algorithm.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_CONVEX_HULL_CC_
+# define ROBOPTIM_CAPSULE_CONVEX_HULL_CC_
+
+# include <algorithm>
+# include <cmath>
+# include <limits>
+# include <vector>
+
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Triangular face of the hull under construction.
+      ///
+      /// Vertices are stored counterclockwise when seen from outside,
+      /// and neighbor[i] is the face sharing the edge
+      /// (vertex[i], vertex[(i+1)%3]).
+      struct Face
+      {
+	int vertex[3];
+	int neighbor[3];
+
+	/// \brief Outward unit normal and plane offset.
+	vector3_t normal;
+	value_type offset;
+
+	/// \brief Points above the face, and the furthest one.
+	std::vector<int> outside;
+	int furthest;
+	value_type furthestDistance;
+
+	bool deleted;
+	bool visited;
+      };
+
+      /// \brief 3D quickhull.
+      ///
+      /// The hull is computed on indices into the input points, which
+      /// are never copied. Points closer than a tolerance (relative to
+      /// the point cloud extent) to a face are considered inside.
+      class QuickHull
+      {
+      public:
+	QuickHull (const_points_ref points)
+	  : points_ (points),
+	    epsilon_ (0.)
+	{
+	}
+
+	/// \brief Compute the indices of the hull vertices.
+	void compute (std::vector<int>& vertices);
+
+      private:
+	value_type distance (const Face& face, int p) const
+	{
+	  return face.normal.dot (points_.col (p)) - face.offset;
+	}
+
+	int addFace (int a, int b, int c);
+	void assignOutside (const std::vector<int>& candidates,
+			    const std::vector<int>& newFaces);
+	void addPoint (int faceId);
+	void computeCoplanarHull (int i0, int i1, int i2,
+				  std::vector<int>& vertices) const;
+
+	/// \brief Number of input points.
+	size_t nbPoints () const
+	{
+	  return static_cast<size_t> (points_.cols ());
+	}
+
+	const_points_ref points_;
+	value_type epsilon_;
+	std::vector<Face> faces_;
+
+	/// \brief Scratch data reused by every iteration.
+	std::vector<int> visible_;
+	std::vector<int> stack_;
+	std::vector<int> newFaceFromVertex_;
+	std::vector<int> candidates_;
+      };
+
+      int QuickHull::addFace (int a, int b, int c)
+      {
+	Face face;
+	face.vertex[0] = a;
+	face.vertex[1] = b;
+	face.vertex[2] = c;
+	face.neighbor[0] = face.neighbor[1] = face.neighbor[2] = -1;
+
+	face.normal = (points_.col (b) - points_.col (a))
+	  .cross (points_.col (c) - points_.col (a));
+	value_type norm = face.normal.norm ();
+	if (norm > 0.)
+	  face.normal /= norm;
+	face.offset = face.normal.dot (points_.col (a));
+
+	face.furthest = -1;
+	face.furthestDistance = 0.;
+	face.deleted = false;
+	face.visited = false;
+
+	faces_.push_back (face);
+	return static_cast<int> (faces_.size ()) - 1;
+      }
+
+      void QuickHull::assignOutside (const std::vector<int>& candidates,
+				     const std::vector<int>& newFaces)
+      {
+	for (size_t i = 0; i < candidates.size (); ++i)
+	  {
+	    int p = candidates[i];
+
+	    // Keep the point with the face it is the furthest from.
+	    int best = -1;
+	    value_type bestDistance = epsilon_;
+	    for (size_t j = 0; j < newFaces.size (); ++j)
+	      {
+		value_type d = distance (faces_[newFaces[j]], p);
+		if (d > bestDistance)
+		  {
+		    bestDistance = d;
+		    best = newFaces[j];
+		  }
+	      }
+
+	    // Otherwise the point is inside the hull and is discarded.
+	    if (best < 0) continue;
+
+	    Face& face = faces_[best];
+	    face.outside.push_back (p);
+	    if (bestDistance > face.furthestDistance)
+	      {
+		face.furthestDistance = bestDistance;
+		face.furthest = p;
+	      }
+	  }
+      }
+
+      void QuickHull::addPoint (int faceId)
+      {
+	int eye = faces_[faceId].furthest;
+	const point_t& eyePoint = points_.col (eye);
+
+	// Find the faces visible from the eye point with a depth-first
+	// search starting from the face it was assigned to.
+	visible_.clear ();
+	stack_.clear ();
+	stack_.push_back (faceId);
+	faces_[faceId].visited = true;
+
+	while (!stack_.empty ())
+	  {
+	    int f = stack_.back ();
+	    stack_.pop_back ();
+	    visible_.push_back (f);
+
+	    for (int e = 0; e < 3; ++e)
+	      {
+		int n = faces_[f].neighbor[e];
+		Face& neighbor = faces_[n];
+		if (neighbor.visited) continue;
+		if (neighbor.normal.dot (eyePoint) - neighbor.offset > epsilon_)
+		  {
+		    neighbor.visited = true;
+		    stack_.push_back (n);
+		  }
+	      }
+	  }
+
+	// Build the cone of new faces from the horizon edges to the eye
+	// point. A horizon edge (a,b) belongs to a visible face and to a
+	// hidden one.
+	std::vector<int> newFaces;
+	for (size_t i = 0; i < visible_.size (); ++i)
+	  {
+	    // Note: faces are accessed by index since adding faces may
+	    // reallocate the face vector.
+	    int f = visible_[i];
+	    for (int e = 0; e < 3; ++e)
+	      {
+		int n = faces_[f].neighbor[e];
+		if (faces_[n].visited) continue;
+
+		int a = faces_[f].vertex[e];
+		int b = faces_[f].vertex[(e + 1) % 3];
+		int newFace = addFace (a, b, eye);
+
+		// The hidden face now shares the edge (b,a) with the new
+		// face.
+		Face& hidden = faces_[n];
+		for (int k = 0; k < 3; ++k)
+		  if (hidden.vertex[k] == b && hidden.vertex[(k + 1) % 3] == a)
+		    hidden.neighbor[k] = newFace;
+
+		faces_[newFace].neighbor[0] = n;
+		newFaceFromVertex_[a] = newFace;
+		newFaces.push_back (newFace);
+	      }
+	  }
+
+	// Link the new faces together: the face built on (a,b) shares
+	// the edge (b,eye) with the face built on the horizon edge
+	// starting at b.
+	for (size_t i = 0; i < newFaces.size (); ++i)
+	  {
+	    Face& f = faces_[newFaces[i]];
+	    int next = newFaceFromVertex_[f.vertex[1]];
+	    f.neighbor[1] = next;
+	    faces_[next].neighbor[2] = newFaces[i];
+	  }
+
+	// Delete the visible faces and reassign their outside points.
+	candidates_.clear ();
+	for (size_t i = 0; i < visible_.size (); ++i)
+	  {
+	    Face& f = faces_[visible_[i]];
+	    f.deleted = true;
+	    for (size_t j = 0; j < f.outside.size (); ++j)
+	      if (f.outside[j] != eye)
+		candidates_.push_back (f.outside[j]);
+	    std::vector<int> ().swap (f.outside);
+	  }
+
+	assignOutside (candidates_, newFaces);
+
+	for (size_t i = 0; i < newFaces.size (); ++i)
+	  newFaceFromVertex_[faces_[newFaces[i]].vertex[0]] = -1;
+      }
+
+      void QuickHull::computeCoplanarHull (int i0, int i1, int i2,
+					   std::vector<int>& vertices) const
+      {
+	// Project the points on the plane and compute the 2D hull with
+	// Andrew's monotone chain algorithm.
+	vector3_t u = (points_.col (i1) - points_.col (i0)).normalized ();
+	vector3_t n = u.cross (points_.col (i2) - points_.col (i0));
+	vector3_t v = n.cross (u).normalized ();
+
+	std::vector<std::pair<std::pair<value_type, value_type>, int> >
+	  projected (nbPoints ());
+	for (size_t i = 0; i < nbPoints (); ++i)
+	  {
+	    vector3_t d = points_.col (i) - points_.col (i0);
+	    projected[i] = std::make_pair (std::make_pair (d.dot (u), d.dot (v)),
+					   static_cast<int> (i));
+	  }
+	std::sort (projected.begin (), projected.end ());
+
+	std::vector<int> hull (2 * projected.size ());
+	int k = 0;
+	for (int pass = 0; pass < 2; ++pass)
+	  {
+	    int start = k;
+	    for (size_t j = 0; j < projected.size (); ++j)
+	      {
+		size_t i = pass == 0 ? j : projected.size () - 1 - j;
+		const std::pair<value_type, value_type>& p = projected[i].first;
+
+		// Remove points that do not make a left turn, i.e. when p
+		// is not clearly on the left of the line (o,a).
+		while (k >= start + 2)
+		  {
+		    const std::pair<value_type, value_type>& o
+		      = projected[hull[k - 2]].first;
+		    const std::pair<value_type, value_type>& a
+		      = projected[hull[k - 1]].first;
+		    value_type dx = a.first - o.first;
+		    value_type dy = a.second - o.second;
+		    value_type cross = dx * (p.second - o.second)
+		      - dy * (p.first - o.first);
+		    if (cross > epsilon_ * std::sqrt (dx * dx + dy * dy)) break;
+		    --k;
+		  }
+		hull[k++] = static_cast<int> (i);
+	      }
+	    // The last point is the first point of the next chain.
+	    --k;
+	  }
+
+	vertices.clear ();
+	for (int i = 0; i < k; ++i)
+	  vertices.push_back (projected[hull[i]].second);
+      }
+
+      void QuickHull::compute (std::vector<int>& vertices)
+      {
+	vertices.clear ();
+	if (nbPoints () == 0) return;
+
+	// Find the extreme points along the coordinate axes, and use
+	// their coordinates to scale the tolerance.
+	int extremes[6] = {0, 0, 0, 0, 0, 0};
+	vector3_t maxAbs = points_.col (0).cwiseAbs ();
+	for (size_t i = 1; i < nbPoints (); ++i)
+	  {
+	    const point_t& p = points_.col (i);
+	    for (int c = 0; c < 3; ++c)
+	      {
+		if (p[c] < points_.col (extremes[2 * c])[c])
+		  extremes[2 * c] = static_cast<int> (i);
+		if (p[c] > points_.col (extremes[2 * c + 1])[c])
+		  extremes[2 * c + 1] = static_cast<int> (i);
+	      }
+	    maxAbs = maxAbs.cwiseMax (p.cwiseAbs ());
+	  }
+	epsilon_ = 3. * std::numeric_limits<value_type>::epsilon ()
+	  * (maxAbs[0] + maxAbs[1] + maxAbs[2]);
+
+	// Initial simplex: the two most distant extreme points...
+	int i0 = extremes[0], i1 = extremes[0];
+	value_type maxDistance = -1.;
+	for (int a = 0; a < 6; ++a)
+	  for (int b = a + 1; b < 6; ++b)
+	    {
+	      value_type d = (points_.col (extremes[a])
+			      - points_.col (extremes[b])).squaredNorm ();
+	      if (d > maxDistance)
+		{
+		  maxDistance = d;
+		  i0 = extremes[a];
+		  i1 = extremes[b];
+		}
+	    }
+
+	if (std::sqrt (maxDistance) <= epsilon_)
+	  {
+	    // All points coincide.
+	    vertices.push_back (i0);
+	    return;
+	  }
+
+	// ... the point furthest from their line...
+	vector3_t dir = (points_.col (i1) - points_.col (i0)).normalized ();
+	int i2 = -1;
+	maxDistance = epsilon_;
+	for (size_t i = 0; i < nbPoints (); ++i)
+	  {
+	    value_type d
+	      = dir.cross (points_.col (i) - points_.col (i0)).norm ();
+	    if (d > maxDistance)
+	      {
+		maxDistance = d;
+		i2 = static_cast<int> (i);
+	      }
+	  }
+
+	if (i2 < 0)
+	  {
+	    // All points are collinear.
+	    vertices.push_back (i0);
+	    vertices.push_back (i1);
+	    return;
+	  }
+
+	// ... and the point furthest from their plane.
+	vector3_t normal = (points_.col (i1) - points_.col (i0))
+	  .cross (points_.col (i2) - points_.col (i0)).normalized ();
+	int i3 = -1;
+	maxDistance = epsilon_;
+	for (size_t i = 0; i < nbPoints (); ++i)
+	  {
+	    value_type d
+	      = std::fabs (normal.dot (points_.col (i) - points_.col (i0)));
+	    if (d > maxDistance)
+	      {
+		maxDistance = d;
+		i3 = static_cast<int> (i);
+	      }
+	  }
+
+	if (i3 < 0)
+	  {
+	    // All points are coplanar.
+	    computeCoplanarHull (i0, i1, i2, vertices);
+	    return;
+	  }
+
+	// Orient the tetrahedron so that its faces point outward.
+	if (normal.dot (points_.col (i3) - points_.col (i0)) > 0.)
+	  std::swap (i1, i2);
+
+	faces_.clear ();
+	faces_.reserve (8 * nbPoints () / 3 + 16);
+	addFace (i0, i1, i2);
+	addFace (i0, i3, i1);
+	addFace (i1, i3, i2);
+	addFace (i2, i3, i0);
+
+	// Link the faces of the tetrahedron.
+	for (int f = 0; f < 4; ++f)
+	  for (int e = 0; e < 3; ++e)
+	    {
+	      int a = faces_[f].vertex[e];
+	      int b = faces_[f].vertex[(e + 1) % 3];
+	      for (int g = 0; g < 4; ++g)
+		for (int k = 0; k < 3; ++k)
+		  if (faces_[g].vertex[k] == b
+		      && faces_[g].vertex[(k + 1) % 3] == a)
+		    faces_[f].neighbor[e] = g;
+	    }
+
+	// Assign every point to a face it lies above.
+	std::vector<int> initialFaces (4);
+	for (int f = 0; f < 4; ++f)
+	  initialFaces[f] = f;
+	candidates_.clear ();
+	for (size_t i = 0; i < nbPoints (); ++i)
+	  {
+	    int p = static_cast<int> (i);
+	    if (p != i0 && p != i1 && p != i2 && p != i3)
+	      candidates_.push_back (p);
+	  }
+	std::vector<int> initialCandidates;
+	initialCandidates.swap (candidates_);
+	assignOutside (initialCandidates, initialFaces);
+
+	// Expand the hull until no point is left outside. Faces created
+	// during the loop are appended, so a single sweep is enough.
+	newFaceFromVertex_.assign (nbPoints (), -1);
+	for (size_t f = 0; f < faces_.size (); ++f)
+	  {
+	    if (faces_[f].deleted || faces_[f].outside.empty ())
+	      continue;
+
+	    addPoint (static_cast<int> (f));
+
+	    // Reset the visited flags of the faces still alive.
+	    for (size_t i = 0; i < visible_.size (); ++i)
+	      faces_[visible_[i]].visited = false;
+	  }
+
+	// Gather the vertices of the remaining faces.
+	std::vector<bool> isVertex (nbPoints (), false);
+	for (size_t f = 0; f < faces_.size (); ++f)
+	  if (!faces_[f].deleted)
+	    for (int k = 0; k < 3; ++k)
+	      isVertex[faces_[f].vertex[k]] = true;
+
+	for (size_t i = 0; i < nbPoints (); ++i)
+	  if (isVertex[i])
+	    vertices.push_back (static_cast<int> (i));
+      }
+    } // end of anonymous namespace.
+
+
+    polyhedron_t convexHullFromPoints (const std::vector<point_t>& points)
+    {
+      return convexHullFromPoints (pointsMap (points));
+    }
+
+    polyhedron_t convexHullFromPoints (const_points_ref points)
+    {
+      std::vector<int> vertices;
+      QuickHull quickHull (points);
+      quickHull.compute (vertices);
+
+      // Return the convex hull vertices as a polyhedron.
+      polyhedron_t convexPolyhedron (vertices.size ());
+      for (size_t i = 0; i < vertices.size (); ++i)
+	convexPolyhedron[i] = points.col (vertices[i]);
+
+      return convexPolyhedron;
+    }
+
+    ConvexHullAccumulator::
+    ConvexHullAccumulator (size_t bufferSize)
+      : points_ (),
+	bufferSize_ (std::max (bufferSize, static_cast<size_t> (1))),
+	hullSize_ (0),
+	nbPoints_ (0)
+    {
+    }
+
+    void ConvexHullAccumulator::
+    add (const std::vector<point_t>& points)
+    {
+      BOOST_FOREACH (const point_t& point, points)
+	add (point);
+    }
+
+    void ConvexHullAccumulator::
+    add (const point_t& point)
+    {
+      points_.push_back (point);
+      ++nbPoints_;
+
+      if (points_.size () >= hullSize_ + bufferSize_)
+	reduce ();
+    }
+
+    const polyhedron_t& ConvexHullAccumulator::
+    hull ()
+    {
+      if (points_.size () > hullSize_)
+	reduce ();
+
+      return points_;
+    }
+
+    size_t ConvexHullAccumulator::
+    nbPoints () const
+    {
+      return nbPoints_;
+    }
+
+    void ConvexHullAccumulator::
+    reduce ()
+    {
+      polyhedron_t hull = convexHullFromPoints (points_);
+      points_.swap (hull);
+      hullSize_ = points_.size ();
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_CONVEX_HULL_CC_
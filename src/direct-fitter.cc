@@ -0,0 +1,495 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/direct-fitter.cc
+ *
+ * \brief Implementation of DirectFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DIRECT_FITTER_CC_
+# define ROBOPTIM_CAPSULE_DIRECT_FITTER_CC_
+
+# include <math.h>
+
+# include <algorithm>
+# include <limits>
+# include <utility>
+
+# include <roboptim/capsule/direct-fitter.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 2, 1> point2_t;
+
+      /// \brief Number of golden section iterations used to find the
+      /// radius. The bracket shrinks by 0.618 at each iteration.
+      const int nbRadiusIterations = 60;
+
+      /// \brief Capsule volume.
+      value_type capsuleVolume (value_type radius, value_type length)
+      {
+	return M_PI * radius * radius * length
+	  + 4. / 3. * M_PI * radius * radius * radius;
+      }
+
+      /// \brief Circle going through three points, or enclosing the
+      /// two furthest ones if the points are collinear.
+      void circleFromThreePoints (const point2_t& a, const point2_t& b,
+				  const point2_t& c,
+				  point2_t& center, value_type& radius)
+      {
+	point2_t ab = b - a;
+	point2_t ac = c - a;
+	value_type det = 2. * (ab[0] * ac[1] - ab[1] * ac[0]);
+	value_type scale = ab.squaredNorm () + ac.squaredNorm ();
+
+	if (std::fabs (det) > std::numeric_limits<value_type>::epsilon ()
+	    * scale)
+	  {
+	    point2_t offset ((ac[1] * ab.squaredNorm ()
+			      - ab[1] * ac.squaredNorm ()) / det,
+			     (ab[0] * ac.squaredNorm ()
+			      - ac[0] * ab.squaredNorm ()) / det);
+	    center = a + offset;
+	    radius = offset.norm ();
+	    return;
+	  }
+
+	// Collinear points: use the furthest pair.
+	const point2_t* p0 = &a;
+	const point2_t* p1 = &b;
+	if ((c - a).squaredNorm () > (*p1 - *p0).squaredNorm ())
+	  p1 = &c;
+	if ((c - b).squaredNorm () > (*p1 - *p0).squaredNorm ())
+	  {
+	    p0 = &b;
+	    p1 = &c;
+	  }
+	center = 0.5 * (*p0 + *p1);
+	radius = 0.5 * (*p1 - *p0).norm ();
+      }
+
+      /// \brief Minimum enclosing circle of a set of 2D points.
+      ///
+      /// Welzl's algorithm in its iterative form. Its expected running
+      /// time is linear if the points are in random order.
+      void minimumEnclosingCircle (const std::vector<point2_t>& points,
+				   value_type tolerance,
+				   point2_t& center, value_type& radius)
+      {
+	center = points[0];
+	radius = 0.;
+
+	for (size_t i = 1; i < points.size (); ++i)
+	  {
+	    if ((points[i] - center).norm () <= radius + tolerance)
+	      continue;
+
+	    center = points[i];
+	    radius = 0.;
+	    for (size_t j = 0; j < i; ++j)
+	      {
+		if ((points[j] - center).norm () <= radius + tolerance)
+		  continue;
+
+		center = 0.5 * (points[i] + points[j]);
+		radius = 0.5 * (points[i] - points[j]).norm ();
+		for (size_t k = 0; k < j; ++k)
+		  {
+		    if ((points[k] - center).norm () <= radius + tolerance)
+		      continue;
+
+		    circleFromThreePoints (points[i], points[j], points[k],
+					   center, radius);
+		  }
+	      }
+	  }
+      }
+
+      /// \brief Evaluation of the best capsule along axis directions.
+      ///
+      /// Points are shuffled once, and buffers are reused by every
+      /// evaluation.
+      class DirectionEvaluator
+      {
+      public:
+	explicit DirectionEvaluator (const std::vector<point_t>& points)
+	  : points_ (points),
+	    projections_ (points.size ()),
+	    heights_ (points.size ()),
+	    squaredDistances_ (points.size ()),
+	    tolerance_ (0.)
+	{
+	  // Deterministic shuffle, for the expected running time of the
+	  // minimum enclosing circle.
+	  unsigned long state = 12345;
+	  for (size_t i = points_.size (); i > 1; --i)
+	    {
+	      state = state * 1103515245UL + 12345UL;
+	      size_t j = static_cast<size_t> ((state >> 16) % i);
+	      std::swap (points_[i - 1], points_[j]);
+	    }
+
+	  value_type extent = 0.;
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    extent = std::max (extent, points_[i].cwiseAbs ().maxCoeff ());
+	  tolerance_ = 1e-12 * std::max (extent, 1.);
+	}
+
+	/// \brief Compute the best capsule along a unit direction.
+	value_type operator() (const vector3_t& direction,
+			       argument_ref param)
+	{
+	  // Project the points on the plane orthogonal to the axis.
+	  vector3_t u = direction.unitOrthogonal ();
+	  vector3_t v = direction.cross (u);
+
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    {
+	      projections_[i] = point2_t (u.dot (points_[i]),
+					  v.dot (points_[i]));
+	      heights_[i] = direction.dot (points_[i]);
+	    }
+
+	  point2_t center;
+	  value_type minRadius = 0.;
+	  minimumEnclosingCircle (projections_, tolerance_, center, minRadius);
+
+	  // Use the actual distances to the axis, so that every point
+	  // is guaranteed to be inside the capsule.
+	  value_type minHeight = heights_[0];
+	  value_type maxHeight = heights_[0];
+	  minRadius = 0.;
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    {
+	      squaredDistances_[i] = (projections_[i] - center).squaredNorm ();
+	      minRadius = std::max (minRadius, std::sqrt (squaredDistances_[i]));
+	      minHeight = std::min (minHeight, heights_[i]);
+	      maxHeight = std::max (maxHeight, heights_[i]);
+	    }
+
+	  // Above this radius, the capsule is a sphere.
+	  value_type midHeight = 0.5 * (minHeight + maxHeight);
+	  value_type maxRadius = minRadius;
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    {
+	      value_type h = heights_[i] - midHeight;
+	      maxRadius = std::max (maxRadius,
+				    std::sqrt (squaredDistances_[i] + h * h));
+	    }
+
+	  // Golden section search of the radius.
+	  const value_type ratio = 0.5 * (std::sqrt (5.) - 1.);
+	  value_type lower = minRadius;
+	  value_type upper = maxRadius;
+	  value_type r1 = upper - ratio * (upper - lower);
+	  value_type r2 = lower + ratio * (upper - lower);
+	  value_type v1 = volume (r1);
+	  value_type v2 = volume (r2);
+	  for (int k = 0; k < nbRadiusIterations; ++k)
+	    {
+	      if (v1 < v2)
+		{
+		  upper = r2;
+		  r2 = r1;
+		  v2 = v1;
+		  r1 = upper - ratio * (upper - lower);
+		  v1 = volume (r1);
+		}
+	      else
+		{
+		  lower = r1;
+		  r1 = r2;
+		  v1 = v2;
+		  r2 = lower + ratio * (upper - lower);
+		  v2 = volume (r2);
+		}
+	    }
+
+	  // Keep the best evaluated radius, including the bounds.
+	  value_type radius = v1 < v2 ? r1 : r2;
+	  value_type bestVolume = std::min (v1, v2);
+	  value_type boundVolume = volume (minRadius);
+	  if (boundVolume < bestVolume)
+	    {
+	      bestVolume = boundVolume;
+	      radius = minRadius;
+	    }
+	  boundVolume = volume (maxRadius);
+	  if (boundVolume < bestVolume)
+	    {
+	      bestVolume = boundVolume;
+	      radius = maxRadius;
+	    }
+
+	  value_type start = 0.;
+	  value_type end = 0.;
+	  bestVolume = volume (radius, &start, &end);
+
+	  point_t axisPoint = center[0] * u + center[1] * v;
+	  point_t endPoint1 = axisPoint + start * direction;
+	  point_t endPoint2 = axisPoint + end * direction;
+	  convertCapsuleToSolverParam (param, endPoint1, endPoint2, radius);
+
+	  return bestVolume;
+	}
+
+      private:
+	/// \brief Volume of the capsule of given radius, and positions
+	/// of its end points along the axis.
+	value_type volume (value_type radius,
+			   value_type* start = 0, value_type* end = 0) const
+	{
+	  // Each point constrains the first end point to be below
+	  // t + s, and the second one to be above t - s, where s is the
+	  // half-length of the chord of the cap sphere at the point.
+	  value_type t0 = std::numeric_limits<value_type>::max ();
+	  value_type t1 = -std::numeric_limits<value_type>::max ();
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    {
+	      value_type s = std::sqrt (std::max
+					(0., radius * radius
+					 - squaredDistances_[i]));
+	      t0 = std::min (t0, heights_[i] + s);
+	      t1 = std::max (t1, heights_[i] - s);
+	    }
+
+	  value_type length = t1 - t0;
+	  if (length < 0.)
+	    {
+	      // Spherical capsule.
+	      t0 = t1 = 0.5 * (t0 + t1);
+	      length = 0.;
+	    }
+
+	  if (start) *start = t0;
+	  if (end) *end = t1;
+	  return capsuleVolume (radius, length);
+	}
+
+	std::vector<point_t> points_;
+	std::vector<point2_t> projections_;
+	std::vector<value_type> heights_;
+	std::vector<value_type> squaredDistances_;
+	value_type tolerance_;
+      };
+
+      /// \brief Refine a direction with a pattern search on the unit
+      /// sphere.
+      value_type refineDirection (DirectionEvaluator& evaluator,
+				  vector3_t& direction,
+				  value_type volume,
+				  value_type step,
+				  value_type tolerance)
+      {
+	argument_t param (7);
+
+	while (step > tolerance)
+	  {
+	    vector3_t e1 = direction.unitOrthogonal ();
+	    vector3_t e2 = direction.cross (e1);
+	    vector3_t moves[4] = {e1, -e1, e2, -e2};
+
+	    vector3_t bestDirection = direction;
+	    value_type bestVolume = volume;
+	    for (int k = 0; k < 4; ++k)
+	      {
+		vector3_t d = (std::cos (step) * direction
+			       + std::sin (step) * moves[k]).normalized ();
+		value_type v = evaluator (d, param);
+		if (v < bestVolume)
+		  {
+		    bestVolume = v;
+		    bestDirection = d;
+		  }
+	      }
+
+	    if (bestVolume < volume)
+	      {
+		direction = bestDirection;
+		volume = bestVolume;
+	      }
+	    else
+	      step *= 0.5;
+	  }
+
+	return volume;
+      }
+    } // end of anonymous namespace.
+
+
+    value_type bestCapsuleAlongDirection (const std::vector<point_t>& points,
+					  const vector3_t& direction,
+					  argument_ref param)
+    {
+      assert (points.size () > 0 && "Empty point vector.");
+
+      DirectionEvaluator evaluator (points);
+      return evaluator (direction.normalized (), param);
+    }
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    DirectFitter::
+    DirectFitter (const polyhedrons_t& polyhedrons)
+      : polyhedrons_ (polyhedrons),
+        nbDirections_ (256),
+        nbRefinedDirections_ (3),
+        angularTolerance_ (1e-6),
+        solutionVolume_ (0.),
+        solutionParam_ (argument_t::Zero (7))
+    {
+    }
+
+    DirectFitter::
+    ~DirectFitter ()
+    {
+    }
+
+    const polyhedrons_t DirectFitter::
+    polyhedrons () const
+    {
+      return polyhedrons_;
+    }
+
+    void DirectFitter::
+    polyhedrons (const polyhedrons_t& polyhedrons)
+    {
+      assert (polyhedrons.size () != 0 && "Empty polyhedron vector.");
+      polyhedrons_ = polyhedrons;
+    }
+
+    size_t& DirectFitter::nbDirections ()
+    {
+      return nbDirections_;
+    }
+
+    size_t DirectFitter::nbDirections () const
+    {
+      return nbDirections_;
+    }
+
+    size_t& DirectFitter::nbRefinedDirections ()
+    {
+      return nbRefinedDirections_;
+    }
+
+    size_t DirectFitter::nbRefinedDirections () const
+    {
+      return nbRefinedDirections_;
+    }
+
+    value_type& DirectFitter::angularTolerance ()
+    {
+      return angularTolerance_;
+    }
+
+    value_type DirectFitter::angularTolerance () const
+    {
+      return angularTolerance_;
+    }
+
+    value_type DirectFitter::
+    solutionVolume () const
+    {
+      return solutionVolume_;
+    }
+
+    const argument_t& DirectFitter::
+    solutionParam () const
+    {
+      return solutionParam_;
+    }
+
+    void DirectFitter::
+    computeBestFitCapsule ()
+    {
+      assert (polyhedrons_.size () != 0 && "Empty polyhedron vector.");
+
+      // Only the convex hull matters.
+      polyhedron_t points;
+      convertPolyhedronVectorToPolyhedron (points, polyhedrons_);
+      assert (points.size () > 0 && "Empty polyhedrons.");
+      polyhedron_t hull = convexHullFromPoints (points);
+
+      DirectionEvaluator evaluator (hull);
+      argument_t param (7);
+
+      // Candidate directions: the principal axes of the points, and
+      // directions evenly spread on the half unit sphere (Fibonacci
+      // lattice). Opposite directions give the same capsule.
+      std::vector<vector3_t> directions;
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>
+	es (covarianceMatrix (hull), Eigen::ComputeEigenvectors);
+      for (int i = 0; i < 3; ++i)
+	directions.push_back (es.eigenvectors ().col (i).normalized ());
+
+      const value_type goldenAngle = M_PI * (3. - std::sqrt (5.));
+      for (size_t i = 0; i < nbDirections_; ++i)
+	{
+	  value_type z = 1. - (static_cast<value_type> (i) + 0.5)
+	    / static_cast<value_type> (nbDirections_);
+	  value_type r = std::sqrt (1. - z * z);
+	  value_type phi = goldenAngle * static_cast<value_type> (i);
+	  directions.push_back (vector3_t (r * std::cos (phi),
+					   r * std::sin (phi), z));
+	}
+
+      std::vector<std::pair<value_type, size_t> > volumes (directions.size ());
+      for (size_t i = 0; i < directions.size (); ++i)
+	volumes[i] = std::make_pair (evaluator (directions[i], param), i);
+
+      size_t nbRefined = std::min (std::max (nbRefinedDirections_,
+					     static_cast<size_t> (1)),
+				   volumes.size ());
+      std::partial_sort (volumes.begin (), volumes.begin () + nbRefined,
+			 volumes.end ());
+
+      // Refine the best directions, starting with a step of the order
+      // of the sampling resolution.
+      value_type step = std::sqrt (2. * M_PI
+				   / static_cast<value_type>
+				   (std::max (nbDirections_,
+					      static_cast<size_t> (1))));
+      vector3_t bestDirection = directions[volumes[0].second];
+      value_type bestVolume = volumes[0].first;
+      for (size_t i = 0; i < nbRefined; ++i)
+	{
+	  vector3_t direction = directions[volumes[i].second];
+	  value_type volume = refineDirection (evaluator, direction,
+					       volumes[i].first, step,
+					       angularTolerance_);
+	  if (volume < bestVolume)
+	    {
+	      bestVolume = volume;
+	      bestDirection = direction;
+	    }
+	}
+
+      solutionVolume_ = evaluator (bestDirection, solutionParam_);
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DIRECT_FITTER_CC_
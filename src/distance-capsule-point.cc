@@ -27,8 +27,6 @@
 
 # include <roboptim/capsule/distance-capsule-point.hh>
 
-# include <roboptim/core/decorator/finite-difference-gradient.hh>
-
 # include "roboptim/capsule/util.hh"
 
 namespace roboptim
@@ -40,7 +38,7 @@ namespace roboptim
     DistanceCapsulePoint::
     DistanceCapsulePoint (const point_t& point,
 			  std::string name)
-      : roboptim::DifferentiableFunction (7, 1, name),
+      : roboptim::TwiceDifferentiableFunction (7, 1, name),
 	point_ (point)
     {
     }
@@ -87,59 +85,63 @@ namespace roboptim
 
       gradient.setZero ();
 
-      // TODO: fix gradient computation
-      roboptim::GenericFiniteDifferenceGradient<roboptim::EigenMatrixDense>
-	fdgDistanceFunction (*this, 1e-6);
-      fdgDistanceFunction.gradient (gradient, argument);
-      return;
-
       // Define capsule axis from argument.
       point_t endPoint1 (argument[0], argument[1], argument[2]);
       point_t endPoint2 (argument[3], argument[4], argument[5]);
 
-      // Compute projection of point on segment.
-      point_t segmentClosest = projectionOnSegment (point_,
-                                                    endPoint1,
-                                                    endPoint2);
+      // Compute closest point parameter, i.e. the closest point on the
+      // segment is (1 - lambda) * endPoint1 + lambda * endPoint2.
+      value_type lambda = projectionParameterOnSegment (point_,
+							endPoint1,
+							endPoint2);
+      point_t segmentClosest = endPoint1 + lambda * (endPoint2 - endPoint1);
 
-      // Compute unit axis between closest points.
+      // Compute unit axis between closest points. If the point lies on
+      // the segment, the distance is not differentiable and we return
+      // the zero subgradient for the segment part.
       vector3_t unit = segmentClosest - point_;
-      unit.normalize ();
-
-      // Compute closest point parameter.
-      point_t segmentClosestFromEndP1 = segmentClosest - endPoint1;
-      vector3_t endP2FromEndP1 = endPoint2 - endPoint1;
-      value_type lambda;
-      if (endP2FromEndP1.norm () > 0)
-	lambda = segmentClosestFromEndP1.norm () / endP2FromEndP1.norm ();
-      else
-	lambda = 0.;
-
-      // Compute closest point jacobian wrt parameters.
-      matrix_t jacobian (3, 7);
-      jacobian.setZero ();
-      jacobian(0,0) = 1 - lambda;
-      jacobian(1,1) = 1 - lambda;
-      jacobian(2,2) = 1 - lambda;
-      jacobian(0,3) = lambda;
-      jacobian(1,4) = lambda;
-      jacobian(2,5) = lambda;
-
-      // Compute capsule-point distance gradient.
-      // TODO: double-check this
-      vector_t segmentDistanceGradient = unit.transpose () * jacobian;
+      value_type distance = unit.norm ();
 
-      // Compute radius gradient.
-      vector_t radiusGradient (7);
-      radiusGradient.setZero ();
-      radiusGradient[6] = 1.;
+      if (distance > 0.)
+	{
+	  unit /= distance;
 
-      // Return capsule distance gradient.
-      gradient = segmentDistanceGradient - radiusGradient;
+	  // Since lambda minimizes the distance, its variation does not
+	  // contribute to the gradient (in the interior of the segment)
+	  // or is zero (when the projection is clamped to an end point).
+	  gradient.segment<3> (0) = (1. - lambda) * unit;
+	  gradient.segment<3> (3) = lambda * unit;
+	}
+
+      // Compute radius gradient.
+      gradient[6] = -1.;
 
       return;
     }
 
+
+    void DistanceCapsulePoint::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type /*functionId*/) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      hessian.setZero ();
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      // The radius appears linearly: only the end points block is
+      // non-zero.
+      vector6_t distanceGradient;
+      matrix6_t distanceHessian;
+      distancePointToSegmentDerivatives (point_, endPoint1, endPoint2,
+					 distanceGradient, distanceHessian);
+      hessian.block<6,6> (0,0) = distanceHessian;
+    }
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
@@ -0,0 +1,297 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/distance-capsule-points.cc
+ *
+ * \brief Implementation of DistanceCapsulePoints.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
+# define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
+
+# include <roboptim/capsule/distance-capsule-points.hh>
+
+# include "roboptim/capsule/util.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Count the vertices of a polyhedron vector.
+      size_type countPoints (const polyhedrons_t& polyhedrons)
+      {
+	size_type nbPoints = 0;
+	for (size_t i = 0; i < polyhedrons.size (); ++i)
+	  nbPoints += static_cast<size_type> (polyhedrons[i].size ());
+	return nbPoints;
+      }
+
+      /// \brief Prepare a dense jacobian for filling.
+      void initJacobian (Eigen::Ref<GenericFunctionTraits
+			 <EigenMatrixDense>::matrix_t> jacobian)
+      {
+	jacobian.setZero ();
+      }
+
+      /// \brief Zero a sparse matrix expected to hold nonZeros
+      /// entries.
+      ///
+      /// The structure of a matrix filled by a previous evaluation is
+      /// kept, so that it is refilled in place without allocation.
+      ///
+      /// \return whether the structure was kept.
+      bool zeroSparse (GenericFunctionTraits
+		       <EigenMatrixSparse>::matrix_t& matrix,
+		       size_type nonZeros)
+      {
+	if (matrix.isCompressed () && matrix.nonZeros () == nonZeros)
+	  {
+	    Eigen::Map<vector_t> (matrix.valuePtr (), nonZeros).setZero ();
+	    return true;
+	  }
+	matrix.setZero ();
+	return false;
+      }
+
+      /// \brief Prepare a sparse jacobian for filling: each row has
+      /// exactly 7 entries, i.e. each column has one entry per point.
+      void initJacobian (GenericFunctionTraits
+			 <EigenMatrixSparse>::matrix_t& jacobian)
+      {
+	typedef GenericFunctionTraits<EigenMatrixSparse>::matrix_t matrix_t;
+
+	if (zeroSparse (jacobian, 7 * jacobian.rows ()))
+	  return;
+
+	// The inner vectors are rows or columns, depending on the
+	// storage order chosen by roboptim-core.
+	const int innerSize = matrix_t::IsRowMajor
+	  ? 7 : static_cast<int> (jacobian.rows ());
+	jacobian.reserve (Eigen::VectorXi::Constant (jacobian.outerSize (),
+						     innerSize));
+      }
+
+      void finalizeJacobian (Eigen::Ref<GenericFunctionTraits
+			     <EigenMatrixDense>::matrix_t>)
+      {
+      }
+
+      void finalizeJacobian (GenericFunctionTraits
+			     <EigenMatrixSparse>::matrix_t& jacobian)
+      {
+	jacobian.makeCompressed ();
+      }
+
+      /// \brief Prepare a dense hessian for filling.
+      void initHessian (Eigen::Ref<GenericFunctionTraits
+			<EigenMatrixDense>::matrix_t> hessian)
+      {
+	hessian.setZero ();
+      }
+
+      /// \brief Prepare a sparse hessian for filling: its 6x6 end
+      /// points block is written.
+      void initHessian (GenericFunctionTraits
+			<EigenMatrixSparse>::matrix_t& hessian)
+      {
+	zeroSparse (hessian, 36);
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericDistanceCapsulePoints<T>::
+    GenericDistanceCapsulePoints (const_points_ref points,
+				  std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T>
+	(7, points.cols (), name),
+	points_ (points)
+    {
+    }
+
+    template <typename T>
+    GenericDistanceCapsulePoints<T>::
+    GenericDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+				  std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T>
+	(7, countPoints (polyhedrons), name),
+	points_ ()
+    {
+      // Gather the vertices of all polyhedrons in a 3xN matrix.
+      convertPolyhedronVectorToPoints (points_, polyhedrons);
+    }
+
+    template <typename T>
+    GenericDistanceCapsulePoints<T>::
+    ~GenericDistanceCapsulePoints ()
+    {
+    }
+
+    template <typename T>
+    const points_t& GenericDistanceCapsulePoints<T>::
+    points () const
+    {
+      return points_;
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericDistanceCapsulePoints<T>::
+    impl_compute (result_ref result,
+		  const_argument_ref argument) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      // Return difference between distance and capsule radius. The
+      // distances to the shared segment are computed in batch.
+      distancesPointsToSegment (points_, endPoint1, endPoint2, result);
+      result.array () -= argument[6];
+    }
+
+    template <typename T>
+    void GenericDistanceCapsulePoints<T>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+      assert (functionId < points_.cols () && "Invalid function id.");
+
+      gradient.setZero ();
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+      point_t point = points_.col (functionId);
+
+      value_type lambda = projectionParameterOnSegment (point,
+							endPoint1,
+							endPoint2);
+
+      vector3_t unit = endPoint1 + lambda * (endPoint2 - endPoint1) - point;
+      value_type distance = unit.norm ();
+
+      if (distance > 0.)
+	unit /= distance;
+
+      // Use coeffRef so that the same code fills dense and sparse
+      // gradients.
+      for (size_type c = 0; c < 3; ++c)
+	{
+	  gradient.coeffRef (c) = (1. - lambda) * unit[c];
+	  gradient.coeffRef (c + 3) = lambda * unit[c];
+	}
+      gradient.coeffRef (6) = -1.;
+    }
+
+    template <typename T>
+    void GenericDistanceCapsulePoints<T>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      initJacobian (jacobian);
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      // The segment data is shared by all points. For a degenerate
+      // segment, both end points share the gradient evenly.
+      vector3_t axis = endPoint2 - endPoint1;
+      value_type axisSquaredNorm = axis.squaredNorm ();
+      bool isDegenerate = axisSquaredNorm < 1e-12;
+
+      for (size_type i = 0; i < points_.cols (); ++i)
+	{
+	  vector3_t fromEndPoint1 = points_.col (i) - endPoint1;
+
+	  // Compute closest point parameter.
+	  value_type lambda = 0.5;
+	  if (!isDegenerate)
+	    {
+	      lambda = fromEndPoint1.dot (axis) / axisSquaredNorm;
+	      lambda = std::min (std::max (lambda, 0.), 1.);
+	    }
+
+	  // Compute unit axis from the point to its closest point on
+	  // the segment (see DistanceCapsulePoint::impl_gradient).
+	  vector3_t unit = lambda * axis - fromEndPoint1;
+	  value_type distance = unit.norm ();
+
+	  if (distance > 0.)
+	    unit /= distance;
+
+	  for (size_type c = 0; c < 3; ++c)
+	    jacobian.coeffRef (i, c) = (1. - lambda) * unit[c];
+	  for (size_type c = 0; c < 3; ++c)
+	    jacobian.coeffRef (i, c + 3) = lambda * unit[c];
+	  jacobian.coeffRef (i, 6) = -1.;
+	}
+
+      finalizeJacobian (jacobian);
+    }
+
+    template <typename T>
+    void GenericDistanceCapsulePoints<T>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+      assert (functionId < points_.cols () && "Invalid function id.");
+
+      initHessian (hessian);
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      // The radius appears linearly: only the end points block is
+      // non-zero.
+      vector6_t distanceGradient;
+      matrix6_t distanceHessian;
+      distancePointToSegmentDerivatives (points_.col (functionId),
+					 endPoint1, endPoint2,
+					 distanceGradient, distanceHessian);
+
+      // Use coeffRef so that the same code fills dense and sparse
+      // hessians.
+      for (size_type i = 0; i < 6; ++i)
+	for (size_type j = 0; j < 6; ++j)
+	  hessian.coeffRef (i, j) = distanceHessian (i, j);
+    }
+
+    // Explicit instantiations.
+    template class GenericDistanceCapsulePoints<roboptim::EigenMatrixDense>;
+    template class GenericDistanceCapsulePoints<roboptim::EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
@@ -43,7 +43,7 @@
 
    The package relies on:
    <ul>
-   <li>geometric types and operations (<a href="http://eigen.tuxfamily.org">Eigen</a>, <a href="http://www.qhull.org/">Qhull</a>),</li>
+   <li>geometric types and operations (<a href="http://eigen.tuxfamily.org">Eigen</a>),</li>
    <li>and numerical optimization (<a href="http://roboptim.net/">RobOptim and its IPOPT plugin</a>).</li>
    </ul>
 
@@ -0,0 +1,317 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/fit-cache.cc
+ *
+ * \brief Implementation of FitCache.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_FIT_CACHE_CC_
+# define ROBOPTIM_CAPSULE_FIT_CACHE_CC_
+
+# include <cstring>
+# include <fstream>
+# include <sstream>
+# include <stdexcept>
+
+# include <boost/filesystem/operations.hpp>
+# include <boost/foreach.hpp>
+# include <boost/interprocess/file_mapping.hpp>
+# include <boost/interprocess/mapped_region.hpp>
+# include <boost/thread/locks.hpp>
+
+# include <roboptim/capsule/fit-cache.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief File header: magic string and format version.
+      const char magic[8] = {'R', 'C', 'A', 'P', 'F', 'I', 'T', '\0'};
+      const boost::uint64_t version = 1;
+      const size_t headerSize = sizeof (magic) + sizeof (version);
+
+      /// \brief Record: key, initial parameters and volume, solution
+      /// parameters and volume.
+      const size_t nbValues = 16;
+      const size_t recordSize = sizeof (FitCache::key_t)
+	+ nbValues * sizeof (double);
+
+      /// \brief 64-bit FNV-1a hash.
+      class Fnv1a
+      {
+      public:
+	Fnv1a ()
+	  : hash_ (14695981039346656037ULL)
+	{}
+
+	void add (const void* data, size_t size)
+	{
+	  const unsigned char* bytes = static_cast<const unsigned char*> (data);
+	  for (size_t i = 0; i < size; ++i)
+	    {
+	      hash_ ^= bytes[i];
+	      hash_ *= 1099511628211ULL;
+	    }
+	}
+
+	void add (const std::string& s)
+	{
+	  boost::uint64_t size = s.size ();
+	  add (&size, sizeof (size));
+	  add (s.data (), s.size ());
+	}
+
+	boost::uint64_t hash () const
+	{
+	  return hash_;
+	}
+
+      private:
+	boost::uint64_t hash_;
+      };
+
+      /// \brief Whether a solver parameter only affects the output of
+      /// the solver (printing, log file, derivative test), and not the
+      /// solution.
+      bool isOutputParameter (const std::string& name)
+      {
+	return name.compare (0, 12, "ipopt.print_") == 0
+	  || name.compare (0, 21, "ipopt.derivative_test") == 0
+	  || name == "ipopt.file_print_level"
+	  || name == "ipopt.output_file"
+	  || name == "ipopt.sb";
+      }
+
+      /// \brief Size of a file, 0 if it cannot be opened.
+      size_t fileSize (const std::string& path)
+      {
+	std::ifstream file (path.c_str (), std::ios::binary | std::ios::ate);
+	if (!file)
+	  return 0;
+	return static_cast<size_t> (file.tellg ());
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    FitCache::
+    FitCache (const std::string& path)
+      : path_ (path),
+	region_ (),
+	mappedSize_ (0)
+    {
+      size_t size = fileSize (path_);
+
+      if (size == 0)
+	{
+	  // Create the file and write its header.
+	  std::ofstream file (path_.c_str (),
+			      std::ios::binary | std::ios::trunc);
+	  file.write (magic, sizeof (magic));
+	  file.write (reinterpret_cast<const char*> (&version),
+		      sizeof (version));
+	  if (!file)
+	    throw std::runtime_error ("cannot create cache file " + path_);
+	  return;
+	}
+
+      // Check the header of an existing file.
+      std::ifstream file (path_.c_str (), std::ios::binary);
+      char fileMagic[sizeof (magic)];
+      boost::uint64_t fileVersion = 0;
+      file.read (fileMagic, sizeof (fileMagic));
+      file.read (reinterpret_cast<char*> (&fileVersion), sizeof (fileVersion));
+      if (!file
+	  || std::memcmp (fileMagic, magic, sizeof (magic)) != 0
+	  || fileVersion != version)
+	throw std::runtime_error (path_ + " is not a capsule cache file");
+    }
+
+    FitCache::
+    ~FitCache ()
+    {
+    }
+
+    const std::string& FitCache::
+    path () const
+    {
+      return path_;
+    }
+
+    FitCache::key_t FitCache::
+    key (const polyhedrons_t& polyhedrons,
+	 const std::string& solver,
+	 const FitterOptions& options)
+    {
+      Fnv1a hash;
+
+      boost::uint64_t nbPolyhedrons = polyhedrons.size ();
+      hash.add (&nbPolyhedrons, sizeof (nbPolyhedrons));
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	{
+	  boost::uint64_t nbPoints = polyhedron.size ();
+	  hash.add (&nbPoints, sizeof (nbPoints));
+	  BOOST_FOREACH (const point_t& point, polyhedron)
+	    hash.add (point.data (), 3 * sizeof (value_type));
+	}
+
+      hash.add (solver);
+
+      // Solver parameters are ordered by name. Output parameters are
+      // left out.
+      for (FitterOptions::parameters_t::const_iterator
+	     it = options.parameters.begin ();
+	   it != options.parameters.end (); ++it)
+	{
+	  if (isOutputParameter (it->first))
+	    continue;
+
+	  std::ostringstream value;
+	  value.precision (17);
+	  value << it->second;
+	  hash.add (it->first);
+	  hash.add (value.str ());
+	}
+
+      unsigned char flags[2] = {options.useSparseMatrices,
+				options.useActiveSet};
+      hash.add (flags, sizeof (flags));
+
+      // Pruning only enters the key when enabled, so that the keys of
+      // earlier caches remain valid.
+      if (options.usePruning)
+	{
+	  hash.add (std::string ("pruning"));
+	  hash.add (&options.pruningDepth, sizeof (options.pruningDepth));
+	}
+
+      return hash.hash ();
+    }
+
+    bool FitCache::
+    find (key_t key, entry_t& entry) const
+    {
+      boost::lock_guard<boost::mutex> lock (mutex_);
+      remap ();
+
+      if (!region_)
+	return false;
+
+      const char* data = static_cast<const char*> (region_->get_address ());
+      size_t nbRecords = (mappedSize_ - headerSize) / recordSize;
+
+      // The latest record of a key wins.
+      for (size_t i = nbRecords; i > 0; --i)
+	{
+	  const char* record = data + headerSize + (i - 1) * recordSize;
+
+	  key_t recordKey;
+	  std::memcpy (&recordKey, record, sizeof (recordKey));
+	  if (recordKey != key)
+	    continue;
+
+	  double values[nbValues];
+	  std::memcpy (values, record + sizeof (key_t), sizeof (values));
+
+	  entry.initParam = Eigen::Map<const argument_t> (values, 7);
+	  entry.initVolume = values[7];
+	  entry.solutionParam = Eigen::Map<const argument_t> (values + 8, 7);
+	  entry.solutionVolume = values[15];
+	  return true;
+	}
+
+      return false;
+    }
+
+    void FitCache::
+    insert (key_t key, const entry_t& entry)
+    {
+      assert (entry.initParam.size () == 7
+	      && "Incorrect initParam size, expected 7.");
+      assert (entry.solutionParam.size () == 7
+	      && "Incorrect solutionParam size, expected 7.");
+
+      char record[recordSize];
+      double values[nbValues];
+      Eigen::Map<argument_t> (values, 7) = entry.initParam;
+      values[7] = entry.initVolume;
+      Eigen::Map<argument_t> (values + 8, 7) = entry.solutionParam;
+      values[15] = entry.solutionVolume;
+
+      std::memcpy (record, &key, sizeof (key));
+      std::memcpy (record + sizeof (key), values, sizeof (values));
+
+      boost::lock_guard<boost::mutex> lock (mutex_);
+
+      // Records are appended with a single write. A partial record left
+      // by a failed write is dropped first, so that the new record
+      // starts at a record boundary.
+      size_t size = fileSize (path_);
+      if (size > headerSize && (size - headerSize) % recordSize != 0)
+	{
+	  region_.reset ();
+	  mappedSize_ = 0;
+	  size_t nbRecords = (size - headerSize) / recordSize;
+	  boost::filesystem::resize_file (path_,
+					  headerSize + nbRecords * recordSize);
+	}
+
+      std::ofstream file (path_.c_str (),
+			  std::ios::binary | std::ios::app);
+      file.write (record, recordSize);
+      file.flush ();
+      if (!file)
+	throw std::runtime_error ("cannot write to cache file " + path_);
+    }
+
+    size_t FitCache::
+    size () const
+    {
+      size_t size = fileSize (path_);
+      return size < headerSize ? 0 : (size - headerSize) / recordSize;
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void FitCache::
+    remap () const
+    {
+      size_t size = fileSize (path_);
+      if (size == mappedSize_)
+	return;
+
+      region_.reset ();
+      mappedSize_ = 0;
+
+      // Nothing to map without records.
+      if (size < headerSize + recordSize)
+	return;
+
+      using namespace boost::interprocess;
+      file_mapping mapping (path_.c_str (), read_only);
+      region_.reset (new mapped_region (mapping, read_only, 0, size));
+      mappedSize_ = size;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_FIT_CACHE_CC_
@@ -26,33 +26,220 @@
 # define ROBOPTIM_CAPSULE_FITTER_CC_
 
 # include <math.h>
-# include <sstream>
 
+# include <algorithm>
+# include <stdexcept>
+
+# include <boost/foreach.hpp>
 # include <boost/shared_ptr.hpp>
+# include <boost/scoped_ptr.hpp>
 # include <boost/make_shared.hpp>
 # include <boost/ref.hpp>
+# include <boost/thread/locks.hpp>
+# include <boost/thread/mutex.hpp>
 
-# include <roboptim/core/decorator/finite-difference-gradient.hh>
 # include <roboptim/core/linear-function.hh>
 # include <roboptim/core/optimization-logger.hh>
 
 # include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/fit-cache.hh>
+# include <roboptim/capsule/util.hh>
+
+# include "wall-time.hh"
 
 namespace roboptim
 {
   namespace capsule
   {
+    namespace
+    {
+      /// \brief Mutex protecting solver plugin loading and unloading,
+      /// which is not thread-safe.
+      boost::mutex pluginMutex;
+
+      /// \brief Mutex protecting the non-reentrant MUMPS linear solver.
+      boost::mutex mumpsMutex;
+
+      /// \brief Distance above which a point is considered outside of
+      /// the capsule by the active-set strategy. It matches the
+      /// constraint violation tolerance given to Ipopt.
+      const value_type activeSetTolerance = 1e-6;
+
+      /// \brief Distance to the capsule surface, relative to the
+      /// radius, below which a point is considered as binding the
+      /// solution.
+      const value_type bindingTolerance = 1e-3;
+
+      /// \brief Lexicographic order on points.
+      bool lexicographicLess (const point_t& a, const point_t& b)
+      {
+	return std::lexicographical_compare (a.data (), a.data () + 3,
+					     b.data (), b.data () + 3);
+      }
+
+      /// \brief Solver iteration callback counting iterations.
+      struct IterationCounter
+      {
+	explicit IterationCounter (size_t& count)
+	  : count_ (&count)
+	{}
+
+	template <typename P, typename S>
+	void operator() (const P&, S&) const
+	{
+	  ++(*count_);
+	}
+
+      private:
+	size_t* count_;
+      };
+
+      /// \brief Scope of an evaluation, notified to the evaluation
+      /// callback of the fitter.
+      struct EvaluationScope
+      {
+	explicit EvaluationScope (const Fitter::evaluationCallback_t& callback)
+	  : callback_ (callback)
+	{
+	  if (callback_)
+	    callback_ (true);
+	}
+
+	~EvaluationScope ()
+	{
+	  if (callback_)
+	    callback_ (false);
+	}
+
+      private:
+	const Fitter::evaluationCallback_t& callback_;
+      };
+
+      /// \brief Function decorator counting the evaluations of a
+      /// function and of its derivatives.
+      template <typename T>
+      class CountingFunction : public GenericTwiceDifferentiableFunction<T>
+      {
+      public:
+	ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+	(GenericTwiceDifferentiableFunction<T>);
+
+	typedef boost::shared_ptr<GenericTwiceDifferentiableFunction<T> >
+	functionPtr_t;
+
+	CountingFunction (const functionPtr_t& function,
+			  size_t& nbEvaluations,
+			  size_t& nbGradients,
+			  size_t& nbHessians,
+			  const Fitter::evaluationCallback_t& callback)
+	  : GenericTwiceDifferentiableFunction<T> (function->inputSize (),
+						   function->outputSize (),
+						   function->getName ()),
+	    function_ (function),
+	    nbEvaluations_ (&nbEvaluations),
+	    nbGradients_ (&nbGradients),
+	    nbHessians_ (&nbHessians),
+	    callback_ (&callback)
+	{}
+
+      protected:
+	void impl_compute (result_ref result,
+			   const_argument_ref argument) const
+	{
+	  ++(*nbEvaluations_);
+	  EvaluationScope scope (*callback_);
+	  (*function_) (result, argument);
+	}
+
+	void impl_gradient (gradient_ref gradient,
+			    const_argument_ref argument,
+			    size_type functionId = 0) const
+	{
+	  ++(*nbGradients_);
+	  EvaluationScope scope (*callback_);
+	  function_->gradient (gradient, argument, functionId);
+	}
+
+	void impl_jacobian (jacobian_ref jacobian,
+			    const_argument_ref argument) const
+	{
+	  ++(*nbGradients_);
+	  EvaluationScope scope (*callback_);
+	  function_->jacobian (jacobian, argument);
+	}
+
+	void impl_hessian (hessian_ref hessian,
+			   const_argument_ref argument,
+			   size_type functionId = 0) const
+	{
+	  ++(*nbHessians_);
+	  EvaluationScope scope (*callback_);
+	  function_->hessian (hessian, argument, functionId);
+	}
+
+      private:
+	functionPtr_t function_;
+	size_t* nbEvaluations_;
+	size_t* nbGradients_;
+	size_t* nbHessians_;
+	const Fitter::evaluationCallback_t* callback_;
+      };
+    } // end of anonymous namespace.
+
     // -------------------PUBLIC FUNCTIONS-----------------------
 
+    FitterOptions FitterOptions::
+    quiet ()
+    {
+      FitterOptions options;
+      options.parameters["ipopt.print_level"] = 0;
+      options.parameters["ipopt.print_user_options"] = std::string ("no");
+      options.parameters["ipopt.sb"] = std::string ("yes");
+      return options;
+    }
+
+    FitterOptions FitterOptions::
+    debug ()
+    {
+      FitterOptions options;
+      options.parameters["ipopt.print_level"] = 5;
+      options.parameters["ipopt.file_print_level"] = 5;
+      options.parameters["ipopt.print_user_options"] = std::string ("yes");
+      options.parameters["ipopt.derivative_test"]
+	= std::string ("first-order");
+      options.parameters["ipopt.derivative_test_perturbation"] = 10e-8;
+      options.solverLogFile = std::string ("fitter-ipopt.log");
+      options.verbose = true;
+      return options;
+    }
+
     Fitter::
     Fitter (const polyhedrons_t& polyhedrons,
             std::string solver)
       : polyhedrons_ (polyhedrons),
-        solver_ (solver)
+        initParam_ (argument_t::Zero (7)),
+        solutionParam_ (argument_t::Zero (7)),
+        solver_ (solver),
+        options_ (FitterOptions::quiet ()),
+        activeSetSize_ (0),
+        warmStart_ (false),
+        status_ (GenericSolver::SOLVER_NO_SOLUTION)
+    {
+    }
+
+    Fitter::
+    Fitter (const_points_ref points,
+            std::string solver)
+      : polyhedrons_ (1),
+        initParam_ (argument_t::Zero (7)),
+        solutionParam_ (argument_t::Zero (7)),
+        solver_ (solver),
+        options_ (FitterOptions::quiet ()),
+        activeSetSize_ (0),
+        warmStart_ (false),
+        status_ (GenericSolver::SOLVER_NO_SOLUTION)
     {
-      argument_t param (7);
-      param.setZero ();
-      solutionParam_ = param;
+      convertPointsToPolyhedron (polyhedrons_[0], points);
     }
 
     Fitter::
@@ -109,6 +296,50 @@ namespace roboptim
       return solutionParam_;
     }
 
+    GenericSolver::solutions Fitter::
+    status () const
+    {
+      return status_;
+    }
+
+    const std::string& Fitter::
+    errorMessage () const
+    {
+      return errorMessage_;
+    }
+
+    size_t Fitter::
+    solverIterations () const
+    {
+      return stats_.iterations;
+    }
+
+    const FitStats& Fitter::
+    stats () const
+    {
+      return stats_;
+    }
+
+    Fitter::statsCallback_t& Fitter::statsCallback ()
+    {
+      return statsCallback_;
+    }
+
+    const Fitter::statsCallback_t& Fitter::statsCallback () const
+    {
+      return statsCallback_;
+    }
+
+    Fitter::evaluationCallback_t& Fitter::evaluationCallback ()
+    {
+      return evaluationCallback_;
+    }
+
+    const Fitter::evaluationCallback_t& Fitter::evaluationCallback () const
+    {
+      return evaluationCallback_;
+    }
+
     boost::optional<std::string>& Fitter::logDirectory ()
     {
       return logDir_;
@@ -119,9 +350,141 @@ namespace roboptim
       return logDir_;
     }
 
+    FitterOptions& Fitter::options ()
+    {
+      return options_;
+    }
+
+    const FitterOptions& Fitter::options () const
+    {
+      return options_;
+    }
+
+    boost::shared_ptr<FitCache>& Fitter::cache ()
+    {
+      return cache_;
+    }
+
+    const boost::shared_ptr<FitCache>& Fitter::cache () const
+    {
+      return cache_;
+    }
+
+    boost::optional<std::string>& Fitter::solverLogFile ()
+    {
+      return options_.solverLogFile;
+    }
+
+    const boost::optional<std::string>& Fitter::solverLogFile () const
+    {
+      return options_.solverLogFile;
+    }
+
+    bool& Fitter::useSparseMatrices ()
+    {
+      return options_.useSparseMatrices;
+    }
+
+    bool Fitter::useSparseMatrices () const
+    {
+      return options_.useSparseMatrices;
+    }
+
+    bool& Fitter::useActiveSet ()
+    {
+      return options_.useActiveSet;
+    }
+
+    bool Fitter::useActiveSet () const
+    {
+      return options_.useActiveSet;
+    }
+
+    bool& Fitter::usePruning ()
+    {
+      return options_.usePruning;
+    }
+
+    bool Fitter::usePruning () const
+    {
+      return options_.usePruning;
+    }
+
+    size_t Fitter::activeSetSize () const
+    {
+      return activeSetSize_;
+    }
+
+    void Fitter::
+    computeBestFitCapsule ()
+    {
+      stats_ = FitStats ();
+
+      // Look the fit up in the cache.
+      FitCache::key_t key = 0;
+      if (cache_)
+	{
+	  key = FitCache::key (polyhedrons_, solver_, options_);
+
+	  FitCache::entry_t entry;
+	  if (cache_->find (key, entry))
+	    {
+	      initParam_ = entry.initParam;
+	      initVolume_ = entry.initVolume;
+	      solutionParam_ = entry.solutionParam;
+	      solutionVolume_ = entry.solutionVolume;
+	      status_ = GenericSolver::SOLVER_VALUE;
+	      errorMessage_.clear ();
+	      activeSetSize_ = 0;
+
+	      stats_.cached = true;
+	      stats_.status = status_;
+	      checkSolution (polyhedrons_, solutionParam_);
+
+	      if (statsCallback_)
+		statsCallback_ (stats_);
+	      return;
+	    }
+	}
+
+      // Reduce the number of constraints by only keeping the convex
+      // hull of the polyhedrons.
+      double start = detail::wallTime ();
+      polyhedrons_t convexPolyhedrons;
+      computeConvexPolyhedron (polyhedrons_, convexPolyhedrons);
+      stats_.hullTime = detail::wallTime () - start;
+
+      // Start from the bounding capsule.
+      start = detail::wallTime ();
+      point_t endPoint1;
+      point_t endPoint2;
+      value_type radius = 0.;
+      computeBoundingCapsulePolyhedron (convexPolyhedrons,
+					endPoint1, endPoint2, radius);
+
+      vector7_t initParam;
+      convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+      stats_.initTime = detail::wallTime () - start;
+
+      impl_computeBestFitCapsuleParam (convexPolyhedrons, initParam,
+				       solutionParam_);
+
+      // Only successful fits are cached.
+      if (cache_ && status_ == GenericSolver::SOLVER_VALUE)
+	{
+	  FitCache::entry_t entry;
+	  entry.initParam = initParam_;
+	  entry.initVolume = initVolume_;
+	  entry.solutionParam = solutionParam_;
+	  entry.solutionVolume = solutionVolume_;
+	  cache_->insert (key, entry);
+	}
+    }
+
     void Fitter::
     computeBestFitCapsule (const_argument_ref initParam)
     {
+      stats_ = FitStats ();
       impl_computeBestFitCapsuleParam (polyhedrons_, initParam, solutionParam_);
     }
 
@@ -129,12 +492,14 @@ namespace roboptim
     computeBestFitCapsule (const polyhedrons_t& polyhedrons,
 			   const_argument_ref initParam)
     {
+      stats_ = FitStats ();
       impl_computeBestFitCapsuleParam (polyhedrons, initParam, solutionParam_);
     }
 
     const argument_t& Fitter::
     computeBestFitCapsuleParam (const_argument_ref initParam)
     {
+      stats_ = FitStats ();
       impl_computeBestFitCapsuleParam (polyhedrons_, initParam, solutionParam_);
 
       return solutionParam_;
@@ -144,11 +509,62 @@ namespace roboptim
     computeBestFitCapsuleParam (const polyhedrons_t& polyhedrons,
 				const_argument_ref initParam)
     {
+      stats_ = FitStats ();
       impl_computeBestFitCapsuleParam (polyhedrons, initParam, solutionParam_);
 
       return solutionParam_;
     }
 
+    bool Fitter::
+    refit (const polyhedrons_t& polyhedrons)
+    {
+      assert (polyhedrons.size () != 0 && "Empty polyhedron vector.");
+      polyhedrons_ = polyhedrons;
+
+      if (status_ != GenericSolver::SOLVER_VALUE
+	  && status_ != GenericSolver::SOLVER_VALUE_WARNINGS)
+	{
+	  computeBestFitCapsule ();
+	  return true;
+	}
+
+      stats_ = FitStats ();
+
+      double start = detail::wallTime ();
+      polyhedrons_t convexPolyhedrons;
+      computeConvexPolyhedron (polyhedrons_, convexPolyhedrons);
+      stats_.hullTime = detail::wallTime () - start;
+
+      // Distance from the new points to the current capsule.
+      DistanceCapsulePoints distances (convexPolyhedrons);
+      value_type violation = distances (solutionParam_).maxCoeff ();
+
+      if (violation <= activeSetTolerance
+	  && containsActivePoints (polyhedrons_))
+	{
+	  // The current capsule is still the best one.
+	  stats_.constraintViolation = std::max (0., violation);
+	  stats_.status = status_;
+
+	  if (statsCallback_)
+	    statsCallback_ (stats_);
+	  return false;
+	}
+
+      // Warm start from the current solution, enlarged to contain the
+      // new points.
+      vector7_t initParam = solutionParam_;
+      if (violation > 0.)
+	initParam[6] += violation;
+
+      warmStart_ = true;
+      impl_computeBestFitCapsuleParam (convexPolyhedrons, initParam,
+				       solutionParam_);
+      warmStart_ = false;
+
+      return true;
+    }
+
     // -------------------PROTECTED FUNCTIONS--------------------
 
     void Fitter::
@@ -160,57 +576,302 @@ namespace roboptim
       assert (initParam.size () == 7
 	      && "Incorrect initParam size, expected 7.");
 
-      // Define volume function. It is the cost of the optimization
-      // problem.
-      boost::shared_ptr<Volume> volume (new Volume ());
+      // Volume function used to evaluate the initial and solution
+      // capsules.
+      Volume volume;
+      Eigen::Matrix<value_type, 1, 1> volumeResult;
       initParam_ = initParam;
-      initVolume_ = (*volume) (initParam)[0];
+      volume (volumeResult, initParam);
+      initVolume_ = volumeResult[0];
+      status_ = GenericSolver::SOLVER_NO_SOLUTION;
+      errorMessage_.clear ();
+
+      double start = detail::wallTime ();
+      if (options_.usePruning)
+	solvePruned (polyhedrons, initParam, solutionParam);
+      else
+	solvePoints (polyhedrons, initParam, solutionParam);
+      stats_.solveTime = detail::wallTime () - start;
 
-      // Define optimization problem with volume as cost function.
-      solver_t::problem_t problem (volume);
+      solutionParam_ = solutionParam;
+      volume (volumeResult, solutionParam);
+      solutionVolume_ = volumeResult[0];
 
-      // Define problem starting point.
-      problem.startingPoint () = initParam;
+      stats_.status = status_;
+      checkSolution (polyhedrons, solutionParam);
 
-      // The radius must not be negative.
-      problem.argumentBounds ()[6] = Function::makeLowerInterval (0.);
+      if (statsCallback_)
+	statsCallback_ (stats_);
+    }
 
-      // Cycle through polyhedron points and define distance
-      // functions. They are the constraints of the optimization
-      // problem.
-      BOOST_FOREACH (polyhedron_t polyhedron, polyhedrons)
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void Fitter::
+    checkSolution (const polyhedrons_t& polyhedrons,
+		   const_argument_ref solutionParam)
+    {
+      DistanceCapsulePoints distances (polyhedrons);
+      vector_t d = distances (solutionParam);
+      value_type violation = std::max (0., -solutionParam[6]);
+      if (d.size () > 0)
+	violation = std::max (violation, d.maxCoeff ());
+      stats_.constraintViolation = violation;
+
+      // Keep the points binding the solution, for later refits.
+      activePoints_.clear ();
+      if (status_ == GenericSolver::SOLVER_VALUE
+	  || status_ == GenericSolver::SOLVER_VALUE_WARNINGS)
 	{
-	  for (size_t j = 0; j < polyhedron.size (); ++j)
+	  value_type tolerance = bindingTolerance * solutionParam[6];
+	  size_type k = 0;
+	  BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	    BOOST_FOREACH (const point_t& point, polyhedron)
 	    {
-	      const point_t& point = polyhedron[j];
+	      if (d[k++] >= -tolerance)
+		activePoints_.push_back (point);
+	    }
+	}
+    }
 
-	      std::string s = "distance to point ";
-	      std::stringstream name;
-	      name << s << j;
+    bool Fitter::
+    containsActivePoints (const polyhedrons_t& polyhedrons) const
+    {
+      polyhedron_t points;
+      convertPolyhedronVectorToPolyhedron (points, polyhedrons);
+      std::sort (points.begin (), points.end (), lexicographicLess);
+
+      BOOST_FOREACH (const point_t& point, activePoints_)
+	{
+	  if (!std::binary_search (points.begin (), points.end (), point,
+				   lexicographicLess))
+	    return false;
+	}
+
+      return true;
+    }
+
+    void Fitter::
+    solvePruned (const polyhedrons_t& polyhedrons,
+		 const_argument_ref initParam,
+		 argument_ref solutionParam)
+    {
+      polyhedron_t points;
+      convertPolyhedronVectorToPolyhedron (points, polyhedrons);
+
+      // Distances from all points to the capsule, negative inside.
+      DistanceCapsulePoints distances (polyhedrons_t (1, points));
+      vector_t d = distances (initParam);
+
+      // Keep the points close to the surface of the initial capsule.
+      value_type depth = options_.pruningDepth * initParam[6];
+      polyhedrons_t keptPolyhedrons (1);
+      std::vector<size_t> pruned;
+      for (size_t i = 0; i < points.size (); ++i)
+	{
+	  if (d[static_cast<size_type> (i)] >= -depth)
+	    keptPolyhedrons[0].push_back (points[i]);
+	  else
+	    pruned.push_back (i);
+	}
+
+      // Nothing is pruned if no point is left, e.g. if the initial
+      // capsule is far too large.
+      if (keptPolyhedrons[0].empty ())
+	{
+	  solvePoints (polyhedrons, initParam, solutionParam);
+	  return;
+	}
+
+      vector7_t startParam = initParam;
+      while (true)
+	{
+	  solvePoints (keptPolyhedrons, startParam, solutionParam);
 
-	      // Add distance constraint. Distance must always be negative
-	      // (points remain inside the capsule as it shrinks).
-	      boost::shared_ptr<DistanceCapsulePoint>
-		distance (new DistanceCapsulePoint (point, name.str ()));
-	      Function::interval_t distanceInterval
-		= Function::makeUpperInterval (0.);
+	  // Errors are reported as is, with the initial parameters as
+	  // solution.
+	  if (status_ != GenericSolver::SOLVER_VALUE
+	      && status_ != GenericSolver::SOLVER_VALUE_WARNINGS)
+	    break;
 
-	      problem.addConstraint (distance, distanceInterval, 1.);
+	  // Restore the pruned points left outside of the capsule.
+	  distances (d, solutionParam);
+	  std::vector<size_t> stillPruned;
+	  BOOST_FOREACH (size_t i, pruned)
+	    {
+	      if (d[static_cast<size_type> (i)] > activeSetTolerance)
+		keptPolyhedrons[0].push_back (points[i]);
+	      else
+		stillPruned.push_back (i);
 	    }
+
+	  bool restored = stillPruned.size () < pruned.size ();
+	  pruned.swap (stillPruned);
+	  if (!restored)
+	    break;
+
+	  // Warm start from the current solution.
+	  startParam = solutionParam;
+	}
+
+      stats_.prunedPoints = pruned.size ();
+    }
+
+    void Fitter::
+    solvePoints (const polyhedrons_t& polyhedrons,
+		 const_argument_ref initParam,
+		 argument_ref solutionParam)
+    {
+      if (options_.useActiveSet)
+	solveActiveSet (polyhedrons, initParam, solutionParam);
+      else
+	{
+	  activeSetSize_ = 0;
+	  BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	    activeSetSize_ += polyhedron.size ();
+	  solveProblem (polyhedrons, initParam, solutionParam);
 	}
+    }
+
+    void Fitter::
+    solveActiveSet (const polyhedrons_t& polyhedrons,
+		    const_argument_ref initParam,
+		    argument_ref solutionParam)
+    {
+      polyhedron_t points;
+      convertPolyhedronVectorToPolyhedron (points, polyhedrons);
+
+      // Distances from all points to the capsule, used to find the
+      // points left outside.
+      DistanceCapsulePoints distances (polyhedrons_t (1, points));
+
+      // Start from a few extreme points.
+      std::vector<bool> active (points.size (), false);
+      std::vector<size_t> seed;
+      activeSetSeed (points, seed);
+      BOOST_FOREACH (size_t i, seed)
+	active[i] = true;
+
+      polyhedrons_t activePolyhedrons (1);
+      vector7_t startParam = initParam;
+      vector_t d (distances.outputSize ());
+
+      while (true)
+	{
+	  polyhedron_t& activePoints = activePolyhedrons[0];
+	  activePoints.clear ();
+	  for (size_t i = 0; i < points.size (); ++i)
+	    if (active[i])
+	      activePoints.push_back (points[i]);
+	  activeSetSize_ = activePoints.size ();
+
+	  solveProblem (activePolyhedrons, startParam, solutionParam);
+
+	  // Errors are reported as is, with the initial parameters as
+	  // solution.
+	  if (status_ != GenericSolver::SOLVER_VALUE
+	      && status_ != GenericSolver::SOLVER_VALUE_WARNINGS)
+	    break;
+
+	  // Add the points left outside of the capsule.
+	  distances (d, solutionParam);
+	  size_t nbViolations = 0;
+	  for (size_t i = 0; i < points.size (); ++i)
+	    if (!active[i] && d[static_cast<size_type> (i)] > activeSetTolerance)
+	      {
+		active[i] = true;
+		++nbViolations;
+	      }
+
+	  if (nbViolations == 0)
+	    break;
+
+	  // Warm start from the current solution.
+	  startParam = solutionParam;
+	}
+    }
 
-      // Create solver using Ipopt.
-      SolverFactory<solver_t> factory (solver_, problem);
-      solver_t& solver = factory ();
+    void Fitter::
+    solveProblem (const polyhedrons_t& polyhedrons,
+		  const_argument_ref initParam,
+		  argument_ref solutionParam)
+    {
+      if (options_.useSparseMatrices)
+	solve<EigenMatrixSparse> (polyhedrons, initParam, solutionParam);
+      else
+	solve<EigenMatrixDense> (polyhedrons, initParam, solutionParam);
+    }
+
+    template <typename T>
+    void Fitter::
+    solve (const polyhedrons_t& polyhedrons,
+	   const_argument_ref initParam,
+	   argument_ref solutionParam)
+    {
+      typedef roboptim::Solver<T> genericSolver_t;
+      typedef typename genericSolver_t::problem_t problem_t;
+      typedef GenericFunction<T> function_t;
+
+      // Define volume function. It is the cost of the optimization
+      // problem.
+      // Evaluations are counted by decorators.
+      typedef CountingFunction<T> countingFunction_t;
+      typedef typename countingFunction_t::functionPtr_t functionPtr_t;
+      boost::shared_ptr<countingFunction_t> volume
+	(new countingFunction_t (functionPtr_t (new GenericVolume<T> ()),
+				 stats_.costEvaluations,
+				 stats_.costGradientEvaluations,
+				 stats_.costHessianEvaluations,
+				 evaluationCallback_));
+
+      // Define optimization problem with volume as cost function.
+      problem_t problem (volume);
+
+      // Define problem starting point.
+      problem.startingPoint () = initParam;
+
+      // The radius must not be negative.
+      problem.argumentBounds ()[6] = function_t::makeLowerInterval (0.);
+
+      // Define distance functions to all polyhedron points. They are
+      // the constraints of the optimization problem, gathered in a
+      // single vector-valued function. Distances must always be
+      // negative (points remain inside the capsule as it shrinks).
+      boost::shared_ptr<countingFunction_t> distances
+	(new countingFunction_t
+	 (functionPtr_t (new GenericDistanceCapsulePoints<T> (polyhedrons)),
+	  stats_.constraintEvaluations,
+	  stats_.constraintJacobianEvaluations,
+	  stats_.constraintHessianEvaluations,
+	  evaluationCallback_));
+      typename function_t::intervals_t distanceIntervals
+	(static_cast<size_t> (distances->outputSize ()),
+	 function_t::makeUpperInterval (0.));
+      typename problem_t::scaling_t distanceScaling
+	(static_cast<size_t> (distances->outputSize ()), 1.);
+
+      problem.addConstraint (distances, distanceIntervals, distanceScaling);
+
+      // Create solver using Ipopt. With sparse matrices, the default
+      // Ipopt plugin is replaced by its sparse counterpart.
+      std::string solverName = solver_;
+      if (options_.useSparseMatrices && solverName == "ipopt")
+	solverName = "ipopt-sparse";
+
+      // Plugin loading is serialized so that several fitters can run
+      // in parallel.
+      boost::scoped_ptr<SolverFactory<genericSolver_t> > factory;
+      {
+	boost::lock_guard<boost::mutex> lock (pluginMutex);
+	factory.reset (new SolverFactory<genericSolver_t> (solverName,
+							   problem));
+      }
+      genericSolver_t& solver = (*factory) ();
 
       // Ipopt parameters
-      solver.parameters ()["ipopt.output_file"].value = std::string ("fitter-ipopt.log");
+      if (options_.solverLogFile)
+	solver.parameters ()["ipopt.output_file"].value
+	  = *options_.solverLogFile;
       solver.parameters ()["ipopt.linear_solver"].value = std::string ("mumps");
-      solver.parameters ()["ipopt.derivative_test"].value = std::string ("first-order");
-      solver.parameters ()["ipopt.derivative_test_perturbation"].value = 10e-8;
-      solver.parameters ()["ipopt.print_level"].value = 5;
-      solver.parameters ()["ipopt.file_print_level"].value = 5;
-      solver.parameters ()["ipopt.print_user_options"].value = std::string ("yes");
       solver.parameters ()["ipopt.bound_relax_factor"].value = 1e-12;
       solver.parameters ()["ipopt.tol"].value = 1e-3;
       solver.parameters ()["ipopt.compl_inf_tol"].value = 1e-6;
@@ -225,50 +886,91 @@ namespace roboptim
       solver.parameters ()["ipopt.mu_strategy"].value = std::string ("adaptive");
       solver.parameters ()["ipopt.nlp_scaling_method"].value = std::string ("gradient-based");
 
+      // Cost and constraints provide exact hessians.
+      solver.parameters ()["ipopt.hessian_approximation"].value = std::string ("exact");
+
+      // A warm start is close to the solution: start with a small
+      // barrier parameter.
+      if (warmStart_)
+	solver.parameters ()["ipopt.mu_init"].value = 1e-4;
+
+      // Preset and user parameters.
+      for (FitterOptions::parameters_t::const_iterator
+	     it = options_.parameters.begin ();
+	   it != options_.parameters.end (); ++it)
+	solver.parameters ()[it->first].value = it->second;
+
+      const std::string* linearSolver = boost::get<std::string>
+	(&solver.parameters ()["ipopt.linear_solver"].value);
+
+      // Count solver iterations, unless the solver does not support
+      // iteration callbacks.
+      try
+	{
+	  solver.setIterationCallback (IterationCounter (stats_.iterations));
+	}
+      catch (std::runtime_error&)
+	{
+	}
+
       // Set optimization logger if a log directory was provided.
       // Note: actual logging to file is done once the OptimizationLogger is
       // destroyed.
-      boost::shared_ptr<OptimizationLogger<solver_t> > logger;
+      boost::shared_ptr<OptimizationLogger<genericSolver_t> > logger;
       if (logDir_)
 	{
 	  // Add optimization logger.
-	  logger = boost::make_shared<OptimizationLogger<solver_t> > (boost::ref (solver), *logDir_);
+	  logger = boost::make_shared<OptimizationLogger<genericSolver_t> > (boost::ref (solver), *logDir_);
 	}
 
       // Solve problem and check if the optimum is correct.
-      solver_t::result_t result = solver.minimum ();
+      {
+	boost::unique_lock<boost::mutex> lock (mumpsMutex, boost::defer_lock);
+	if (linearSolver && *linearSolver == "mumps")
+	  lock.lock ();
+
+	solver.minimum ();
+      }
+      status_ = solver.minimumType ();
 
-      switch (solver.minimumType ())
+      switch (status_)
 	{
-	case solver_t::SOLVER_NO_SOLUTION:
+	case genericSolver_t::SOLVER_NO_SOLUTION:
 	  {
-	    std::cerr << "No solution." << std::endl;
+	    if (options_.verbose)
+	      std::cerr << "No solution." << std::endl;
 	    solutionParam = initParam_;
 	    break;
 	  }
-	case solver_t::SOLVER_ERROR:
+	case genericSolver_t::SOLVER_ERROR:
 	  {
 	    // Display error and fall back gracefully to initial
 	    // guess.
-	    std::cerr << "An error happened: " << std::endl
-	    	      << solver.getMinimum<SolverError> ().what ()
-	    	      << std::endl;
+	    errorMessage_ = solver.template getMinimum<SolverError> ().what ();
+	    if (options_.verbose)
+	      std::cerr << "An error happened: " << std::endl
+			<< errorMessage_ << std::endl;
 	    solutionParam = initParam_;
 	    break;
 	  }
 
-	case solver_t::SOLVER_VALUE_WARNINGS:
-	case solver_t::SOLVER_VALUE:
+	case genericSolver_t::SOLVER_VALUE_WARNINGS:
+	case genericSolver_t::SOLVER_VALUE:
 	  {
 	    // Display the result.
-	    std::cout << "A solution has been found" << std::endl;
-	    solutionParam = solver.getMinimum<Result> ().x;
+	    if (options_.verbose)
+	      std::cout << "A solution has been found" << std::endl;
+	    solutionParam = solver.template getMinimum<Result> ().x;
 	    break;
 	  }
 	}
 
-      solutionParam_ = solutionParam;
-      solutionVolume_ = (*volume) (solutionParam)[0];
+      // The solver must be destroyed before its plugin is unloaded.
+      logger.reset ();
+      {
+	boost::lock_guard<boost::mutex> lock (pluginMutex);
+	factory.reset ();
+      }
     }
 
   } // end of namespace capsule.
@@ -0,0 +1,472 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/geometry.cc
+ *
+ * \brief Implementation of the geometry functions templated on the
+ * scalar type.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_GEOMETRY_CC_
+# define ROBOPTIM_CAPSULE_GEOMETRY_CC_
+
+# include <algorithm>
+# include <cmath>
+# include <limits>
+
+# include <Eigen/Eigenvalues>
+
+# include <roboptim/capsule/geometry.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Number of points processed at once by the streaming
+      /// loops.
+      ///
+      /// Blocks are small enough for their temporaries to live on the
+      /// stack, and large enough for Eigen to vectorize over them.
+      const size_type blockSize = 256;
+
+      /// \brief Stack-allocated blocks with scalar type T.
+      template <typename T>
+      struct Blocks
+      {
+	/// \brief Block of points.
+	typedef Eigen::Matrix<T, 3, Eigen::Dynamic, 0, 3, blockSize>
+	point_t;
+
+	/// \brief Block of scalars, one per point.
+	typedef Eigen::Matrix<T, 1, Eigen::Dynamic, Eigen::RowMajor,
+			      1, blockSize> scalar_t;
+
+	/// \brief Lane of coordinates, one per point.
+	typedef Eigen::Array<T, Eigen::Dynamic, 1, 0, blockSize, 1> lane_t;
+      };
+
+      /// \brief Projection of blocks of points on a segment.
+      ///
+      /// The coordinates of each block are transposed into contiguous x,
+      /// y and z lanes, on which Eigen uses packet (SIMD) arithmetic.
+      template <typename T>
+      class SegmentBlock
+      {
+      public:
+	typedef typename GenericGeometry<T>::point_t point_t;
+	typedef typename GenericGeometry<T>::vector3_t vector3_t;
+	typedef typename GenericGeometry<T>::const_points_ref
+	const_points_ref;
+	typedef typename Blocks<T>::lane_t lane_t;
+
+	/// \param degenerateLambda projection parameter used if the
+	/// segment is a point.
+	SegmentBlock (const point_t& a, const point_t& b,
+		      T degenerateLambda)
+	  : a_ (a),
+	    ab_ (b - a),
+	    degenerateLambda_ (degenerateLambda)
+	{
+	  T d2 = ab_.squaredNorm ();
+	  isDegenerate_ = d2 < T (1e-12);
+	  invD2_ = isDegenerate_ ? T (0) : T (1) / d2;
+	}
+
+	/// \brief Project the points j to j + n - 1.
+	void compute (const_points_ref points, size_type j, size_type n)
+	{
+	  dx = points.row (0).segment (j, n).transpose ().array () - a_[0];
+	  dy = points.row (1).segment (j, n).transpose ().array () - a_[1];
+	  dz = points.row (2).segment (j, n).transpose ().array () - a_[2];
+
+	  if (isDegenerate_)
+	    lambda.setConstant (n, degenerateLambda_);
+	  else
+	    lambda = ((dx * ab_[0] + dy * ab_[1] + dz * ab_[2]) * invD2_)
+	      .max (T (0)).min (T (1));
+	}
+
+	/// \brief Distances from the points to the segment.
+	void distances (lane_t& d) const
+	{
+	  d = ((dx - lambda * ab_[0]).square ()
+	       + (dy - lambda * ab_[1]).square ()
+	       + (dz - lambda * ab_[2]).square ()).sqrt ();
+	}
+
+	const point_t& a () const
+	{
+	  return a_;
+	}
+
+	const vector3_t& ab () const
+	{
+	  return ab_;
+	}
+
+	/// \brief Offsets from the start point.
+	lane_t dx, dy, dz;
+
+	/// \brief Projection parameters.
+	lane_t lambda;
+
+      private:
+	point_t a_;
+	vector3_t ab_;
+	T degenerateLambda_;
+	T invD2_;
+	bool isDegenerate_;
+      };
+    } // end of anonymous namespace.
+
+
+    template <typename T>
+    typename GenericGeometry<T>::value_type
+    GenericGeometry<T>::distancePointToSegment (const point_t& p,
+						const point_t& a,
+						const point_t& b)
+    {
+      return (p - projectionOnSegment (p, a, b)).norm ();
+    }
+
+
+    template <typename T>
+    typename GenericGeometry<T>::point_t
+    GenericGeometry<T>::projectionOnSegment (const point_t& p,
+					     const point_t& a,
+					     const point_t& b)
+    {
+      vector3_t ab = b - a;
+      value_type d2_ab = ab.squaredNorm ();
+
+      // If the segment is a point, i.e. a = b
+      if (d2_ab < value_type (1e-12)) return a;
+
+      // We note a + lambda (b - a) the projection of p on the line (a,b)
+      value_type lambda = (p - a).dot (ab) / d2_ab;
+      if (lambda > 1) return b;
+      else if (lambda < 0) return a;
+      else return a + lambda * ab;
+    }
+
+
+    template <typename T>
+    typename GenericGeometry<T>::value_type
+    GenericGeometry<T>::projectionParameterOnSegment (const point_t& p,
+						      const point_t& a,
+						      const point_t& b)
+    {
+      vector3_t ab = b - a;
+      value_type d2_ab = ab.squaredNorm ();
+
+      // If the segment is a point, i.e. a = b
+      if (d2_ab < value_type (1e-12)) return value_type (0.5);
+
+      value_type lambda = (p - a).dot (ab) / d2_ab;
+      if (lambda > 1) return 1;
+      else if (lambda < 0) return 0;
+      else return lambda;
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::distancesPointsToSegment
+    (const_points_ref points, const point_t& a, const point_t& b,
+     Eigen::Ref<vector_t> distances)
+    {
+      assert (distances.size () == points.cols ());
+
+      // As in distancePointToSegment, a degenerate segment is its
+      // start point.
+      SegmentBlock<T> block (a, b, 0);
+      typename Blocks<T>::lane_t d;
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  block.compute (points, j, n);
+	  block.distances (d);
+	  distances.segment (j, n) = d.matrix ();
+	}
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::projectionsOnSegment
+    (const_points_ref points, const point_t& a, const point_t& b,
+     Eigen::Ref<points_t> projections)
+    {
+      assert (projections.cols () == points.cols ());
+
+      SegmentBlock<T> block (a, b, 0);
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  block.compute (points, j, n);
+	  for (int c = 0; c < 3; ++c)
+	    projections.row (c).segment (j, n)
+	      = (block.a ()[c] + block.lambda * block.ab ()[c])
+	      .matrix ().transpose ();
+	}
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::projectionParametersOnSegment
+    (const_points_ref points, const point_t& a, const point_t& b,
+     Eigen::Ref<vector_t> lambdas)
+    {
+      assert (lambdas.size () == points.cols ());
+
+      // As in projectionParameterOnSegment, both end points of a
+      // degenerate segment are weighted evenly.
+      SegmentBlock<T> block (a, b, value_type (0.5));
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  block.compute (points, j, n);
+	  lambdas.segment (j, n) = block.lambda.matrix ();
+	}
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::distancesPointToSegments
+    (const point_t& p, const_points_ref starts, const_points_ref ends,
+     Eigen::Ref<vector_t> distances)
+    {
+      typedef typename Blocks<T>::lane_t lane_t;
+
+      assert (starts.cols () == ends.cols ());
+      assert (distances.size () == starts.cols ());
+
+      lane_t abx, aby, abz, dx, dy, dz, d2, lambda;
+      for (size_type j = 0; j < starts.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, starts.cols () - j);
+	  abx = (ends.row (0).segment (j, n)
+		 - starts.row (0).segment (j, n)).transpose ().array ();
+	  aby = (ends.row (1).segment (j, n)
+		 - starts.row (1).segment (j, n)).transpose ().array ();
+	  abz = (ends.row (2).segment (j, n)
+		 - starts.row (2).segment (j, n)).transpose ().array ();
+	  dx = p[0] - starts.row (0).segment (j, n).transpose ().array ();
+	  dy = p[1] - starts.row (1).segment (j, n).transpose ().array ();
+	  dz = p[2] - starts.row (2).segment (j, n).transpose ().array ();
+
+	  // Degenerate segments are their start point. Their lanes are
+	  // computed anyway, then discarded.
+	  d2 = abx.square () + aby.square () + abz.square ();
+	  lambda = (d2 < value_type (1e-12)).select
+	    (lane_t::Zero (n),
+	     ((dx * abx + dy * aby + dz * abz) / d2)
+	     .max (value_type (0)).min (value_type (1)));
+
+	  distances.segment (j, n)
+	    = ((dx - lambda * abx).square ()
+	       + (dy - lambda * aby).square ()
+	       + (dz - lambda * abz).square ()).sqrt ().matrix ();
+	}
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::extremePointsAlongDirection
+    (const vector3_t& dir, const_points_ref points, int& imin, int& imax)
+    {
+      value_type minproj = std::numeric_limits<value_type>::max ();
+      value_type maxproj = -minproj;
+
+      typename Blocks<T>::scalar_t proj;
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+        {
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  // Project vectors from origin to points onto direction vector
+	  proj.noalias () = dir.transpose () * points.middleCols (j, n);
+
+	  // Keep track of least and most distant points along
+	  // direction vector
+	  size_type i;
+	  value_type p = proj.minCoeff (&i);
+	  if (p < minproj) {
+	    minproj = p;
+	    imin = static_cast<int> (j + i);
+	  }
+	  p = proj.maxCoeff (&i);
+	  if (p > maxproj) {
+	    maxproj = p;
+	    imax = static_cast<int> (j + i);
+	  }
+        }
+    }
+
+
+    template <typename T>
+    void GenericGeometry<T>::statistics (const_points_ref points,
+					 point_t& mean,
+					 matrix3_t& covariance,
+					 point_t& lower,
+					 point_t& upper)
+    {
+      assert (points.cols () > 0);
+
+      const point_t origin = points.col (0);
+      Eigen::Vector3d sum = Eigen::Vector3d::Zero ();
+      Eigen::Matrix3d sum2 = Eigen::Matrix3d::Zero ();
+      lower = upper = origin;
+
+      typename Blocks<T>::point_t centered;
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  centered = points.middleCols (j, n).colwise () - origin;
+
+	  sum += centered.rowwise ().sum ().template cast<double> ();
+	  sum2.noalias () += (centered * centered.transpose ())
+	    .template cast<double> ();
+	  lower = lower.cwiseMin
+	    (points.middleCols (j, n).rowwise ().minCoeff ());
+	  upper = upper.cwiseMax
+	    (points.middleCols (j, n).rowwise ().maxCoeff ());
+	}
+
+      const double count = static_cast<double> (points.cols ());
+      const Eigen::Vector3d offset = sum / count;
+      mean = (origin.template cast<double> () + offset)
+	.template cast<value_type> ();
+      covariance = (sum2 / count - offset * offset.transpose ())
+	.template cast<value_type> ();
+    }
+
+
+    template <typename T>
+    typename GenericGeometry<T>::capsule_t
+    GenericGeometry<T>::boundingCapsule (const_points_ref points)
+    {
+      typedef typename Blocks<T>::point_t pointBlock_t;
+      typedef typename Blocks<T>::scalar_t scalarBlock_t;
+
+      point_t mean, lower, upper;
+      matrix3_t covariance;
+      statistics (points, mean, covariance, lower, upper);
+
+      // Eigen values are sorted in increasing order.
+      Eigen::SelfAdjointEigenSolver<matrix3_t> solver (covariance);
+      const vector3_t axis = solver.eigenvectors ().col (2).normalized ();
+
+      // Extent along the axis and distance to the axis. Distances are
+      // computed from the orthogonal components rather than by
+      // difference of squares, which cancels for points close to the
+      // axis.
+      pointBlock_t centered;
+      scalarBlock_t t;
+      scalarBlock_t rho2;
+      scalarBlock_t slack;
+      value_type tmin = std::numeric_limits<value_type>::max ();
+      value_type tmax = -tmin;
+      value_type rho2max = 0;
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  centered = points.middleCols (j, n).colwise () - mean;
+	  t.noalias () = axis.transpose () * centered;
+	  centered.noalias () -= axis * t;
+	  rho2 = centered.colwise ().squaredNorm ();
+
+	  tmin = std::min (tmin, t.minCoeff ());
+	  tmax = std::max (tmax, t.maxCoeff ());
+	  rho2max = std::max (rho2max, rho2.maxCoeff ());
+	}
+      const value_type radius = std::sqrt (rho2max);
+
+      // The end points start as far inwards as the extent allows, then
+      // move outwards until the spherical ends contain the points
+      // beyond them: a point at t beyond the end e is inside the end
+      // sphere if |t - e| <= sqrt (radius^2 - rho^2).
+      value_type start = tmin + radius;
+      value_type end = tmax - radius;
+      if (start > end)
+	start = end = (tmin + tmax) / 2;
+
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+	  centered = points.middleCols (j, n).colwise () - mean;
+	  t.noalias () = axis.transpose () * centered;
+	  centered.noalias () -= axis * t;
+	  rho2 = centered.colwise ().squaredNorm ();
+	  slack = (rho2max - rho2.array ()).max (value_type (0)).sqrt ()
+	    .matrix ();
+
+	  start = std::min (start, (t + slack).minCoeff ());
+	  end = std::max (end, (t - slack).maxCoeff ());
+	}
+
+      capsule_t capsule;
+      capsule.P0 = mean + start * axis;
+      capsule.P1 = mean + end * axis;
+      capsule.radius = radius;
+      return capsule;
+    }
+
+
+    template <typename T>
+    typename GenericGeometry<T>::value_type
+    GenericGeometry<T>::radiusInflation (value_type scale)
+    {
+      // Twice the bound on the rounding error of a distance computed
+      // with scalar type T, see boundingCapsule (float points).
+      return 32 * unitRoundoff () * scale;
+    }
+
+
+    Capsule boundingCapsule (FloatGeometry::const_points_ref points)
+    {
+      assert (points.cols () > 0);
+
+      FloatGeometry::capsule_t capsule =
+	FloatGeometry::boundingCapsule (points);
+
+      // Largest distance to the segment, as computed by the batched
+      // kernel that the error bound covers.
+      FloatGeometry::vector_t distances (points.cols ());
+      FloatGeometry::distancesPointsToSegment (points, capsule.P0,
+					       capsule.P1, distances);
+      const float radius = std::max (capsule.radius,
+				     distances.maxCoeff ());
+
+      Capsule result;
+      result.P0 = capsule.P0.cast<value_type> ();
+      result.P1 = capsule.P1.cast<value_type> ();
+      const value_type scale = std::max (result.P0.norm (),
+					 result.P1.norm ()) + radius;
+      result.radius = radius
+	+ static_cast<value_type>
+	(FloatGeometry::radiusInflation (static_cast<float> (scale)));
+      return result;
+    }
+
+
+    template class GenericGeometry<float>;
+    template class GenericGeometry<double>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_GEOMETRY_CC_
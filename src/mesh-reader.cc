@@ -0,0 +1,696 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/mesh-reader.cc
+ *
+ * \brief Implementation of the mesh and point cloud readers.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MESH_READER_CC_
+# define ROBOPTIM_CAPSULE_MESH_READER_CC_
+
+# include <algorithm>
+# include <cctype>
+# include <cstdlib>
+# include <cstring>
+# include <fstream>
+# include <iostream>
+# include <sstream>
+# include <stdexcept>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/interprocess/file_mapping.hpp>
+# include <boost/interprocess/mapped_region.hpp>
+
+# include <roboptim/capsule/mesh-reader.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Size of the blocks read from streams.
+      const size_t blockSize = 1 << 20;
+
+      /// \brief Input bytes, either memory-mapped or read from a
+      /// stream by blocks.
+      class Input
+      {
+      public:
+	/// \brief Memory-mapped input.
+	Input (const char* data, size_t size)
+	  : data_ (data),
+	    size_ (size),
+	    pos_ (0),
+	    stream_ (0)
+	{}
+
+	/// \brief Stream input.
+	explicit Input (std::istream& stream)
+	  : data_ (0),
+	    size_ (0),
+	    pos_ (0),
+	    stream_ (&stream)
+	{}
+
+	/// \brief Make at least n bytes available.
+	///
+	/// \return false if the input ends before.
+	bool ensure (size_t n)
+	{
+	  if (size_ - pos_ >= n)
+	    return true;
+	  if (!stream_)
+	    return false;
+
+	  // Drop the consumed bytes, then read blocks.
+	  buffer_.erase (buffer_.begin (), buffer_.begin () + pos_);
+	  pos_ = 0;
+	  while (buffer_.size () < n && *stream_)
+	    {
+	      size_t size = buffer_.size ();
+	      buffer_.resize (std::max (size + blockSize, n));
+	      stream_->read (&buffer_[size],
+			     static_cast<std::streamsize> (buffer_.size () - size));
+	      buffer_.resize (size + static_cast<size_t> (stream_->gcount ()));
+	    }
+	  data_ = buffer_.empty () ? 0 : &buffer_[0];
+	  size_ = buffer_.size ();
+
+	  return size_ >= n;
+	}
+
+	/// \brief Current bytes.
+	const char* current () const
+	{
+	  return data_ + pos_;
+	}
+
+	/// \brief Skip n bytes, which must be available.
+	void consume (size_t n)
+	{
+	  pos_ += n;
+	}
+
+	/// \brief Whether the input starts with a given string.
+	bool startsWith (const char* s)
+	{
+	  size_t n = std::strlen (s);
+	  return ensure (n) && std::memcmp (current (), s, n) == 0;
+	}
+
+	/// \brief Read a line, without its end of line characters.
+	///
+	/// \return false at the end of the input.
+	bool readLine (std::string& line)
+	{
+	  size_t searched = 0;
+	  while (true)
+	    {
+	      size_t available = size_ - pos_;
+	      const char* end = 0;
+	      if (available > searched)
+		end = static_cast<const char*>
+		  (std::memchr (current () + searched, '\n',
+				available - searched));
+
+	      if (end)
+		{
+		  line.assign (current (), end);
+		  pos_ += static_cast<size_t> (end - current ()) + 1;
+		  break;
+		}
+
+	      searched = available;
+	      if (!ensure (available + 1))
+		{
+		  // Last line without end of line.
+		  if (size_ == pos_)
+		    return false;
+		  line.assign (current (), size_ - pos_);
+		  pos_ = size_;
+		  break;
+		}
+	    }
+
+	  if (!line.empty () && line[line.size () - 1] == '\r')
+	    line.erase (line.size () - 1);
+	  return true;
+	}
+
+      private:
+	const char* data_;
+	size_t size_;
+	size_t pos_;
+	std::istream* stream_;
+	std::vector<char> buffer_;
+      };
+
+      /// \brief Buffer passing points to the sink by chunks.
+      class Chunk
+      {
+      public:
+	Chunk (const pointSink_t& sink, size_t size)
+	  : sink_ (sink),
+	    size_ (std::max (size, static_cast<size_t> (1))),
+	    nbPoints_ (0)
+	{
+	  points_.reserve (size_);
+	}
+
+	void push (value_type x, value_type y, value_type z)
+	{
+	  points_.push_back (point_t (x, y, z));
+	  ++nbPoints_;
+	  if (points_.size () >= size_)
+	    flush ();
+	}
+
+	void flush ()
+	{
+	  if (points_.empty ())
+	    return;
+	  sink_ (points_);
+	  points_.clear ();
+	}
+
+	size_t nbPoints () const
+	{
+	  return nbPoints_;
+	}
+
+      private:
+	const pointSink_t& sink_;
+	size_t size_;
+	size_t nbPoints_;
+	polyhedron_t points_;
+      };
+
+      bool hostIsLittleEndian ()
+      {
+	const boost::uint16_t one = 1;
+	return *reinterpret_cast<const unsigned char*> (&one) == 1;
+      }
+
+      /// \brief Copy a value, reversing its bytes if needed.
+      template <typename T>
+      T decode (const char* data, bool swap)
+      {
+	char bytes[sizeof (T)];
+	std::memcpy (bytes, data, sizeof (T));
+	if (swap)
+	  std::reverse (bytes, bytes + sizeof (T));
+
+	T value;
+	std::memcpy (&value, bytes, sizeof (T));
+	return value;
+      }
+
+      std::runtime_error parseError (const std::string& format,
+				     const std::string& message)
+      {
+	return std::runtime_error ("invalid " + format + " input: " + message);
+      }
+
+      /// \brief Parse the first three numbers of a string.
+      ///
+      /// \return false if there are less than three numbers.
+      bool parsePoint (const char* s, value_type& x, value_type& y,
+		       value_type& z)
+      {
+	char* end;
+	x = std::strtod (s, &end);
+	if (end == s)
+	  return false;
+	s = end;
+	y = std::strtod (s, &end);
+	if (end == s)
+	  return false;
+	s = end;
+	z = std::strtod (s, &end);
+	return end != s;
+      }
+
+      // ------------------------- PLY --------------------------
+
+      enum PlyType
+	{
+	  PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16,
+	  PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64
+	};
+
+      PlyType plyType (const std::string& name)
+      {
+	if (name == "char" || name == "int8") return PLY_INT8;
+	if (name == "uchar" || name == "uint8") return PLY_UINT8;
+	if (name == "short" || name == "int16") return PLY_INT16;
+	if (name == "ushort" || name == "uint16") return PLY_UINT16;
+	if (name == "int" || name == "int32") return PLY_INT32;
+	if (name == "uint" || name == "uint32") return PLY_UINT32;
+	if (name == "float" || name == "float32") return PLY_FLOAT32;
+	if (name == "double" || name == "float64") return PLY_FLOAT64;
+	throw parseError ("PLY", "unknown property type " + name);
+      }
+
+      size_t plySize (PlyType type)
+      {
+	static const size_t sizes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+	return sizes[type];
+      }
+
+      value_type plyValue (const char* data, PlyType type, bool swap)
+      {
+	switch (type)
+	  {
+	  case PLY_INT8: return decode<boost::int8_t> (data, swap);
+	  case PLY_UINT8: return decode<boost::uint8_t> (data, swap);
+	  case PLY_INT16: return decode<boost::int16_t> (data, swap);
+	  case PLY_UINT16: return decode<boost::uint16_t> (data, swap);
+	  case PLY_INT32: return decode<boost::int32_t> (data, swap);
+	  case PLY_UINT32: return decode<boost::uint32_t> (data, swap);
+	  case PLY_FLOAT32: return decode<float> (data, swap);
+	  case PLY_FLOAT64: return decode<double> (data, swap);
+	  }
+	return 0.;
+      }
+
+      struct PlyProperty
+      {
+	std::string name;
+	PlyType type;
+	bool isList;
+	PlyType countType;
+      };
+
+      struct PlyElement
+      {
+	std::string name;
+	size_t count;
+	std::vector<PlyProperty> properties;
+      };
+
+      size_t readPly (Input& input, Chunk& chunk)
+      {
+	std::string line;
+	if (!input.readLine (line) || line != "ply")
+	  throw parseError ("PLY", "missing magic number");
+
+	// Header.
+	enum { ASCII, BINARY_LE, BINARY_BE } encoding = ASCII;
+	bool hasFormat = false;
+	std::vector<PlyElement> elements;
+	while (true)
+	  {
+	    if (!input.readLine (line))
+	      throw parseError ("PLY", "unterminated header");
+
+	    std::istringstream ss (line);
+	    std::string keyword;
+	    ss >> keyword;
+
+	    if (keyword == "end_header")
+	      break;
+	    else if (keyword == "format")
+	      {
+		std::string name;
+		ss >> name;
+		if (name == "ascii")
+		  encoding = ASCII;
+		else if (name == "binary_little_endian")
+		  encoding = BINARY_LE;
+		else if (name == "binary_big_endian")
+		  encoding = BINARY_BE;
+		else
+		  throw parseError ("PLY", "unknown format " + name);
+		hasFormat = true;
+	      }
+	    else if (keyword == "element")
+	      {
+		PlyElement element;
+		if (!(ss >> element.name >> element.count))
+		  throw parseError ("PLY", "invalid element: " + line);
+		elements.push_back (element);
+	      }
+	    else if (keyword == "property")
+	      {
+		if (elements.empty ())
+		  throw parseError ("PLY", "property outside of an element");
+
+		PlyProperty property;
+		std::string type;
+		ss >> type;
+		property.isList = (type == "list");
+		if (property.isList)
+		  {
+		    std::string countType;
+		    ss >> countType >> type;
+		    property.countType = plyType (countType);
+		  }
+		property.type = plyType (type);
+		if (!(ss >> property.name))
+		  throw parseError ("PLY", "invalid property: " + line);
+		elements.back ().properties.push_back (property);
+	      }
+	    // Comments and object information are ignored.
+	  }
+
+	if (!hasFormat)
+	  throw parseError ("PLY", "missing format");
+
+	const bool swap = (encoding == BINARY_LE) != hostIsLittleEndian ()
+	  && encoding != ASCII;
+
+	for (size_t e = 0; e < elements.size (); ++e)
+	  {
+	    const PlyElement& element = elements[e];
+	    const std::vector<PlyProperty>& properties = element.properties;
+	    const bool isVertex = (element.name == "vertex");
+
+	    // Indices of the coordinates.
+	    int coordinates[3] = {-1, -1, -1};
+	    if (isVertex)
+	      for (size_t p = 0; p < properties.size (); ++p)
+		{
+		  const std::string& name = properties[p].name;
+		  if (properties[p].isList)
+		    continue;
+		  if (name == "x") coordinates[0] = static_cast<int> (p);
+		  else if (name == "y") coordinates[1] = static_cast<int> (p);
+		  else if (name == "z") coordinates[2] = static_cast<int> (p);
+		}
+	    if (isVertex && (coordinates[0] < 0 || coordinates[1] < 0
+			     || coordinates[2] < 0))
+	      throw parseError ("PLY", "missing vertex coordinates");
+
+	    std::vector<value_type> values (properties.size (), 0.);
+	    for (size_t i = 0; i < element.count; ++i)
+	      {
+		if (encoding == ASCII)
+		  {
+		    if (!input.readLine (line))
+		      throw parseError ("PLY", "unexpected end of input");
+
+		    const char* s = line.c_str ();
+		    char* end;
+		    for (size_t p = 0; p < properties.size (); ++p)
+		      {
+			value_type value = std::strtod (s, &end);
+			if (end == s)
+			  throw parseError ("PLY", "invalid line: " + line);
+			s = end;
+
+			if (!properties[p].isList)
+			  {
+			    values[p] = value;
+			    continue;
+			  }
+
+			// Skip the list items.
+			for (long k = static_cast<long> (value); k > 0; --k)
+			  {
+			    std::strtod (s, &end);
+			    if (end == s)
+			      throw parseError ("PLY", "invalid line: " + line);
+			    s = end;
+			  }
+		      }
+		  }
+		else
+		  for (size_t p = 0; p < properties.size (); ++p)
+		    {
+		      const PlyProperty& property = properties[p];
+		      if (property.isList)
+			{
+			  size_t countSize = plySize (property.countType);
+			  if (!input.ensure (countSize))
+			    throw parseError ("PLY", "unexpected end of input");
+			  size_t count = static_cast<size_t>
+			    (plyValue (input.current (), property.countType,
+				       swap));
+			  input.consume (countSize);
+
+			  size_t size = count * plySize (property.type);
+			  if (!input.ensure (size))
+			    throw parseError ("PLY", "unexpected end of input");
+			  input.consume (size);
+			}
+		      else
+			{
+			  size_t size = plySize (property.type);
+			  if (!input.ensure (size))
+			    throw parseError ("PLY", "unexpected end of input");
+			  values[p] = plyValue (input.current (), property.type,
+					       swap);
+			  input.consume (size);
+			}
+		    }
+
+		if (isVertex)
+		  chunk.push (values[coordinates[0]], values[coordinates[1]],
+			      values[coordinates[2]]);
+	      }
+
+	    // Faces and other elements after the vertices are not read.
+	    if (isVertex)
+	      break;
+	  }
+
+	return chunk.nbPoints ();
+      }
+
+      // ------------------------- STL --------------------------
+
+      /// \brief Whether an STL input is in ASCII.
+      ///
+      /// ASCII files start with "solid", but so do some binary files:
+      /// the beginning of the input is also checked for keywords.
+      bool isAsciiStl (Input& input)
+      {
+	if (!input.startsWith ("solid"))
+	  return false;
+
+	size_t size = 512;
+	while (size > 0 && !input.ensure (size))
+	  size /= 2;
+	std::string begin (input.current (), size);
+	return begin.find ("facet") != std::string::npos
+	  || begin.find ("endsolid") != std::string::npos;
+      }
+
+      size_t readStl (Input& input, Chunk& chunk)
+      {
+	if (isAsciiStl (input))
+	  {
+	    std::string line;
+	    while (input.readLine (line))
+	      {
+		const char* s = line.c_str ();
+		while (std::isspace (static_cast<unsigned char> (*s)))
+		  ++s;
+		if (std::strncmp (s, "vertex", 6) != 0)
+		  continue;
+
+		value_type x, y, z;
+		if (!parsePoint (s + 6, x, y, z))
+		  throw parseError ("STL", "invalid vertex: " + line);
+		chunk.push (x, y, z);
+	      }
+	    return chunk.nbPoints ();
+	  }
+
+	// Binary: 80-byte header, triangle count, then for each
+	// triangle a normal, three vertices and an attribute.
+	const bool swap = !hostIsLittleEndian ();
+	if (!input.ensure (84))
+	  throw parseError ("STL", "truncated header");
+	boost::uint32_t nbTriangles
+	  = decode<boost::uint32_t> (input.current () + 80, swap);
+	input.consume (84);
+
+	for (boost::uint32_t i = 0; i < nbTriangles; ++i)
+	  {
+	    if (!input.ensure (50))
+	      throw parseError ("STL", "unexpected end of input");
+	    const char* data = input.current () + 12;
+	    for (int k = 0; k < 3; ++k, data += 12)
+	      chunk.push (decode<float> (data, swap),
+			  decode<float> (data + 4, swap),
+			  decode<float> (data + 8, swap));
+	    input.consume (50);
+	  }
+
+	return chunk.nbPoints ();
+      }
+
+      // ------------------------- OBJ --------------------------
+
+      size_t readObj (Input& input, Chunk& chunk)
+      {
+	std::string line;
+	while (input.readLine (line))
+	  {
+	    const char* s = line.c_str ();
+	    while (std::isspace (static_cast<unsigned char> (*s)))
+	      ++s;
+	    if (s[0] != 'v' || !std::isspace (static_cast<unsigned char> (s[1])))
+	      continue;
+
+	    value_type x, y, z;
+	    if (!parsePoint (s + 1, x, y, z))
+	      throw parseError ("OBJ", "invalid vertex: " + line);
+	    chunk.push (x, y, z);
+	  }
+
+	return chunk.nbPoints ();
+      }
+
+      // ------------------------- XYZ --------------------------
+
+      size_t readXyz (Input& input, Chunk& chunk)
+      {
+	const bool swap = !hostIsLittleEndian ();
+	const size_t pointSize = 3 * sizeof (double);
+
+	while (input.ensure (pointSize))
+	  {
+	    const char* data = input.current ();
+	    chunk.push (decode<double> (data, swap),
+			decode<double> (data + 8, swap),
+			decode<double> (data + 16, swap));
+	    input.consume (pointSize);
+	  }
+
+	if (input.ensure (1))
+	  throw parseError ("xyz", "size is not a multiple of 24 bytes");
+
+	return chunk.nbPoints ();
+      }
+
+      size_t read (Input& input, MeshFormat format,
+		   const pointSink_t& sink, size_t chunkSize)
+      {
+	// Detect the format from the content.
+	if (format == MESH_FORMAT_AUTO)
+	  {
+	    if (input.startsWith ("ply"))
+	      format = MESH_FORMAT_PLY;
+	    else if (input.startsWith ("solid"))
+	      format = MESH_FORMAT_STL;
+	    else
+	      throw std::runtime_error ("unknown mesh format, "
+					"it must be given explicitly");
+	  }
+
+	Chunk chunk (sink, chunkSize);
+	switch (format)
+	  {
+	  case MESH_FORMAT_PLY:
+	    readPly (input, chunk);
+	    break;
+	  case MESH_FORMAT_STL:
+	    readStl (input, chunk);
+	    break;
+	  case MESH_FORMAT_OBJ:
+	    readObj (input, chunk);
+	    break;
+	  case MESH_FORMAT_XYZ:
+	    readXyz (input, chunk);
+	    break;
+	  case MESH_FORMAT_AUTO:
+	    break;
+	  }
+	chunk.flush ();
+
+	return chunk.nbPoints ();
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    MeshFormat meshFormatFromString (const std::string& name)
+    {
+      if (name == "auto") return MESH_FORMAT_AUTO;
+      if (name == "ply") return MESH_FORMAT_PLY;
+      if (name == "stl") return MESH_FORMAT_STL;
+      if (name == "obj") return MESH_FORMAT_OBJ;
+      if (name == "xyz") return MESH_FORMAT_XYZ;
+      throw std::runtime_error ("unknown mesh format: " + name);
+    }
+
+    MeshFormat meshFormatFromPath (const std::string& path)
+    {
+      std::string::size_type dot = path.find_last_of ('.');
+      if (dot == std::string::npos
+	  || path.find_first_of ('/', dot) != std::string::npos)
+	return MESH_FORMAT_AUTO;
+
+      std::string extension = path.substr (dot + 1);
+      for (size_t i = 0; i < extension.size (); ++i)
+	extension[i] = static_cast<char>
+	  (std::tolower (static_cast<unsigned char> (extension[i])));
+
+      if (extension == "ply") return MESH_FORMAT_PLY;
+      if (extension == "stl") return MESH_FORMAT_STL;
+      if (extension == "obj") return MESH_FORMAT_OBJ;
+
+      // ".xyz" files are usually ASCII point lists: the raw binary
+      // format is never guessed from the extension.
+      return MESH_FORMAT_AUTO;
+    }
+
+    size_t readMesh (std::istream& input, MeshFormat format,
+		     const pointSink_t& sink, size_t chunkSize)
+    {
+      Input bytes (input);
+      return read (bytes, format, sink, chunkSize);
+    }
+
+    size_t readMeshFile (const std::string& path, MeshFormat format,
+			 const pointSink_t& sink, size_t chunkSize)
+    {
+      if (path == "-")
+	return readMesh (std::cin, format, sink, chunkSize);
+
+      if (format == MESH_FORMAT_AUTO)
+	format = meshFormatFromPath (path);
+
+      // Empty files cannot be mapped.
+      std::ifstream file (path.c_str (), std::ios::binary | std::ios::ate);
+      if (!file)
+	throw std::runtime_error ("cannot open " + path);
+      if (file.tellg () == std::streampos (0))
+	return readMesh (file, format, sink, chunkSize);
+      file.close ();
+
+      using namespace boost::interprocess;
+      file_mapping mapping (path.c_str (), read_only);
+      mapped_region region (mapping, read_only);
+      region.advise (mapped_region::advice_sequential);
+
+      Input bytes (static_cast<const char*> (region.get_address ()),
+		   region.get_size ());
+      return read (bytes, format, sink, chunkSize);
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MESH_READER_CC_
@@ -0,0 +1,433 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/multi-fitter.cc
+ *
+ * \brief Implementation of MultiFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MULTI_FITTER_CC_
+# define ROBOPTIM_CAPSULE_MULTI_FITTER_CC_
+
+# include <math.h>
+
+# include <algorithm>
+# include <cassert>
+# include <limits>
+# include <utility>
+
+# include <roboptim/capsule/batch-fitter.hh>
+# include <roboptim/capsule/multi-fitter.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Clusters with fewer points are not split, since their
+      /// convex hull may be degenerate.
+      const size_t minClusterPoints = 4;
+
+      /// \brief Indices of the points of a cluster.
+      typedef std::vector<size_t> cluster_t;
+      typedef std::vector<cluster_t> clusters_t;
+
+      /// \brief Capsule fitted over a cluster.
+      struct Piece
+      {
+	argument_t param;
+	value_type volume;
+      };
+      typedef std::vector<Piece> pieces_t;
+
+      /// \brief Capsule volume.
+      value_type capsuleVolume (value_type radius, value_type length)
+      {
+	return M_PI * radius * radius * length
+	  + 4. / 3. * M_PI * radius * radius * radius;
+      }
+
+      value_type totalVolume (const pieces_t& pieces)
+      {
+	value_type volume = 0.;
+	for (size_t i = 0; i < pieces.size (); ++i)
+	  volume += pieces[i].volume;
+	return volume;
+      }
+
+      polyhedron_t clusterPoints (const polyhedron_t& polyhedron,
+				  const cluster_t& cluster)
+      {
+	polyhedron_t points (cluster.size ());
+	for (size_t j = 0; j < cluster.size (); ++j)
+	  points[j] = polyhedron[cluster[j]];
+	return points;
+      }
+
+      /// \brief Fit one capsule per cluster, in parallel.
+      ///
+      /// Each capsule contains all the points of its cluster.
+      pieces_t fitClusters (const polyhedron_t& polyhedron,
+			    const clusters_t& clusters,
+			    const BatchFitter& batchFitter)
+      {
+	std::vector<polyhedrons_t> problems (clusters.size ());
+	for (size_t i = 0; i < clusters.size (); ++i)
+	  problems[i] = polyhedrons_t
+	    (1, clusterPoints (polyhedron, clusters[i]));
+
+	BatchFitter::results_t results = batchFitter.fit (problems);
+
+	pieces_t pieces (clusters.size ());
+	for (size_t i = 0; i < clusters.size (); ++i)
+	  {
+	    Eigen::Map<const points_t> points = pointsMap (problems[i][0]);
+
+	    Capsule capsule;
+	    if (results[i].status == GenericSolver::SOLVER_VALUE
+		|| results[i].status == GenericSolver::SOLVER_VALUE_WARNINGS)
+	      convertSolverParamToCapsule (capsule.P0, capsule.P1,
+					   capsule.radius,
+					   results[i].solutionParam);
+	    else
+	      // E.g. a flat cluster, whose convex hull is degenerate.
+	      capsule = capsuleFromPoints (points);
+
+	    // Solutions only satisfy the constraints up to the solver
+	    // tolerance: the radius is enlarged to contain all the
+	    // points.
+	    vector_t distances (points.cols ());
+	    distancesPointsToSegment (points, capsule.P0, capsule.P1,
+				      distances);
+	    capsule.radius = std::max (capsule.radius, distances.maxCoeff ());
+
+	    pieces[i].param.resize (7);
+	    convertCapsuleToSolverParam (pieces[i].param, capsule.P0,
+					 capsule.P1, capsule.radius);
+	    pieces[i].volume = capsuleVolume
+	      (capsule.radius, (capsule.P1 - capsule.P0).norm ());
+	  }
+	return pieces;
+      }
+
+      /// \brief Split a cluster in two halves, along its largest spread
+      /// direction.
+      void splitCluster (const polyhedron_t& polyhedron,
+			 const cluster_t& cluster,
+			 cluster_t& first, cluster_t& second)
+      {
+	const polyhedron_t points = clusterPoints (polyhedron, cluster);
+	const vector3_t direction
+	  = largestSpreadDirection (pointsMap (points));
+
+	std::vector<std::pair<value_type, size_t> >
+	  projections (cluster.size ());
+	for (size_t j = 0; j < cluster.size (); ++j)
+	  projections[j] = std::make_pair (direction.dot (points[j]),
+					   cluster[j]);
+
+	// Split at the median, so that both halves can be fitted.
+	const size_t middle = cluster.size () / 2;
+	std::nth_element (projections.begin (),
+			  projections.begin () + middle,
+			  projections.end ());
+
+	first.clear ();
+	second.clear ();
+	for (size_t j = 0; j < cluster.size (); ++j)
+	  (j < middle ? first : second).push_back (projections[j].second);
+	std::sort (first.begin (), first.end ());
+	std::sort (second.begin (), second.end ());
+      }
+
+      /// \brief Assign each point to the capsule it is deepest in.
+      ///
+      /// Since each point is inside the capsule of its cluster, it is
+      /// also inside the capsule it is assigned to.
+      void assignPoints (const polyhedron_t& polyhedron,
+			 const pieces_t& pieces,
+			 std::vector<size_t>& labels)
+      {
+	Eigen::Map<const points_t> points = pointsMap (polyhedron);
+	const size_type n = points.cols ();
+
+	vector_t depth = vector_t::Constant
+	  (n, std::numeric_limits<value_type>::infinity ());
+	vector_t distances (n);
+	labels.assign (polyhedron.size (), 0);
+
+	for (size_t i = 0; i < pieces.size (); ++i)
+	  {
+	    point_t P0, P1;
+	    value_type radius;
+	    convertSolverParamToCapsule (P0, P1, radius, pieces[i].param);
+	    distancesPointsToSegment (points, P0, P1, distances);
+	    for (size_type j = 0; j < n; ++j)
+	      if (distances[j] - radius < depth[j])
+		{
+		  depth[j] = distances[j] - radius;
+		  labels[static_cast<size_t> (j)] = i;
+		}
+	  }
+      }
+
+      /// \brief Refine the clusters by assigning the points to the
+      /// capsules they are deepest in, as long as the total volume
+      /// decreases.
+      void refineClusters (const polyhedron_t& polyhedron,
+			   size_t nbRefinements,
+			   const BatchFitter& batchFitter,
+			   clusters_t& clusters,
+			   pieces_t& pieces)
+      {
+	std::vector<size_t> labels;
+	for (size_t k = 0; k < nbRefinements; ++k)
+	  {
+	    assignPoints (polyhedron, pieces, labels);
+
+	    clusters_t refined (pieces.size ());
+	    for (size_t j = 0; j < labels.size (); ++j)
+	      refined[labels[j]].push_back (j);
+
+	    if (refined == clusters)
+	      return;
+	    for (size_t i = 0; i < refined.size (); ++i)
+	      if (refined[i].size () < minClusterPoints)
+		return;
+
+	    pieces_t refinedPieces = fitClusters (polyhedron, refined,
+						  batchFitter);
+	    if (totalVolume (refinedPieces) >= totalVolume (pieces))
+	      return;
+
+	    clusters.swap (refined);
+	    pieces.swap (refinedPieces);
+	  }
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    MultiFitter::
+    MultiFitter (const polyhedron_t& polyhedron, std::string solver)
+      : polyhedron_ (polyhedron),
+	solver_ (solver),
+	nbCapsules_ (0),
+	maxCapsules_ (8),
+	volumeRatio_ (0.5),
+	nbRefinements_ (5),
+	nbThreads_ (0),
+	options_ (FitterOptions::quiet ()),
+	solutionParams_ (),
+	solutionVolume_ (0.),
+	singleVolume_ (0.),
+	labels_ ()
+    {
+    }
+
+    MultiFitter::
+    ~MultiFitter ()
+    {
+    }
+
+    const polyhedron_t& MultiFitter::
+    polyhedron () const
+    {
+      return polyhedron_;
+    }
+
+    void MultiFitter::
+    polyhedron (const polyhedron_t& polyhedron)
+    {
+      polyhedron_ = polyhedron;
+    }
+
+    size_t& MultiFitter::
+    nbCapsules ()
+    {
+      return nbCapsules_;
+    }
+
+    size_t MultiFitter::
+    nbCapsules () const
+    {
+      return nbCapsules_;
+    }
+
+    size_t& MultiFitter::
+    maxCapsules ()
+    {
+      return maxCapsules_;
+    }
+
+    size_t MultiFitter::
+    maxCapsules () const
+    {
+      return maxCapsules_;
+    }
+
+    value_type& MultiFitter::
+    volumeRatio ()
+    {
+      return volumeRatio_;
+    }
+
+    value_type MultiFitter::
+    volumeRatio () const
+    {
+      return volumeRatio_;
+    }
+
+    size_t& MultiFitter::
+    nbRefinements ()
+    {
+      return nbRefinements_;
+    }
+
+    size_t MultiFitter::
+    nbRefinements () const
+    {
+      return nbRefinements_;
+    }
+
+    size_t& MultiFitter::
+    nbThreads ()
+    {
+      return nbThreads_;
+    }
+
+    size_t MultiFitter::
+    nbThreads () const
+    {
+      return nbThreads_;
+    }
+
+    FitterOptions& MultiFitter::
+    options ()
+    {
+      return options_;
+    }
+
+    const FitterOptions& MultiFitter::
+    options () const
+    {
+      return options_;
+    }
+
+    void MultiFitter::
+    computeBestFitCapsules ()
+    {
+      assert (polyhedron_.size () > 0 && "Empty polyhedron.");
+
+      BatchFitter batchFitter (solver_, nbThreads_);
+      batchFitter.options () = options_;
+
+      clusters_t clusters (1, cluster_t (polyhedron_.size ()));
+      for (size_t j = 0; j < polyhedron_.size (); ++j)
+	clusters[0][j] = j;
+
+      pieces_t pieces = fitClusters (polyhedron_, clusters, batchFitter);
+      singleVolume_ = pieces[0].volume;
+
+      const bool automatic = (nbCapsules_ == 0);
+      const size_t target = automatic ? maxCapsules_ : nbCapsules_;
+      while (clusters.size () < target)
+	{
+	  if (automatic
+	      && totalVolume (pieces) <= volumeRatio_ * singleVolume_)
+	    break;
+
+	  // Split the cluster with the largest capsule. There may be
+	  // fewer capsules than requested if the clusters are too small
+	  // to be split.
+	  size_t largest = clusters.size ();
+	  for (size_t i = 0; i < clusters.size (); ++i)
+	    if (clusters[i].size () >= 2 * minClusterPoints
+		&& (largest == clusters.size ()
+		    || pieces[i].volume > pieces[largest].volume))
+	      largest = i;
+	  if (largest == clusters.size ())
+	    break;
+
+	  clusters_t halves (2);
+	  splitCluster (polyhedron_, clusters[largest], halves[0], halves[1]);
+	  pieces_t halfPieces = fitClusters (polyhedron_, halves, batchFitter);
+	  if (automatic && halfPieces[0].volume + halfPieces[1].volume
+	      >= pieces[largest].volume)
+	    break;
+
+	  clusters[largest].swap (halves[0]);
+	  clusters.push_back (halves[1]);
+	  pieces[largest] = halfPieces[0];
+	  pieces.push_back (halfPieces[1]);
+
+	  refineClusters (polyhedron_, nbRefinements_, batchFitter,
+			  clusters, pieces);
+	}
+
+      solutionParams_.resize (pieces.size ());
+      for (size_t i = 0; i < pieces.size (); ++i)
+	solutionParams_[i] = pieces[i].param;
+      solutionVolume_ = totalVolume (pieces);
+
+      labels_.resize (polyhedron_.size ());
+      for (size_t i = 0; i < clusters.size (); ++i)
+	for (size_t j = 0; j < clusters[i].size (); ++j)
+	  labels_[clusters[i][j]] = i;
+    }
+
+    const std::vector<argument_t>& MultiFitter::
+    solutionParams () const
+    {
+      return solutionParams_;
+    }
+
+    std::vector<Capsule> MultiFitter::
+    capsules () const
+    {
+      std::vector<Capsule> capsules (solutionParams_.size ());
+      for (size_t i = 0; i < solutionParams_.size (); ++i)
+	convertSolverParamToCapsule (capsules[i].P0, capsules[i].P1,
+				     capsules[i].radius, solutionParams_[i]);
+      return capsules;
+    }
+
+    value_type MultiFitter::
+    solutionVolume () const
+    {
+      return solutionVolume_;
+    }
+
+    value_type MultiFitter::
+    singleVolume () const
+    {
+      return singleVolume_;
+    }
+
+    const std::vector<size_t>& MultiFitter::
+    labels () const
+    {
+      return labels_;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MULTI_FITTER_CC_
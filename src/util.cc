@@ -19,79 +19,454 @@
 #ifndef ROBOPTIM_CAPSULE_UTIL_CC_
 # define ROBOPTIM_CAPSULE_UTIL_CC_
 
+# include <algorithm>
 # include <iostream>
 # include <set>
 # include <limits>
-# include <cstdio>
 
+# include <boost/bind.hpp>
 # include <boost/foreach.hpp>
+# include <boost/thread/thread.hpp>
 
+# include <roboptim/capsule/geometry.hh>
 # include <roboptim/capsule/util.hh>
 
 namespace roboptim
 {
   namespace capsule
   {
-
-    polyhedron_t convexHullFromPoints (const std::vector<point_t>& points)
+    namespace
     {
-      polyhedron_t convexPolyhedron;
+      /// \brief Number of points processed at once by the streaming
+      /// loops.
+      ///
+      /// Blocks are small enough for their temporaries to live on the
+      /// stack, and large enough for Eigen to vectorize over them.
+      const size_type blockSize = 256;
+
+      /// \brief Stack-allocated block of points.
+      typedef Eigen::Matrix<value_type, 3, Eigen::Dynamic, 0, 3, blockSize>
+      pointBlock_t;
+
+      /// \brief Stack-allocated block of scalars, one per point.
+      typedef Eigen::Matrix<value_type, 1, Eigen::Dynamic, Eigen::RowMajor,
+			    1, blockSize> scalarBlock_t;
+
+      /// \brief Minimum number of points reduced by a thread.
+      ///
+      /// Below this size, spawning a thread costs more than it saves.
+      const size_type minPointsPerThread = 1 << 16;
+
+      /// \brief Accumulate the statistics of a chunk of points.
+      void accumulate (PointStatistics& statistics, const_points_ref points,
+		       size_type begin, size_type n)
+      {
+	statistics.addPoints (points.middleCols (begin, n));
+      }
+
+      /// \brief Extremes of a set of points with respect to a line.
+      ///
+      /// The projections on the line and the distances to the line are
+      /// computed together, so that the points are read once.
+      struct LineExtremes
+      {
+	LineExtremes (const point_t& linePoint, const vector3_t& dir)
+	  : linePoint (linePoint),
+	    dir (dir),
+	    minProjection (std::numeric_limits<value_type>::max ()),
+	    maxProjection (-std::numeric_limits<value_type>::max ()),
+	    maxDistance2 (-1.),
+	    imin (0),
+	    imax (0),
+	    iradius (0)
+	{}
+
+	/// \brief Merge the extremes of the following points.
+	///
+	/// Ties are resolved in favor of the first point, as in
+	/// extremePointsAlongDirection.
+	void merge (const LineExtremes& other)
+	{
+	  if (other.minProjection < minProjection)
+	    {
+	      minProjection = other.minProjection;
+	      imin = other.imin;
+	    }
+	  if (other.maxProjection > maxProjection)
+	    {
+	      maxProjection = other.maxProjection;
+	      imax = other.imax;
+	    }
+	  if (other.maxDistance2 > maxDistance2)
+	    {
+	      maxDistance2 = other.maxDistance2;
+	      iradius = other.iradius;
+	    }
+	}
 
-# ifdef HAVE_QHULL
-      int numpoints = static_cast<int> (points.size ());
-      int dim = 3;
+	/// \brief Largest distance from the points to the line.
+	value_type maxDistance () const
+	{
+	  return std::sqrt (std::max (maxDistance2, 0.)) / dir.norm ();
+	}
 
-      std::vector<value_type> rboxpoints (dim * numpoints);
-      size_t iter = 0;
+	point_t linePoint;
+	vector3_t dir;
+
+	/// \brief Extreme projections on the direction, and their points.
+	value_type minProjection, maxProjection;
+
+	/// \brief Largest squared norm of the cross product of the
+	/// direction with the vector from linePoint to a point.
+	value_type maxDistance2;
+
+	size_type imin, imax, iradius;
+      };
+
+      void accumulate (LineExtremes& extremes, const_points_ref points,
+		       size_type begin, size_type n)
+      {
+	// The distance to the line is the norm of the cross product of
+	// the direction with the vector from linePoint, as in
+	// distancePointToLine. It is computed row-wise over each block.
+	const vector3_t& dir = extremes.dir;
+	pointBlock_t centered;
+	scalarBlock_t projections;
+	scalarBlock_t distances2;
+	for (size_type j = begin; j < begin + n; j += blockSize)
+	  {
+	    size_type m = std::min (blockSize, begin + n - j);
+	    centered.noalias () = points.middleCols (j, m).colwise ()
+	      - extremes.linePoint;
+	    projections.noalias () = dir.transpose () * centered;
+	    distances2 = (dir[1] * centered.row (2)
+			  - dir[2] * centered.row (1)).cwiseAbs2 ();
+	    distances2 += (dir[2] * centered.row (0)
+			   - dir[0] * centered.row (2)).cwiseAbs2 ();
+	    distances2 += (dir[0] * centered.row (1)
+			   - dir[1] * centered.row (0)).cwiseAbs2 ();
+
+	    LineExtremes block (extremes.linePoint, dir);
+	    size_type i;
+	    block.minProjection = projections.minCoeff (&i);
+	    block.imin = j + i;
+	    block.maxProjection = projections.maxCoeff (&i);
+	    block.imax = j + i;
+	    block.maxDistance2 = distances2.maxCoeff (&i);
+	    block.iradius = j + i;
+	    extremes.merge (block);
+	  }
+      }
 
-      for (std::vector<point_t>::const_iterator
-	     point = points.begin (); point != points.end (); ++point)
+      /// \brief How far the end points of a capsule have to move along
+      /// its axis to contain the points near its end caps.
+      struct CapOffsets
+      {
+	/// \param center point of the axis.
+	/// \param dir unit direction of the axis.
+	/// \param endDistance distance from center to the end points
+	/// before they move.
+	/// \param radius radius of the capsule.
+	CapOffsets (const point_t& center, const vector3_t& dir,
+		    value_type endDistance, value_type radius)
+	  : center (center),
+	    dir (dir),
+	    endDistance (endDistance),
+	    radius (radius),
+	    start (0.),
+	    end (0.)
+	{}
+
+	void merge (const CapOffsets& other)
 	{
-	  rboxpoints[iter++] = (*point)[0];
-	  rboxpoints[iter++] = (*point)[1];
-	  rboxpoints[iter++] = (*point)[2];
+	  start = std::max (start, other.start);
+	  end = std::max (end, other.end);
 	}
 
-      // Compute the convex hull with qhull
-      char flags[25];
-      sprintf (flags, "qhull Qc Qt Qi");
-      // Note: using stderr instead of NULL to avoid a bug in older versions of
-      // qhull:
-      // > QH6232 Qhull internal error (userprintf.c): fp is 0.  Wrong
-      // > qh_fprintf called.
-      int exitcode = qh_new_qhull (dim, numpoints,
-				   rboxpoints.data (), 0,
-				   flags, NULL, stderr);
-
-      if (exitcode != 0)
+	point_t center;
+	vector3_t dir;
+	value_type endDistance;
+	value_type radius;
+
+	/// \brief Offsets of the start and end points.
+	value_type start, end;
+      };
+
+      void accumulate (CapOffsets& offsets, const_points_ref points,
+		       size_type begin, size_type n)
+      {
+	// A point at abscissa t along the axis and at distance h from it
+	// is contained in the sphere of the end point at abscissa e if
+	// |t - e| <= sqrt (r^2 - h^2). The end point moves by the largest
+	// excess over the points near its cap.
+	const vector3_t& dir = offsets.dir;
+	const value_type r2 = offsets.radius * offsets.radius;
+	const value_type inf = std::numeric_limits<value_type>::infinity ();
+	pointBlock_t centered;
+	scalarBlock_t t;
+	scalarBlock_t h2;
+	scalarBlock_t slack;
+	scalarBlock_t excess;
+	for (size_type j = begin; j < begin + n; j += blockSize)
+	  {
+	    size_type m = std::min (blockSize, begin + n - j);
+	    centered.noalias () = points.middleCols (j, m).colwise ()
+	      - offsets.center;
+	    t.noalias () = dir.transpose () * centered;
+	    h2 = (dir[1] * centered.row (2)
+		  - dir[2] * centered.row (1)).cwiseAbs2 ();
+	    h2 += (dir[2] * centered.row (0)
+		   - dir[0] * centered.row (2)).cwiseAbs2 ();
+	    h2 += (dir[0] * centered.row (1)
+		   - dir[1] * centered.row (0)).cwiseAbs2 ();
+	    slack = (r2 - h2.array ()).max (0.).sqrt ().matrix ();
+
+	    // Points near the start boundary
+	    excess = (-t.array () > offsets.endDistance)
+	      .select (-t.array () - offsets.endDistance - slack.array (),
+		       -inf)
+	      .matrix ();
+	    offsets.start = std::max (offsets.start, excess.maxCoeff ());
+
+	    // Else points near the end boundary
+	    excess = (-t.array () <= offsets.endDistance
+		      && t.array () > offsets.endDistance)
+	      .select (t.array () - offsets.endDistance - slack.array (), -inf)
+	      .matrix ();
+	    offsets.end = std::max (offsets.end, excess.maxCoeff ());
+	  }
+      }
+
+      template <typename R>
+      struct ChunkReduction
+      {
+	static void run (R* partial, const const_points_ref* points,
+			 size_type begin, size_type n)
 	{
-	  // Return empty polyhedron
-	  return convexPolyhedron;
+	  accumulate (*partial, *points, begin, n);
 	}
+      };
+
+      /// \brief Reduce a set of points with several threads.
+      ///
+      /// Points are split in contiguous chunks, one per thread, and the
+      /// partial results are merged in order.
+      ///
+      /// \param init result for an empty set of points.
+      /// \param nbThreads maximum number of threads, 0 for the number
+      /// of hardware threads.
+      template <typename R>
+      R parallelReduce (const_points_ref points, const R& init,
+			size_t nbThreads)
+      {
+	if (nbThreads == 0)
+	  // hardware_concurrency may return 0 if the information is
+	  // not available.
+	  nbThreads = std::max<size_t>
+	    (1, boost::thread::hardware_concurrency ());
+	nbThreads = std::max<size_t>
+	  (1, std::min<size_t> (nbThreads, static_cast<size_t>
+				(points.cols () / minPointsPerThread)));
+
+	R result = init;
+	if (nbThreads == 1)
+	  {
+	    accumulate (result, points, 0, points.cols ());
+	    return result;
+	  }
 
-      // Get the list of points
-      convexPolyhedron.clear ();
-      vertexT* vertex = qh vertex_list;
+	// Chunks are aligned on blocks.
+	size_type chunkSize = (points.cols () / static_cast<size_type>
+			       (nbThreads) + blockSize - 1)
+	  / blockSize * blockSize;
+
+	std::vector<R> partials (nbThreads, init);
+	boost::thread_group threads;
+	for (size_t k = 0; k < nbThreads; ++k)
+	  {
+	    size_type begin = static_cast<size_type> (k) * chunkSize;
+	    size_type end = (k + 1 == nbThreads) ? points.cols ()
+	      : std::min (begin + chunkSize, points.cols ());
+	    if (begin < end)
+	      threads.create_thread (boost::bind (&ChunkReduction<R>::run,
+						  &partials[k], &points,
+						  begin, end - begin));
+	  }
+	threads.join_all ();
 
-      // TODO: find how to get the number of vertices on the convex
-      // hull with qhull.
+	for (size_t k = 0; k < nbThreads; ++k)
+	  result.merge (partials[k]);
+	return result;
+      }
 
-      FORALLvertices {
-	// qh_pointid (vertex->point) is the point id of the vertex
-	//int id = qh_pointid (vertex->point);
-	// vertex->point is the coordinates of the vertex
-	convexPolyhedron.push_back(point_t (vertex->point[0],
-					    vertex->point[1],
-					    vertex->point[2]));
+      /// \brief Direction of largest spread, given the covariance
+      /// matrix.
+      vector3_t principalAxis (const Eigen::Matrix3d& covariance)
+      {
+	// Compute eigenvectors and eigenvalues
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
+	es.compute (covariance,Eigen::ComputeEigenvectors);
+
+	Eigen::Matrix3d eigenVectors = es.eigenvectors ();
+	Eigen::Matrix3d eigenValues = es.eigenvalues ().asDiagonal ();
+
+	// Find the largest eigenvalue and the corresponding direction
+	// (largest spread)
+	unsigned maxc, minc;
+	maxc = minc = 0;
+	value_type absev, maxev, minev;
+	maxev = minev = std::fabs (eigenValues (0,0));
+
+	if ((absev = std::fabs (eigenValues (1,1))) > maxev)
+	  {
+	    maxc = 1;
+	    maxev = absev;
+	  }
+	else
+	  {
+	    minc = 1;
+	    minev = absev;
+	  }
+
+	if ((absev = std::fabs (eigenValues (2,2))) > maxev)
+	  {
+	    maxc = 2;
+	    maxev = absev;
+	  }
+	else if (minev > absev)
+	  {
+	    minc = 2;
+	    minev = absev;
+	  }
+
+	vector3_t dirLargestSpread = eigenVectors.col (maxc);
+	dirLargestSpread.normalize ();
+
+	return dirLargestSpread;
       }
+    } // end of anonymous namespace.
+
+    Eigen::Map<const points_t> pointsMap (const polyhedron_t& polyhedron)
+    {
+      return pointsMap (polyhedron.empty () ? 0 : polyhedron[0].data (),
+			static_cast<size_type> (polyhedron.size ()));
+    }
+
+
+    Eigen::Map<const points_t> pointsMap (const value_type* data,
+					  size_type nbPoints)
+    {
+      return Eigen::Map<const points_t> (data, 3, nbPoints);
+    }
+
+
+    PointStatistics::PointStatistics ()
+      : count_ (0),
+	mean_ (point_t::Zero ()),
+	scatter_ (Eigen::Matrix3d::Zero ()),
+	lower_ (point_t::Constant (std::numeric_limits<value_type>::max ())),
+	upper_ (point_t::Constant (-std::numeric_limits<value_type>::max ()))
+    {
+    }
+
+
+    void PointStatistics::add (const point_t& point)
+    {
+      // Welford update
+      ++count_;
+      vector3_t delta = point - mean_;
+      mean_ += delta / static_cast<value_type> (count_);
+      scatter_.noalias () += delta * (point - mean_).transpose ();
+
+      lower_ = lower_.cwiseMin (point);
+      upper_ = upper_.cwiseMax (point);
+    }
 
-      qh_freeqhull (!qh_ALL);
-# else
-      std::cerr << "Qhull not found, cannot compute the convex hull."
-		<< std::endl;
-# endif //! HAVE_QHULL
-      // Return the convex hull as a polyhedron
-      return convexPolyhedron;
+
+    void PointStatistics::addPoints (const_points_ref points)
+    {
+      // The statistics of each block are computed around the block
+      // mean, and merged with the running statistics.
+      pointBlock_t centered;
+      for (size_type j = 0; j < points.cols (); j += blockSize)
+	{
+	  size_type n = std::min (blockSize, points.cols () - j);
+
+	  PointStatistics block;
+	  block.count_ = n;
+	  block.mean_ = points.middleCols (j, n).rowwise ().sum ()
+	    / static_cast<value_type> (n);
+	  centered.noalias () = points.middleCols (j, n).colwise ()
+	    - block.mean_;
+	  block.scatter_.noalias () = centered * centered.transpose ();
+	  block.lower_ = points.middleCols (j, n).rowwise ().minCoeff ();
+	  block.upper_ = points.middleCols (j, n).rowwise ().maxCoeff ();
+
+	  merge (block);
+	}
+    }
+
+
+    void PointStatistics::merge (const PointStatistics& other)
+    {
+      if (other.count_ == 0)
+	return;
+      if (count_ == 0)
+	{
+	  *this = other;
+	  return;
+	}
+
+      // Pairwise update (Chan et al.)
+      value_type na = static_cast<value_type> (count_);
+      value_type nb = static_cast<value_type> (other.count_);
+      value_type n = na + nb;
+      vector3_t delta = other.mean_ - mean_;
+
+      count_ += other.count_;
+      mean_ += delta * (nb / n);
+      scatter_ += other.scatter_;
+      scatter_.noalias () += (na * nb / n) * delta * delta.transpose ();
+
+      lower_ = lower_.cwiseMin (other.lower_);
+      upper_ = upper_.cwiseMax (other.upper_);
+    }
+
+
+    size_type PointStatistics::count () const
+    {
+      return count_;
+    }
+
+
+    const point_t& PointStatistics::mean () const
+    {
+      return mean_;
+    }
+
+
+    Eigen::Matrix3d PointStatistics::covariance () const
+    {
+      return scatter_ / static_cast<value_type> (count_);
+    }
+
+
+    const point_t& PointStatistics::lower () const
+    {
+      return lower_;
+    }
+
+
+    const point_t& PointStatistics::upper () const
+    {
+      return upper_;
+    }
+
+
+    PointStatistics pointStatistics (const_points_ref points,
+				     size_t nbThreads)
+    {
+      return parallelReduce (points, PointStatistics (), nbThreads);
     }
 
 
@@ -99,12 +474,7 @@ namespace roboptim
                                        const point_t& a,
                                        const point_t& b)
     {
-      value_type d_ab = (b-a).norm ();
-
-      // If the segment is a point, i.e. a = b
-      if (d_ab < 1e-6) return (a-p).norm ();
-
-      return (p - projectionOnSegment (p, a, b)).norm ();
+      return Geometry::distancePointToSegment (p, a, b);
     }
 
 
@@ -112,16 +482,106 @@ namespace roboptim
                                  const point_t& a,
                                  const point_t& b)
     {
-      value_type d_ab = (b-a).norm ();
+      return Geometry::projectionOnSegment (p, a, b);
+    }
+
+
+    void distancesPointsToSegment (const_points_ref points,
+                                   const point_t& a,
+                                   const point_t& b,
+                                   Eigen::Ref<vector_t> distances)
+    {
+      Geometry::distancesPointsToSegment (points, a, b, distances);
+    }
+
+
+    void projectionsOnSegment (const_points_ref points,
+                               const point_t& a,
+                               const point_t& b,
+                               Eigen::Ref<points_t> projections)
+    {
+      Geometry::projectionsOnSegment (points, a, b, projections);
+    }
+
+
+    void projectionParametersOnSegment (const_points_ref points,
+                                        const point_t& a,
+                                        const point_t& b,
+                                        Eigen::Ref<vector_t> lambdas)
+    {
+      Geometry::projectionParametersOnSegment (points, a, b, lambdas);
+    }
+
+
+    void distancesPointToSegments (const point_t& p,
+                                   const_points_ref starts,
+                                   const_points_ref ends,
+                                   Eigen::Ref<vector_t> distances)
+    {
+      Geometry::distancesPointToSegments (p, starts, ends, distances);
+    }
+
+
+    value_type projectionParameterOnSegment (const point_t& p,
+                                             const point_t& a,
+                                             const point_t& b)
+    {
+      return Geometry::projectionParameterOnSegment (p, a, b);
+    }
+
+
+    void distancePointToSegmentDerivatives (const point_t& p,
+                                            const point_t& a,
+                                            const point_t& b,
+                                            vector6_t& gradient,
+                                            matrix6_t& hessian)
+    {
+      gradient.setZero ();
+      hessian.setZero ();
+
+      vector3_t u = b - a;
+      value_type lambda = projectionParameterOnSegment (p, a, b);
+
+      // Vector from the closest point on the segment to p.
+      vector3_t r = p - a - lambda * u;
+      value_type distance = r.norm ();
+
+      // The distance is not differentiable on the segment.
+      if (distance <= 0.) return;
+
+      // Let phi = 1/2 min_lambda |p - (1 - lambda) a - lambda b|^2.
+      // Its hessian with lambda fixed is C^T C with
+      // C = [(1 - lambda) I, lambda I].
+      matrix6_t phiHessian;
+      phiHessian.block<3,3> (0,0)
+	= (1. - lambda) * (1. - lambda) * Eigen::Matrix3d::Identity ();
+      phiHessian.block<3,3> (0,3)
+	= (1. - lambda) * lambda * Eigen::Matrix3d::Identity ();
+      phiHessian.block<3,3> (3,0) = phiHessian.block<3,3> (0,3);
+      phiHessian.block<3,3> (3,3)
+	= lambda * lambda * Eigen::Matrix3d::Identity ();
+
+      // In the interior of the segment, lambda depends on (a,b): the
+      // hessian of the minimum value gets the Schur complement term
+      // -F_xl F_xl^T / F_ll, where F_ll = |u|^2 and F_xl is the
+      // derivative of dF/dlambda with respect to (a,b).
+      value_type u2 = u.squaredNorm ();
+      if (lambda > 0. && lambda < 1. && u2 >= 1e-12)
+	{
+	  vector6_t crossTerm;
+	  crossTerm.segment<3> (0) = (1. - lambda) * u + r;
+	  crossTerm.segment<3> (3) = lambda * u - r;
+	  phiHessian -= crossTerm * crossTerm.transpose () / u2;
+	}
 
-      // If the segment is a point, i.e. a = b
-      if (d_ab < 1e-6) return a;
+      // Gradient of the distance: grad(phi) / distance.
+      vector3_t unit = -r / distance;
+      gradient.segment<3> (0) = (1. - lambda) * unit;
+      gradient.segment<3> (3) = lambda * unit;
 
-      // We note q the projection of p on the line (a,b)
-      value_type d_aq = (p-a).dot (b-a)/d_ab;
-      if (d_aq > d_ab) return b;
-      else if (d_aq < 0.) return a;
-      else return a + d_aq * (b-a).normalized ();
+      // Since phi = distance^2 / 2:
+      // hess(distance) = (hess(phi) - grad(d) grad(d)^T) / distance.
+      hessian = (phiHessian - gradient * gradient.transpose ()) / distance;
     }
 
 
@@ -136,41 +596,13 @@ namespace roboptim
 
     Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points)
     {
-      value_type oon = 1.0 / (value_type)points.size();
-      point_t c(0., 0., 0.);
-      value_type e00, e11, e22, e01, e02, e12;
-
-      // compute the center of mass of the points
-      for (size_t i = 0; i < points.size (); ++i)
-	c += points[i];
-      c *= oon;
-
-      // compute covariance elements
-      e00 = e11 = e22 = e01 = e02 = e12 = 0.0;
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  // translate points so center of mass is at origin
-	  point_t p = points[i] - c;
-	  // compute covariance of translated points
-	  e00 += p[0] * p[0];
-	  e11 += p[1] * p[1];
-	  e22 += p[2] * p[2];
-	  e01 += p[0] * p[1];
-	  e02 += p[0] * p[2];
-	  e12 += p[1] * p[2];
-        }
-
-      // fill in the covariance matrix elements
-      Eigen::Matrix3d cov;
+      return covarianceMatrix (pointsMap (points));
+    }
 
-      cov (0,0) = e00 * oon;
-      cov (1,1) = e11 * oon;
-      cov (2,2) = e22 * oon;
-      cov (0,1) = cov (1,0) = e01 * oon;
-      cov (0,2) = cov (2,0) = e02 * oon;
-      cov (1,2) = cov (2,1) = e12 * oon;
 
-      return cov;
+    Eigen::Matrix3d covarianceMatrix (const_points_ref points)
+    {
+      return pointStatistics (points).covariance ();
     }
 
 
@@ -180,102 +612,108 @@ namespace roboptim
 				      const std::vector<point_t>& points,
 				      int& imin, int& imax)
     {
-      double minproj = std::numeric_limits<double>::max ();
-      double maxproj = -minproj;
-
-      for (size_t i = 0; i < points.size(); ++i)
-        {
-	  // Project vector from origin to point onto direction vector
-	  double proj = points[i].dot (dir);
-	  // Keep track of least distant point along direction vector
-	  if (proj < minproj) {
-	    minproj = proj;
-	    imin = static_cast<int> (i);
-	  }
-	  // Keep track of most distant point along direction vector
-	  if (proj > maxproj) {
-	    maxproj = proj;
-	    imax = static_cast<int> (i);
-	  }
-        }
+      extremePointsAlongDirection (dir, pointsMap (points), imin, imax);
+    }
+
+
+    void extremePointsAlongDirection (const vector3_t& dir,
+				      const_points_ref points,
+				      int& imin, int& imax)
+    {
+      Geometry::extremePointsAlongDirection (dir, points, imin, imax);
+    }
+
+
+    vector3_t largestSpreadDirection (const std::vector<point_t>& points)
+    {
+      return largestSpreadDirection (pointsMap (points));
+    }
+
+
+    vector3_t largestSpreadDirection (const_points_ref points)
+    {
+      assert (points.cols () > 0
+              && "Cannot compute the spread of an empty polyhedron.");
+
+      return principalAxis (covarianceMatrix (points));
+    }
+
+
+    void activeSetSeed (const std::vector<point_t>& points,
+			std::vector<size_t>& indices)
+    {
+      activeSetSeed (pointsMap (points), indices);
+    }
+
+
+    void activeSetSeed (const_points_ref points,
+			std::vector<size_t>& indices)
+    {
+      assert (points.cols () > 0
+              && "Cannot select points of an empty polyhedron.");
+
+      indices.clear ();
+
+      // Extreme points along the capsule axis (largest spread
+      // direction), as used in capsuleFromPoints.
+      PointStatistics statistics = pointStatistics (points);
+      vector3_t axis = principalAxis (statistics.covariance ());
+      LineExtremes extremes = parallelReduce
+	(points, LineExtremes (statistics.mean (), axis), 0);
+      indices.push_back (static_cast<size_t> (extremes.imin));
+      indices.push_back (static_cast<size_t> (extremes.imax));
+
+      // Radial extremes: the point furthest from the axis, and the
+      // extreme points along two directions orthogonal to the axis.
+      indices.push_back (static_cast<size_t> (extremes.iradius));
+
+      vector3_t normal = axis.unitOrthogonal ();
+      vector3_t binormal = axis.cross (normal);
+      int imin = 0;
+      int imax = 0;
+      extremePointsAlongDirection (normal, points, imin, imax);
+      indices.push_back (static_cast<size_t> (imin));
+      indices.push_back (static_cast<size_t> (imax));
+      extremePointsAlongDirection (binormal, points, imin, imax);
+      indices.push_back (static_cast<size_t> (imin));
+      indices.push_back (static_cast<size_t> (imax));
+
+      // Remove duplicate indices.
+      std::sort (indices.begin (), indices.end ());
+      indices.erase (std::unique (indices.begin (), indices.end ()),
+		     indices.end ());
     }
 
 
     Capsule capsuleFromPoints (const std::vector<point_t>& points)
     {
-      assert (points.size () > 0
+      return capsuleFromPoints (pointsMap (points));
+    }
+
+
+    Capsule capsuleFromPoints (const_points_ref points)
+    {
+      assert (points.cols () > 0
               && "Cannot compute capsule for empty polyhedron.");
 
-      // Create the covariance matrix for PCA
-      Eigen::Matrix3d covariance = covarianceMatrix (points);
-
-      // Compute eigenvectors and eigenvalues
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
-      es.compute (covariance,Eigen::ComputeEigenvectors);
-
-      Eigen::Matrix3d eigenVectors = es.eigenvectors ();
-      Eigen::Matrix3d eigenValues = es.eigenvalues ().asDiagonal ();
-
-      // Find the largest eigenvalue and the corresponding direction
-      // (largest spread)
-      unsigned maxc, minc;
-      maxc = minc = 0;
-      value_type absev, maxev, minev;
-      maxev = minev = std::fabs (eigenValues (0,0));
-
-      if ((absev = std::fabs (eigenValues (1,1))) > maxev)
-        {
-	  maxc = 1;
-	  maxev = absev;
-        }
-      else
-        {
-	  minc = 1;
-	  minev = absev;
-        }
-
-      if ((absev = std::fabs (eigenValues (2,2))) > maxev)
-        {
-	  maxc = 2;
-	  maxev = absev;
-        }
-      else if (minev > absev)
-        {
-	  minc = 2;
-	  minev = absev;
-        }
-
-      vector3_t dirLargestSpread = eigenVectors.col (maxc);
-      dirLargestSpread.normalize ();
-
-      // Find the most extreme points along the largest spread direction.
-      // Those points will help to find the length of the capsule.
-      int iminLargestSpread = 0;
-      int imaxLargestSpread = 0;
-      extremePointsAlongDirection (dirLargestSpread, points,
-                                   iminLargestSpread, imaxLargestSpread);
-      point_t minptLargestSpread = points[iminLargestSpread];
-      point_t maxptLargestSpread = points[imaxLargestSpread];
-
-      // Compute the start point
+      // Find the direction of largest spread with a PCA. The average
+      // point is computed in the same pass.
+      PointStatistics statistics = pointStatistics (points);
+      vector3_t dirLargestSpread = principalAxis (statistics.covariance ());
+
       // The cylinder axis will be (average point, largest spread direction).
       // However, a better point could be found with a more complicated
       // algorithm, thus reducing the volume of the capsule.
-      point_t average (0., 0., 0.);
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  average += points[i];
-        }
-      average /= static_cast<value_type> (points.size ());
-
-      // Find the correct radius for the capsule.
-      value_type radius = 0;
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  value_type dist = distancePointToLine
-	    (points[i], average, dirLargestSpread);
-	  if (dist > radius) radius = dist;
-        }
+      point_t average = statistics.mean ();
+
+      // Find the most extreme points along the largest spread direction,
+      // which will help to find the length of the capsule, and the
+      // correct radius for the capsule.
+      LineExtremes extremes = parallelReduce
+	(points, LineExtremes (average, dirLargestSpread), 0);
+      point_t minptLargestSpread = points.col (extremes.imin);
+      point_t maxptLargestSpread = points.col (extremes.imax);
+      value_type radius = extremes.maxDistance ();
 
       // Find the correct length for the capsule (cylinder part)
       value_type length = (maxptLargestSpread - minptLargestSpread).norm ();
@@ -289,56 +727,15 @@ namespace roboptim
       // Optimization of the volume
       // - We determine the points located at
       //   both extremities (+/-)(0.5 * length - radius)
-      // - For all of those points, we look for the start/endpoint position
-      //   that will minimize the capsule volume.
-      std::vector<point_t> nearStartPoints;
-      std::vector<point_t> nearEndPoints;
-      point_t start = center - (0.5 * length - radius) * dirLargestSpread;
-      point_t end = center + (0.5 * length - radius) * dirLargestSpread;
-
-      for(size_t i = 0; i < points.size (); ++i)
-        {
-	  // if located near the start boundary
-	  value_type dirDist = dirLargestSpread.dot (points[i] - center);
-	  if (-dirDist >  0.5 * length - radius)
-	    nearStartPoints.push_back(points[i]);
-	  // else if located near the end boundary
-	  else if (dirDist > 0.5 * length - radius)
-	    nearEndPoints.push_back(points[i]);
-        }
-
-      // we move the position of the start point to include all points in its
-      // vicinity
-      for (size_t i = 0; i < nearStartPoints.size (); ++i)
-        {
-	  if ((nearStartPoints[i] - start).norm () > radius)
-            {
-	      // using pythagore theorem
-	      value_type h = distancePointToLine (nearStartPoints[i],
-						  center, dirLargestSpread);
-	      value_type l = (nearStartPoints[i] - start)
-		.dot (-dirLargestSpread);
-	      if (l - sqrt(radius * radius - h * h) > 0)
-		start -= (l - sqrt(radius * radius - h * h))
-		  * dirLargestSpread;
-            }
-        }
-
-      // we move the position of the end point to include all points in its
-      // vicinity
-      for (size_t i = 0; i < nearEndPoints.size (); ++i)
-        {
-	  if ((nearEndPoints[i] - end).norm () > radius)
-            {
-	      // using pythagore theorem
-	      value_type l = (nearEndPoints[i] - end).dot (dirLargestSpread);
-	      value_type h = distancePointToLine (nearEndPoints[i],
-						  center, dirLargestSpread);
-	      if (l - std::sqrt (radius * radius - h * h) > 0)
-		end += (l - std::sqrt (radius * radius - h * h))
-		  * dirLargestSpread;
-            }
-        }
+      // - We move the start/end points just enough for their spheres
+      //   to include all of those points.
+      CapOffsets offsets = parallelReduce
+	(points, CapOffsets (center, dirLargestSpread,
+			     0.5 * length - radius, radius), 0);
+      point_t start = center - (0.5 * length - radius + offsets.start)
+	* dirLargestSpread;
+      point_t end = center + (0.5 * length - radius + offsets.end)
+	* dirLargestSpread;
 
       Capsule capsule;
       capsule.P0 = start;
@@ -392,14 +789,46 @@ namespace roboptim
       assert (polyhedrons.size () !=0 && "Empty polyhedron vector.");
       assert (polyhedron.size () == 0 && "Union polyhedron must be empty.");
 
-      BOOST_FOREACH (polyhedron_t poly, polyhedrons)
+      size_t nbPoints = 0;
+      BOOST_FOREACH (const polyhedron_t& poly, polyhedrons)
+	nbPoints += poly.size ();
+
+      polyhedron.reserve (nbPoints);
+      BOOST_FOREACH (const polyhedron_t& poly, polyhedrons)
+	polyhedron.insert (polyhedron.end (), poly.begin (), poly.end ());
+    }
+
+
+    void
+    convertPolyhedronVectorToPoints (points_t& points,
+				     const polyhedrons_t& polyhedrons)
+    {
+      size_type nbPoints = 0;
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	nbPoints += static_cast<size_type> (polyhedron.size ());
+
+      points.resize (3, nbPoints);
+      size_type k = 0;
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
 	{
-	  BOOST_FOREACH (point_t point, poly)
-	    polyhedron.push_back (point);
+	  size_type n = static_cast<size_type> (polyhedron.size ());
+	  points.middleCols (k, n) = pointsMap (polyhedron);
+	  k += n;
 	}
     }
 
 
+    void
+    convertPointsToPolyhedron (polyhedron_t& polyhedron,
+			       const_points_ref points)
+    {
+      polyhedron.resize (static_cast<size_t> (points.cols ()));
+      if (points.cols () > 0)
+	Eigen::Map<points_t> (polyhedron[0].data (), 3, points.cols ())
+	  = points;
+    }
+
+
     void
     computeBoundingCapsulePolyhedron (const polyhedrons_t& polyhedrons,
 				      point_t& endPoint1,
@@ -408,23 +837,27 @@ namespace roboptim
     {
       assert (polyhedrons.size () !=0 && "Empty polyhedron vector.");
 
-      // Retrieve vector of points from polyhedrons.
-      size_type nbPoints = 0;
-      BOOST_FOREACH (polyhedron_t polyhedron, polyhedrons)
+      // A single polyhedron is read in place, otherwise the points are
+      // gathered once.
+      if (polyhedrons.size () == 1)
 	{
-          nbPoints += polyhedron.size ();
+	  computeBoundingCapsulePolyhedron (pointsMap (polyhedrons[0]),
+					    endPoint1, endPoint2, radius);
+	  return;
 	}
 
-      std::vector<point_t> points (nbPoints);
-      size_type k = 0;
-      BOOST_FOREACH (polyhedron_t polyhedron, polyhedrons)
-	{
-	  BOOST_FOREACH (point_t point, polyhedron)
-	    {
-	      points[k++] = point;
-	    }
-	}
+      points_t points;
+      convertPolyhedronVectorToPoints (points, polyhedrons);
+      computeBoundingCapsulePolyhedron (points, endPoint1, endPoint2, radius);
+    }
+
 
+    void
+    computeBoundingCapsulePolyhedron (const_points_ref points,
+				      point_t& endPoint1,
+				      point_t& endPoint2,
+				      value_type& radius)
+    {
       // Compute bounding capsule of points.
       Capsule capsule = capsuleFromPoints (points);
 
@@ -33,22 +33,48 @@ namespace roboptim
 {
   namespace capsule
   {
+    namespace
+    {
+      /// \brief Prepare a dense hessian for filling.
+      void initHessian (Eigen::Ref<GenericFunctionTraits
+			<EigenMatrixDense>::matrix_t> hessian)
+      {
+	hessian.setZero ();
+      }
+
+      /// \brief Prepare a sparse hessian for filling: all its 49
+      /// entries are written. The structure of a hessian filled by a
+      /// previous evaluation is kept, so that it is refilled without
+      /// allocation.
+      void initHessian (GenericFunctionTraits
+			<EigenMatrixSparse>::matrix_t& hessian)
+      {
+	if (hessian.isCompressed () && hessian.nonZeros () == 49)
+	  Eigen::Map<vector_t> (hessian.valuePtr (), 49).setZero ();
+	else
+	  hessian.setZero ();
+      }
+    } // end of anonymous namespace.
+
     // -------------------PUBLIC FUNCTIONS-----------------------
 
-    Volume::
-    Volume (std::string name)
-      : roboptim::DifferentiableFunction (7, 1, name)
+    template <typename T>
+    GenericVolume<T>::
+    GenericVolume (std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T> (7, 1, name)
     {
     }
 
-    Volume::
-    ~Volume ()
+    template <typename T>
+    GenericVolume<T>::
+    ~GenericVolume ()
     {
     }
 
     // -------------------PROTECTED FUNCTIONS--------------------
 
-    void Volume::
+    template <typename T>
+    void GenericVolume<T>::
     impl_compute (result_ref result, const_argument_ref argument) const
     {
       assert (argument.size () == 7 && "Wrong argument size, expected 7.");
@@ -69,7 +95,8 @@ namespace roboptim
       return;
     }
 
-    void Volume::
+    template <typename T>
+    void GenericVolume<T>::
     impl_gradient (gradient_ref gradient,
 		   const_argument_ref argument,
 		   size_type functionId) const
@@ -86,30 +113,88 @@ namespace roboptim
 				+ (argument[2] - argument[5])
 				* (argument[2] - argument[5]));
 
-      gradient[0] = 1 / length * (argument[0] - argument[3])
+      // Use coeffRef so that the same code fills dense and sparse
+      // gradients.
+      gradient.coeffRef (0) = 1 / length * (argument[0] - argument[3])
       	* M_PI * argument[6] * argument[6];
 
-      gradient[1] = 1 / length * (argument[1] - argument[4])
+      gradient.coeffRef (1) = 1 / length * (argument[1] - argument[4])
 	* M_PI * argument[6] * argument[6];
 
-      gradient[2] = 1 / length * (argument[2] - argument[5])
+      gradient.coeffRef (2) = 1 / length * (argument[2] - argument[5])
 	* M_PI * argument[6] * argument[6];
 
-      gradient[3] = 1 / length * (argument[3] - argument[0])
+      gradient.coeffRef (3) = 1 / length * (argument[3] - argument[0])
 	* M_PI * argument[6] * argument[6];
 
-      gradient[4] = 1 / length * (argument[4] - argument[1])
+      gradient.coeffRef (4) = 1 / length * (argument[4] - argument[1])
 	* M_PI * argument[6] * argument[6];
 
-      gradient[5] = 1 / length * (argument[5] - argument[2])
+      gradient.coeffRef (5) = 1 / length * (argument[5] - argument[2])
 	* M_PI * argument[6] * argument[6];
 
-      gradient[6] = length * 2 * M_PI * argument[6]
+      gradient.coeffRef (6) = length * 2 * M_PI * argument[6]
       	+ 4 * M_PI * argument[6] * argument[6];
 
       return;
     }
 
+    template <typename T>
+    void GenericVolume<T>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == 7 &&  "Wrong argument size, expected 7.");
+
+      initHessian (hessian);
+
+      Eigen::Matrix<value_type, 3, 1> axis
+	= argument.template segment<3> (0) - argument.template segment<3> (3);
+      value_type length = axis.norm ();
+      value_type radius = argument[6];
+
+      matrix7_t h;
+      h.setZero ();
+
+      // The derivatives with respect to the end points are not defined
+      // for a degenerate segment.
+      if (length > 0.)
+	{
+	  // Hessian of the segment length with respect to the first end
+	  // point, scaled by the cylinder section.
+	  Eigen::Matrix<value_type, 3, 3> endPointsBlock
+	    = M_PI * radius * radius / length
+	    * (Eigen::Matrix<value_type, 3, 3>::Identity ()
+	       - axis * axis.transpose () / (length * length));
+	  h.template block<3,3> (0,0) = endPointsBlock;
+	  h.template block<3,3> (0,3) = -endPointsBlock;
+	  h.template block<3,3> (3,0) = -endPointsBlock;
+	  h.template block<3,3> (3,3) = endPointsBlock;
+
+	  // Cross derivatives with the radius.
+	  Eigen::Matrix<value_type, 3, 1> radiusBlock
+	    = 2 * M_PI * radius / length * axis;
+	  h.template block<3,1> (0,6) = radiusBlock;
+	  h.template block<3,1> (3,6) = -radiusBlock;
+	  h.template block<1,3> (6,0) = radiusBlock.transpose ();
+	  h.template block<1,3> (6,3) = -radiusBlock.transpose ();
+	}
+
+      h (6,6) = 2 * M_PI * length + 8 * M_PI * radius;
+
+      // Use coeffRef so that the same code fills dense and sparse
+      // hessians.
+      for (size_type i = 0; i < 7; ++i)
+	for (size_type j = 0; j < 7; ++j)
+	  hessian.coeffRef (i, j) = h (i, j);
+    }
+
+    // Explicit instantiations.
+    template class GenericVolume<roboptim::EigenMatrixDense>;
+    template class GenericVolume<roboptim::EigenMatrixSparse>;
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
@@ -0,0 +1,48 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/wall-time.hh
+ *
+ * \brief Wall-clock time of the fit statistics (internal header).
+ */
+
+#ifndef ROBOPTIM_CAPSULE_WALL_TIME_HH
+# define ROBOPTIM_CAPSULE_WALL_TIME_HH
+
+# include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace detail
+    {
+      /// \brief Wall-clock time in seconds.
+      inline double wallTime ()
+      {
+	using namespace boost::posix_time;
+	static const ptime epoch (boost::gregorian::date (1970, 1, 1));
+	return static_cast<double> ((microsec_clock::universal_time () - epoch)
+				    .total_microseconds ()) * 1e-6;
+      }
+    } // end of namespace detail.
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_WALL_TIME_HH
@@ -0,0 +1,209 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE allocations
+
+#include <cstdlib>
+#include <new>
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/distance-capsule-point.hh>
+#include <roboptim/capsule/distance-capsule-points.hh>
+#include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/util.hh>
+#include <roboptim/capsule/volume.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Whether allocations are counted.
+  bool counting = false;
+
+  /// \brief Number of counted allocations.
+  size_t nbAllocations = 0;
+
+  /// \brief Count the allocations during its lifetime.
+  struct AllocationCounter
+  {
+    AllocationCounter ()
+    {
+      counting = true;
+    }
+
+    ~AllocationCounter ()
+    {
+      counting = false;
+    }
+  };
+} // end of anonymous namespace.
+
+// Count the allocations of C++ code.
+void* operator new (std::size_t size)
+{
+  if (counting)
+    ++nbAllocations;
+  void* p = std::malloc (size ? size : 1);
+  if (!p)
+    throw std::bad_alloc ();
+  return p;
+}
+
+void operator delete (void* p) throw ()
+{
+  std::free (p);
+}
+
+// Eigen allocates its dynamic matrices with malloc: with glibc, malloc
+// is replaced as well so that they are counted too.
+#ifdef __GLIBC__
+extern "C"
+{
+  void* __libc_malloc (size_t size);
+  void* __libc_realloc (void* p, size_t size);
+
+  void* malloc (size_t size) throw ()
+  {
+    if (counting)
+      ++nbAllocations;
+    return __libc_malloc (size);
+  }
+
+  void* realloc (void* p, size_t size) throw ()
+  {
+    if (counting)
+      ++nbAllocations;
+    return __libc_realloc (p, size);
+  }
+}
+#endif
+
+namespace
+{
+  /// \brief Number of evaluations run by the fitter.
+  size_t nbEvaluations = 0;
+
+  /// \brief Fitter evaluation callback counting the allocations of
+  /// the evaluations.
+  void countAllocations (bool begin)
+  {
+    if (begin)
+      ++nbEvaluations;
+    counting = begin;
+  }
+
+  /// \brief Random points in a box.
+  polyhedrons_t randomPolyhedrons (size_t n)
+  {
+    polyhedrons_t polyhedrons (1);
+    for (size_t i = 0; i < n; ++i)
+      polyhedrons[0].push_back (point_t::Random ().cwiseProduct
+				(point_t (2., 0.5, 0.5)));
+    return polyhedrons;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (evaluation_allocations)
+{
+  const polyhedrons_t polyhedrons = randomPolyhedrons (100);
+  point_t P0, P1;
+  value_type radius;
+  computeBoundingCapsulePolyhedron (polyhedrons, P0, P1, radius);
+  vector7_t param;
+  convertCapsuleToSolverParam (param, P0, P1, radius);
+
+  // Outputs are allocated once, outside of the counted evaluations.
+  Volume volume;
+  DistanceCapsulePoint distance (polyhedrons[0][0]);
+  DistanceCapsulePoints distances (polyhedrons);
+  Volume::result_t result (1);
+  Volume::gradient_t gradient (7);
+  Volume::hessian_t hessian (7, 7);
+  DistanceCapsulePoints::result_t results (distances.outputSize ());
+  DistanceCapsulePoints::jacobian_t jacobian (distances.outputSize (), 7);
+
+  nbAllocations = 0;
+  {
+    AllocationCounter counter;
+    volume (result, param);
+    volume.gradient (gradient, param);
+    volume.hessian (hessian, param);
+    distance (result, param);
+    distance.gradient (gradient, param);
+    distance.hessian (hessian, param);
+    distances (results, param);
+    distances.gradient (gradient, param, 3);
+    distances.jacobian (jacobian, param);
+    distances.hessian (hessian, param, 3);
+  }
+  BOOST_CHECK_EQUAL (nbAllocations, 0);
+
+  // Sparse matrices are allocated by the first evaluation, then
+  // refilled in place.
+  SparseVolume sparseVolume;
+  SparseDistanceCapsulePoints sparseDistances (polyhedrons);
+  SparseVolume::hessian_t sparseHessian (7, 7);
+  SparseDistanceCapsulePoints::jacobian_t sparseJacobian
+    (sparseDistances.outputSize (), 7);
+  sparseVolume.hessian (sparseHessian, param);
+  sparseDistances.jacobian (sparseJacobian, param);
+
+  param[6] *= 1.5;
+  nbAllocations = 0;
+  {
+    AllocationCounter counter;
+    sparseVolume.hessian (sparseHessian, param);
+    sparseDistances.jacobian (sparseJacobian, param);
+  }
+  BOOST_CHECK_EQUAL (nbAllocations, 0);
+  BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (),
+		     7 * sparseDistances.outputSize ());
+}
+
+BOOST_AUTO_TEST_CASE (fit_allocations)
+{
+  // The evaluations run by the solver within Fitter do not allocate,
+  // with and without the active-set strategy and the pruning.
+  const polyhedrons_t polyhedrons = randomPolyhedrons (200);
+  for (int k = 0; k < 2; ++k)
+    {
+      Fitter fitter (polyhedrons);
+      fitter.options ().useActiveSet = k == 1;
+      fitter.options ().usePruning = k == 1;
+      fitter.evaluationCallback () = countAllocations;
+
+      nbEvaluations = 0;
+      nbAllocations = 0;
+      fitter.computeBestFitCapsule ();
+      BOOST_CHECK (fitter.status () == roboptim::GenericSolver::SOLVER_VALUE
+		   || fitter.status ()
+		   == roboptim::GenericSolver::SOLVER_VALUE_WARNINGS);
+
+      // Only the evaluations of the functions are counted, not the
+      // solver.
+      BOOST_CHECK_GT (nbEvaluations, 0);
+      BOOST_CHECK_EQUAL (nbEvaluations,
+			 fitter.stats ().costEvaluations
+			 + fitter.stats ().costGradientEvaluations
+			 + fitter.stats ().costHessianEvaluations
+			 + fitter.stats ().constraintEvaluations
+			 + fitter.stats ().constraintJacobianEvaluations
+			 + fitter.stats ().constraintHessianEvaluations);
+      BOOST_CHECK_EQUAL (nbAllocations, 0);
+    }
+}
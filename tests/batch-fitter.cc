@@ -0,0 +1,129 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE batch-fitter
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+
+#include <roboptim/capsule/util.hh>
+#include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/batch-fitter.hh>
+
+using boost::test_tools::output_test_stream;
+
+BOOST_AUTO_TEST_CASE (batch_fitter)
+{
+  using namespace roboptim::capsule;
+
+  // Build boxes of increasing length.
+  std::vector<polyhedrons_t> problems;
+  for (int k = 0; k < 8; ++k)
+    {
+      polyhedron_t polyhedron;
+      value_type halfLength = 0.5 + 0.25 * k;
+      for (int i = 0; i < 8; ++i)
+	polyhedron.push_back (point_t ((i & 1) ? halfLength : -halfLength,
+				       (i & 2) ? 0.5 : -0.5,
+				       (i & 4) ? 0.5 : -0.5));
+      problems.push_back (polyhedrons_t (1, polyhedron));
+    }
+
+  // An invalid problem does not prevent the others from being solved.
+  problems.push_back (polyhedrons_t ());
+
+  BatchFitter batchFitter ("ipopt", 4);
+  BOOST_CHECK_EQUAL (batchFitter.nbThreads (), 4);
+
+  BatchFitter::results_t results = batchFitter.fit (problems);
+  BOOST_REQUIRE_EQUAL (results.size (), problems.size ());
+
+  // Compare with serial fits.
+  for (size_t k = 0; k + 1 < problems.size (); ++k)
+    {
+      Fitter fitter (problems[k]);
+      fitter.computeBestFitCapsule ();
+
+      BOOST_CHECK (results[k].status == fitter.status ());
+      BOOST_CHECK (results[k].status != roboptim::GenericSolver::SOLVER_ERROR);
+      BOOST_CHECK_CLOSE (results[k].solutionVolume,
+			 fitter.solutionVolume (), 1e-6);
+      BOOST_CHECK_LE (results[k].solutionVolume,
+		      results[k].initVolume * (1. + 1e-6));
+    }
+
+  BOOST_CHECK (results.back ().status == roboptim::GenericSolver::SOLVER_ERROR);
+  BOOST_CHECK (!results.back ().errorMessage.empty ());
+}
+
+namespace
+{
+  /// \brief Load a box of given length, or throw for a negative one.
+  roboptim::capsule::polyhedrons_t
+  loadBox (const std::vector<roboptim::capsule::value_type>& lengths,
+	   size_t i)
+  {
+    using namespace roboptim::capsule;
+
+    if (lengths[i] < 0.)
+      throw std::runtime_error ("invalid box");
+
+    polyhedron_t polyhedron;
+    for (int k = 0; k < 8; ++k)
+      polyhedron.push_back (point_t ((k & 1) ? lengths[i] : 0.,
+				     (k & 2) ? 0.5 : -0.5,
+				     (k & 4) ? 0.5 : -0.5));
+    return polyhedrons_t (1, polyhedron);
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (batch_fitter_loader)
+{
+  using namespace roboptim::capsule;
+
+  std::vector<value_type> lengths;
+  for (int k = 0; k < 6; ++k)
+    lengths.push_back (1. + 0.5 * k);
+  lengths.push_back (-1.);
+
+  BatchFitter batchFitter ("ipopt", 3);
+  BatchFitter::results_t results
+    = batchFitter.fit (lengths.size (),
+		       boost::bind (&loadBox, boost::cref (lengths), _1));
+  BOOST_REQUIRE_EQUAL (results.size (), lengths.size ());
+
+  // Same results as with the problems given at once.
+  for (size_t k = 0; k + 1 < lengths.size (); ++k)
+    {
+      BatchFitter::results_t expected
+	= batchFitter.fit (std::vector<polyhedrons_t>
+			   (1, loadBox (lengths, k)));
+
+      BOOST_CHECK (results[k].status == expected[0].status);
+      BOOST_CHECK_CLOSE (results[k].solutionVolume,
+			 expected[0].solutionVolume, 1e-6);
+      BOOST_CHECK_GE (results[k].loadTime, 0.);
+      BOOST_CHECK_EQUAL (expected[0].loadTime, 0.);
+    }
+
+  // Loader errors are reported per fit.
+  BOOST_CHECK (results.back ().status == roboptim::GenericSolver::SOLVER_ERROR);
+  BOOST_CHECK_EQUAL (results.back ().errorMessage, "invalid box");
+}
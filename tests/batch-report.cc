@@ -0,0 +1,140 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE batch-report
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/batch-report.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Two results: a solution and an error.
+  BatchFitter::results_t results ()
+  {
+    BatchFitter::results_t results (2);
+
+    results[0].initParam << 0., 0., 0., 1., 0., 0., 1.;
+    results[0].solutionParam << 0., 0., 0., 1., 0., 0., 0.5;
+    results[0].initVolume = 7.;
+    results[0].solutionVolume = 1.25;
+    results[0].status = roboptim::GenericSolver::SOLVER_VALUE;
+    results[0].stats.iterations = 12;
+    results[0].stats.solveTime = 0.5;
+    results[0].loadTime = 0.25;
+
+    results[1].status = roboptim::GenericSolver::SOLVER_ERROR;
+    results[1].errorMessage = "bad \"mesh\", line 2\n";
+    results[1].stats.constraintViolation
+      = std::numeric_limits<double>::quiet_NaN ();
+
+    return results;
+  }
+
+  std::vector<std::string> names ()
+  {
+    std::vector<std::string> names;
+    names.push_back ("link0.stl");
+    names.push_back ("link,1.ply");
+    return names;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (batch_report_json)
+{
+  std::ostringstream os;
+  writeBatchReport (os, names (), results (), REPORT_FORMAT_JSON);
+  const std::string report = os.str ();
+
+  BOOST_CHECK_EQUAL (report.substr (0, 2), "[\n");
+  BOOST_CHECK_EQUAL (report.substr (report.size () - 3), "\n]\n");
+
+  // One record per line.
+  std::istringstream lines (report);
+  std::string line;
+  std::getline (lines, line);
+  std::getline (lines, line);
+  BOOST_CHECK_EQUAL (line.substr (0, 21), " {\"name\": \"link0.stl\"");
+  BOOST_CHECK (line.find ("\"status\": \"solution\"") != std::string::npos);
+  BOOST_CHECK (line.find ("\"solutionParam\": [0, 0, 0, 1, 0, 0, 0.5]")
+	       != std::string::npos);
+  BOOST_CHECK (line.find ("\"solutionVolume\": 1.25") != std::string::npos);
+  BOOST_CHECK (line.find ("\"loadTime\": 0.25") != std::string::npos);
+  BOOST_CHECK (line.find ("\"iterations\": 12") != std::string::npos);
+  BOOST_CHECK (line.find ("\"cached\": false") != std::string::npos);
+  BOOST_CHECK_EQUAL (line[line.size () - 1], ',');
+
+  std::getline (lines, line);
+  BOOST_CHECK (line.find ("\"status\": \"error\"") != std::string::npos);
+  BOOST_CHECK (line.find ("\"error\": \"bad \\\"mesh\\\", line 2\\n\"")
+	       != std::string::npos);
+  BOOST_CHECK (line.find ("\"constraintViolation\": null")
+	       != std::string::npos);
+
+  // Empty batch.
+  std::ostringstream empty;
+  writeBatchReport (empty, std::vector<std::string> (),
+		    BatchFitter::results_t (), REPORT_FORMAT_JSON);
+  BOOST_CHECK_EQUAL (empty.str (), "[]\n");
+}
+
+BOOST_AUTO_TEST_CASE (batch_report_csv)
+{
+  std::ostringstream os;
+  writeBatchReport (os, names (), results (), REPORT_FORMAT_CSV);
+
+  std::istringstream lines (os.str ());
+  std::string header, line;
+  std::getline (lines, header);
+  BOOST_CHECK_EQUAL (header.substr (0, 29), "name,status,error,init_ax,ini");
+  BOOST_CHECK_EQUAL (std::count (header.begin (), header.end (), ','), 25);
+
+  std::getline (lines, line);
+  BOOST_CHECK_EQUAL (line, "link0.stl,solution,,0,0,0,1,0,0,1,7,"
+		     "0,0,0,1,0,0,0.5,1.25,0.25,0,0,0.5,12,0,0");
+
+  // Quoted fields, the error message spanning two lines.
+  std::getline (lines, line);
+  BOOST_CHECK_EQUAL (line, "\"link,1.ply\",error,\"bad \"\"mesh\"\", line 2");
+
+  // Empty field for NaN.
+  std::getline (lines, line);
+  BOOST_CHECK_EQUAL (line, "\",0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,,0");
+
+  BOOST_CHECK_THROW (writeBatchReport (os, std::vector<std::string> (),
+				       results (), REPORT_FORMAT_CSV),
+		     std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (batch_report_names)
+{
+  BOOST_CHECK (reportFormatFromString ("json") == REPORT_FORMAT_JSON);
+  BOOST_CHECK (reportFormatFromString ("csv") == REPORT_FORMAT_CSV);
+  BOOST_CHECK_THROW (reportFormatFromString ("xml"), std::runtime_error);
+
+  using roboptim::GenericSolver;
+  BOOST_CHECK_EQUAL (std::string (solverStatusName
+				  (GenericSolver::SOLVER_VALUE_WARNINGS)),
+		     "solution_with_warnings");
+}
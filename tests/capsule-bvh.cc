@@ -0,0 +1,253 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE capsule-bvh
+
+#include <cmath>
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include <Eigen/Geometry>
+
+#include <roboptim/capsule/capsule-bvh.hh>
+#include <roboptim/capsule/capsule-distance.hh>
+
+#include "shared-tests/capsules.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Check the queries of a hierarchy against brute force.
+  void checkQueries (const CapsuleBvh& bvh,
+		     const std::vector<Capsule>& capsules,
+		     value_type side)
+  {
+    const value_type inf = std::numeric_limits<value_type>::infinity ();
+
+    for (int q = 0; q < 200; ++q)
+      {
+	point_t p = 0.5 * side * point_t::Random ();
+
+	// Inside and nearest.
+	std::vector<size_type> expected;
+	value_type best = inf;
+	for (size_t i = 0; i < capsules.size (); ++i)
+	  {
+	    const Capsule& c = capsules[i];
+	    value_type d = distancePointToSegment (p, c.P0, c.P1) - c.radius;
+	    best = std::min (best, d);
+	    if (d <= 0.)
+	      expected.push_back (static_cast<size_type> (i));
+	  }
+
+	std::vector<size_type> indices;
+	bvh.containing (p, indices);
+	BOOST_CHECK (indices == expected);
+	BOOST_CHECK_EQUAL (bvh.inside (p), !expected.empty ());
+
+	value_type distance;
+	size_type index = bvh.nearest (p, distance);
+	BOOST_CHECK_EQUAL (distance, best);
+	BOOST_REQUIRE (index >= 0);
+	const Capsule& c = capsules[static_cast<size_t> (index)];
+	BOOST_CHECK_EQUAL (distancePointToSegment (p, c.P0, c.P1) - c.radius,
+			   best);
+
+	// Overlaps.
+	Capsule query = makeCapsule (p, p + point_t::Random (), 0.3);
+	expected.clear ();
+	for (size_t i = 0; i < capsules.size (); ++i)
+	  if (capsulesOverlap (query, capsules[i]))
+	    expected.push_back (static_cast<size_type> (i));
+
+	bvh.overlapping (query, indices);
+	BOOST_CHECK (indices == expected);
+	BOOST_CHECK_EQUAL (bvh.overlapsAny (query), !expected.empty ());
+
+	// Rays, some of them along the axes.
+	vector3_t direction = vector3_t::Random ().normalized ();
+	if (q % 10 == 0)
+	  direction = vector3_t::Unit (q % 3);
+	best = inf;
+	for (size_t i = 0; i < capsules.size (); ++i)
+	  {
+	    value_type t;
+	    if (rayCapsuleIntersection (p, direction, capsules[i], t)
+		&& t <= side)
+	      best = std::min (best, t);
+	  }
+
+	bool hit = bvh.raycast (p, direction, side, distance, index);
+	BOOST_CHECK_EQUAL (hit, best < inf);
+	if (hit)
+	  {
+	    BOOST_CHECK_EQUAL (distance, best);
+	    value_type t;
+	    BOOST_CHECK (rayCapsuleIntersection
+			 (p, direction,
+			  capsules[static_cast<size_t> (index)], t));
+	    BOOST_CHECK_EQUAL (t, best);
+	  }
+      }
+  }
+
+  /// \brief Check that each node box contains its capsules.
+  void checkBoxes (const CapsuleBvh& bvh)
+  {
+    const CapsuleBvh::nodes_t& nodes = bvh.nodes ();
+    const size_type leafSize = CapsuleBvh::leafSize;
+    size_t leafCapsules = 0;
+    for (size_t i = 0; i < nodes.size (); ++i)
+      {
+	const CapsuleBvh::Node& node = nodes[i];
+	if (!node.isLeaf ())
+	  {
+	    BOOST_CHECK_GT (node.index, i + 1);
+	    BOOST_CHECK_LT (node.index, nodes.size ());
+	    continue;
+	  }
+
+	BOOST_CHECK_LE (static_cast<size_type> (node.count), leafSize);
+	leafCapsules += node.count;
+	for (size_t k = 0; k < node.count; ++k)
+	  {
+	    const Capsule& c = bvh.capsule (bvh.order ()[node.index + k]);
+	    BOOST_CHECK ((c.P0.cwiseMin (c.P1).array () - c.radius
+			  >= node.lower.array ()).all ());
+	    BOOST_CHECK ((c.P0.cwiseMax (c.P1).array () + c.radius
+			  <= node.upper.array ()).all ());
+	  }
+      }
+    BOOST_CHECK_EQUAL (leafCapsules, static_cast<size_t> (bvh.size ()));
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (ray_capsule)
+{
+  Capsule capsule = makeCapsule (point_t (0., 0., 0.), point_t (2., 0., 0.),
+				 0.5);
+  value_type t;
+
+  // Lateral surface.
+  BOOST_CHECK (rayCapsuleIntersection (point_t (1., -3., 0.),
+				       vector3_t (0., 1., 0.), capsule, t));
+  BOOST_CHECK_CLOSE (t, 2.5, 1e-10);
+
+  // Along the axis, through the spherical end.
+  BOOST_CHECK (rayCapsuleIntersection (point_t (-3., 0., 0.),
+				       vector3_t (1., 0., 0.), capsule, t));
+  BOOST_CHECK_CLOSE (t, 2.5, 1e-10);
+
+  // Inside.
+  BOOST_CHECK (rayCapsuleIntersection (point_t (1., 0.1, 0.),
+				       vector3_t (0., 0., 1.), capsule, t));
+  BOOST_CHECK_EQUAL (t, 0.);
+
+  // Behind and beside.
+  BOOST_CHECK (!rayCapsuleIntersection (point_t (1., -3., 0.),
+					vector3_t (0., -1., 0.), capsule, t));
+  BOOST_CHECK (!rayCapsuleIntersection (point_t (1., -3., 0.),
+					vector3_t (1., 0., 0.), capsule, t));
+
+  // Sphere.
+  capsule.P1 = capsule.P0;
+  BOOST_CHECK (rayCapsuleIntersection (point_t (0., 0., 2.),
+				       vector3_t (0., 0., -1.), capsule, t));
+  BOOST_CHECK_CLOSE (t, 1.5, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE (empty_bvh)
+{
+  CapsuleBvh bvh;
+  BOOST_CHECK_EQUAL (bvh.size (), 0);
+  BOOST_CHECK (bvh.nodes ().empty ());
+  BOOST_CHECK (!bvh.inside (point_t::Zero ()));
+
+  value_type distance;
+  BOOST_CHECK_EQUAL (bvh.nearest (point_t::Zero (), distance), -1);
+  BOOST_CHECK (distance == std::numeric_limits<value_type>::infinity ());
+
+  size_type index;
+  BOOST_CHECK (!bvh.raycast (point_t::Zero (), vector3_t::UnitX (), 1.,
+			     distance, index));
+}
+
+BOOST_AUTO_TEST_CASE (bvh_queries)
+{
+  const value_type side = 10.;
+  std::vector<Capsule> capsules = randomCapsules (2000, side);
+
+  CapsuleBvh bvh (capsules, 1);
+  BOOST_CHECK_EQUAL (bvh.size (), 2000);
+  BOOST_CHECK_LE (bvh.nodes ().size (), capsules.size ());
+  checkBoxes (bvh);
+  checkQueries (bvh, capsules, side);
+}
+
+BOOST_AUTO_TEST_CASE (parallel_build)
+{
+  // Enough capsules for the subtrees to be built by several threads.
+  const value_type side = 40.;
+  std::vector<Capsule> capsules = randomCapsules (20000, side);
+
+  CapsuleBvh serial (capsules, 1);
+  CapsuleBvh parallel (capsules, 4);
+
+  // Splits do not depend on the threads.
+  BOOST_REQUIRE_EQUAL (serial.nodes ().size (), parallel.nodes ().size ());
+  for (size_t i = 0; i < serial.nodes ().size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (serial.nodes ()[i].index,
+			 parallel.nodes ()[i].index);
+      BOOST_CHECK_EQUAL (serial.nodes ()[i].count,
+			 parallel.nodes ()[i].count);
+      BOOST_CHECK (serial.nodes ()[i].lower == parallel.nodes ()[i].lower);
+      BOOST_CHECK (serial.nodes ()[i].upper == parallel.nodes ()[i].upper);
+    }
+  checkBoxes (parallel);
+  checkQueries (parallel, capsules, side);
+}
+
+BOOST_AUTO_TEST_CASE (refit)
+{
+  const value_type side = 10.;
+  std::vector<Capsule> capsules = randomCapsules (1000, side);
+  CapsuleBvh bvh (capsules);
+
+  // Rigid motion of the whole set.
+  const Eigen::AngleAxis<value_type> rotation (0.7, vector3_t (1., 2., 3.)
+					       .normalized ());
+  const vector3_t translation (0.5, -1., 2.);
+  for (size_t i = 0; i < capsules.size (); ++i)
+    {
+      capsules[i].P0 = rotation * capsules[i].P0 + translation;
+      capsules[i].P1 = rotation * capsules[i].P1 + translation;
+    }
+  bvh.refit (capsules);
+  checkBoxes (bvh);
+  checkQueries (bvh, capsules, side);
+
+  // Motion of a single capsule.
+  capsules[17].P0 += vector3_t (3., 0., 0.);
+  capsules[17].P1 += vector3_t (3., 0., 0.);
+  bvh.capsule (17, capsules[17]);
+  bvh.refit ();
+  checkBoxes (bvh);
+  checkQueries (bvh, capsules, side);
+}
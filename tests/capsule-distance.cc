@@ -0,0 +1,234 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE capsule-distance
+
+#include <cmath>
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/capsule-distance.hh>
+
+#include "shared-tests/capsules.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Distance between segments, by sampling both of them.
+  value_type sampledDistance (const point_t& p0, const point_t& p1,
+			      const point_t& q0, const point_t& q1)
+  {
+    value_type d = std::numeric_limits<value_type>::max ();
+    for (int i = 0; i <= 200; ++i)
+      for (int j = 0; j <= 200; ++j)
+	d = std::min (d, (p0 + (i / 200.) * (p1 - p0)
+			  - q0 - (j / 200.) * (q1 - q0)).norm ());
+    return d;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (segment_distance)
+{
+  value_type s, t;
+
+  // Crossing segments, one above the other.
+  BOOST_CHECK_CLOSE (closestPointsOnSegments (point_t (-1., 0., 0.),
+					      point_t (1., 0., 0.),
+					      point_t (0., -1., 1.),
+					      point_t (0., 1., 1.), s, t),
+		     1., 1e-10);
+  BOOST_CHECK_CLOSE (s, 0.5, 1e-10);
+  BOOST_CHECK_CLOSE (t, 0.5, 1e-10);
+
+  // Parallel overlapping segments.
+  BOOST_CHECK_CLOSE (distanceSegmentToSegment (point_t (0., 0., 0.),
+					       point_t (2., 0., 0.),
+					       point_t (1., 0.5, 0.),
+					       point_t (3., 0.5, 0.)),
+		     0.5, 1e-10);
+
+  // End points.
+  BOOST_CHECK_CLOSE (closestPointsOnSegments (point_t (0., 0., 0.),
+					      point_t (1., 0., 0.),
+					      point_t (2., 1., 0.),
+					      point_t (3., 1., 0.), s, t),
+		     std::sqrt (2.), 1e-10);
+  BOOST_CHECK_EQUAL (s, 1.);
+  BOOST_CHECK_EQUAL (t, 0.);
+
+  // Degenerate segments are points.
+  point_t p (0.5, 1., 0.);
+  BOOST_CHECK_CLOSE (distanceSegmentToSegment (p, p, point_t (0., 0., 0.),
+					       point_t (1., 0., 0.)),
+		     1., 1e-10);
+  BOOST_CHECK_CLOSE (distanceSegmentToSegment (point_t (0., 0., 0.),
+					       point_t (1., 0., 0.), p, p),
+		     1., 1e-10);
+  BOOST_CHECK_CLOSE (distanceSegmentToSegment (p, p, point_t::Zero (),
+					       point_t::Zero ()),
+		     p.norm (), 1e-10);
+
+  // Random segments against sampling.
+  for (int k = 0; k < 20; ++k)
+    {
+      point_t p0 = point_t::Random (), p1 = point_t::Random ();
+      point_t q0 = point_t::Random (), q1 = point_t::Random ();
+      value_type d = closestPointsOnSegments (p0, p1, q0, q1, s, t);
+
+      BOOST_CHECK_GE (s, 0.);
+      BOOST_CHECK_LE (s, 1.);
+      BOOST_CHECK_GE (t, 0.);
+      BOOST_CHECK_LE (t, 1.);
+      BOOST_CHECK_SMALL (d - (p0 + s * (p1 - p0) - q0 - t * (q1 - q0))
+			 .norm (), 1e-12);
+      BOOST_CHECK_LE (d, sampledDistance (p0, p1, q0, q1) + 1e-12);
+      BOOST_CHECK_GE (d, sampledDistance (p0, p1, q0, q1) - 5e-2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (capsule_distance)
+{
+  Capsule a = makeCapsule (point_t (0., 0., 0.), point_t (1., 0., 0.), 0.5);
+  Capsule b = makeCapsule (point_t (0., 2., 0.), point_t (1., 2., 0.), 0.5);
+  BOOST_CHECK_CLOSE (distanceCapsuleToCapsule (a, b), 1., 1e-10);
+  BOOST_CHECK (!capsulesOverlap (a, b));
+
+  b.radius = 1.6;
+  BOOST_CHECK_CLOSE (distanceCapsuleToCapsule (a, b), -0.1, 1e-8);
+  BOOST_CHECK (capsulesOverlap (a, b));
+}
+
+BOOST_AUTO_TEST_CASE (capsule_set)
+{
+  std::vector<Capsule> capsules = randomCapsules (40, 6.);
+  CapsuleSet set (capsules);
+  BOOST_CHECK_EQUAL (set.size (), 40);
+
+  CapsuleSet grown;
+  for (size_t i = 0; i < capsules.size (); ++i)
+    grown.add (capsules[i]);
+  BOOST_CHECK_EQUAL (grown.size (), 40);
+
+  for (size_type i = 0; i < set.size (); ++i)
+    {
+      BOOST_CHECK (grown.capsule (i).P0 == capsules[i].P0);
+      BOOST_CHECK (grown.capsule (i).P1 == capsules[i].P1);
+      BOOST_CHECK_EQUAL (grown.capsule (i).radius, capsules[i].radius);
+    }
+
+  // Rigid motion of one capsule.
+  Capsule moved = capsules[3];
+  moved.P0 += point_t (1., 2., 3.);
+  moved.P1 += point_t (1., 2., 3.);
+  set.capsule (3, moved);
+  BOOST_CHECK (set.capsule (3).P0 == moved.P0);
+  BOOST_CHECK_EQUAL (set.parameters () (3, 4), moved.P1[1]);
+
+  set.clear ();
+  BOOST_CHECK_EQUAL (set.size (), 0);
+}
+
+BOOST_AUTO_TEST_CASE (batched_capsule_distance)
+{
+  // More capsules than a block.
+  std::vector<Capsule> capsules = randomCapsules (600, 6.);
+  CapsuleSet set (capsules);
+  const size_type n = set.size ();
+
+  for (size_t c = 0; c < 3; ++c)
+    {
+      const Capsule& capsule = capsules[c];
+      vector_t distances (n);
+      distancesCapsuleToCapsules (capsule, set, distances);
+
+      std::vector<size_type> expected;
+      for (size_type i = 0; i < n; ++i)
+	{
+	  value_type d = distanceCapsuleToCapsule (capsule, capsules[i]);
+	  BOOST_CHECK_SMALL (distances[i] - d, 1e-9);
+	  if (d <= 0.)
+	    expected.push_back (i);
+	}
+
+      std::vector<size_type> indices;
+      overlappingCapsules (capsule, set, indices);
+      BOOST_CHECK (indices == expected);
+      BOOST_CHECK_EQUAL (overlapsAny (capsule, set), !expected.empty ());
+    }
+
+  // Far away capsule.
+  Capsule far = makeCapsule (point_t (100., 0., 0.), point_t (101., 0., 0.),
+			     1.);
+  BOOST_CHECK (!overlapsAny (far, set));
+
+  // Pairs of capsules.
+  std::vector<Capsule> shifted (capsules.rbegin (), capsules.rend ());
+  vector_t distances (n);
+  distancesCapsulePairs (set, CapsuleSet (shifted), distances);
+  for (size_type i = 0; i < n; ++i)
+    BOOST_CHECK_SMALL (distances[i]
+		       - distanceCapsuleToCapsule (capsules[i], shifted[i]),
+		       1e-9);
+}
+
+BOOST_AUTO_TEST_CASE (self_collision)
+{
+  std::vector<Capsule> capsules = randomCapsules (300, 6.);
+  CapsuleSet set (capsules);
+  const size_type n = set.size ();
+
+  matrix_t distances;
+  selfDistances (set, pairMask_t (), distances);
+  BOOST_CHECK_EQUAL (distances.rows (), n);
+  BOOST_CHECK_EQUAL (distances.cols (), n);
+
+  std::vector<capsulePair_t> expected;
+  for (size_type i = 0; i < n; ++i)
+    {
+      BOOST_CHECK (distances (i, i)
+		   == std::numeric_limits<value_type>::infinity ());
+      for (size_type j = i + 1; j < n; ++j)
+	{
+	  value_type d = distanceCapsuleToCapsule (capsules[i], capsules[j]);
+	  BOOST_CHECK_SMALL (distances (i, j) - d, 1e-9);
+	  BOOST_CHECK_EQUAL (distances (i, j), distances (j, i));
+	  if (d <= 0.)
+	    expected.push_back (capsulePair_t (i, j));
+	}
+    }
+
+  std::vector<capsulePair_t> pairs;
+  selfOverlaps (set, pairMask_t (), pairs);
+  BOOST_CHECK (pairs == expected);
+  BOOST_CHECK_EQUAL (selfOverlapsAny (set, pairMask_t ()), !pairs.empty ());
+
+  // Masking all the overlapping pairs.
+  pairMask_t mask = pairMask_t::Constant (n, n, true);
+  for (size_t k = 0; k < expected.size (); ++k)
+    mask (expected[k].first, expected[k].second) = false;
+
+  selfOverlaps (set, mask, pairs);
+  BOOST_CHECK (pairs.empty ());
+  BOOST_CHECK (!selfOverlapsAny (set, mask));
+
+  selfDistances (set, mask, distances);
+  if (!expected.empty ())
+    BOOST_CHECK (distances (expected[0].first, expected[0].second)
+		 == std::numeric_limits<value_type>::infinity ());
+}
@@ -56,3 +56,58 @@ BOOST_AUTO_TEST_CASE (capsule_volume)
   bool isGoodGradient = checkGradient (volumeFunction, 0, argument);
   BOOST_CHECK_EQUAL (isGoodGradient, true);
 }
+
+BOOST_AUTO_TEST_CASE (capsule_volume_sparse)
+{
+  using namespace roboptim::capsule;
+
+  Volume denseVolume;
+  SparseVolume sparseVolume;
+
+  argument_t argument (7);
+  argument << 0.1, -0.2, -1., 0.3, 0.2, 1., 0.7;
+
+  BOOST_CHECK_CLOSE (sparseVolume (argument)[0], denseVolume (argument)[0],
+		     1e-10);
+
+  Volume::gradient_t denseGradient = denseVolume.gradient (argument);
+  SparseVolume::gradient_t sparseGradient = sparseVolume.gradient (argument);
+
+  for (size_type i = 0; i < 7; ++i)
+    BOOST_CHECK_CLOSE (sparseGradient.coeff (i), denseGradient[i], 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE (capsule_volume_hessian)
+{
+  using namespace roboptim::capsule;
+
+  Volume volumeFunction;
+
+  argument_t argument (7);
+  argument << 0.1, -0.2, -1., 0.3, 0.2, 1., 0.7;
+
+  Volume::hessian_t hessian = volumeFunction.hessian (argument);
+
+  // Compare with central finite differences of the gradient.
+  value_type epsilon = 1e-6;
+  for (size_type j = 0; j < 7; ++j)
+    {
+      argument_t xPlus = argument;
+      argument_t xMinus = argument;
+      xPlus[j] += epsilon;
+      xMinus[j] -= epsilon;
+
+      Volume::gradient_t column = (volumeFunction.gradient (xPlus)
+				   - volumeFunction.gradient (xMinus))
+	/ (2. * epsilon);
+
+      for (size_type i = 0; i < 7; ++i)
+	BOOST_CHECK_SMALL (hessian (i, j) - column[i], 1e-5);
+    }
+
+  // The sparse hessian matches the dense one.
+  SparseVolume sparseVolume;
+  SparseVolume::hessian_t sparseHessian = sparseVolume.hessian (argument);
+  BOOST_CHECK_SMALL ((Volume::hessian_t (sparseHessian) - hessian).norm (),
+		     1e-12);
+}
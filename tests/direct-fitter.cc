@@ -0,0 +1,155 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#define BOOST_TEST_MODULE direct_fitter
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/util.hh>
+#include <roboptim/capsule/direct-fitter.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Largest signed distance from the points to the capsule.
+  value_type maxDistance (const polyhedron_t& points,
+			  const argument_t& param)
+  {
+    point_t endPoint1 (param[0], param[1], param[2]);
+    point_t endPoint2 (param[3], param[4], param[5]);
+
+    value_type d = -param[6];
+    for (size_t i = 0; i < points.size (); ++i)
+      d = std::max (d, distancePointToSegment (points[i], endPoint1, endPoint2)
+		    - param[6]);
+    return d;
+  }
+
+  value_type capsuleVolume (const argument_t& param)
+  {
+    value_type length = (param.segment<3> (3) - param.segment<3> (0)).norm ();
+    return M_PI * param[6] * param[6] * length
+      + 4. / 3. * M_PI * param[6] * param[6] * param[6];
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (direct_fitter_cube)
+{
+  // Unit cube centered in (0,0,0).
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 0.5 : -0.5,
+				   (i & 2) ? 0.5 : -0.5,
+				   (i & 4) ? 0.5 : -0.5));
+
+  DirectFitter fitter (polyhedrons_t (1, polyhedron));
+  fitter.computeBestFitCapsule ();
+
+  const argument_t& param = fitter.solutionParam ();
+  BOOST_CHECK_LT (maxDistance (polyhedron, param), 1e-9);
+  BOOST_CHECK_CLOSE (capsuleVolume (param), fitter.solutionVolume (), 1e-9);
+
+  // The best capsule found by Fitter: radius 0.7719 and segment of
+  // length 0.3808 along an axis of the cube.
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), 2.6390, 0.1);
+  BOOST_CHECK_CLOSE (param[6], 0.7719, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE (direct_fitter_direction)
+{
+  // Rectangular box elongated along x.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 1.5 : -1.5,
+				   (i & 2) ? 0.5 : -0.5,
+				   (i & 4) ? 0.5 : -0.5));
+
+  argument_t param (7);
+  value_type volume = bestCapsuleAlongDirection (polyhedron,
+						 vector3_t (1., 0., 0.),
+						 param);
+
+  BOOST_CHECK_CLOSE (capsuleVolume (param), volume, 1e-9);
+  BOOST_CHECK_LT (maxDistance (polyhedron, param), 1e-9);
+
+  // The axis is the x axis, and the radius is at least the one of the
+  // box section.
+  BOOST_CHECK_SMALL (param[1], 1e-9);
+  BOOST_CHECK_SMALL (param[2], 1e-9);
+  BOOST_CHECK_SMALL (param[4], 1e-9);
+  BOOST_CHECK_SMALL (param[5], 1e-9);
+  BOOST_CHECK_GE (param[6], std::sqrt (0.5) - 1e-9);
+
+  // No other direction does better.
+  DirectFitter fitter (polyhedrons_t (1, polyhedron));
+  fitter.computeBestFitCapsule ();
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), volume, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE (direct_fitter_cloud)
+{
+  // Random cloud in a rotated ellipsoid, split into two polyhedrons.
+  Eigen::Matrix3d rotation
+    = Eigen::AngleAxisd (0.3, vector3_t (1., 2., 3.).normalized ())
+    .toRotationMatrix ();
+
+  polyhedrons_t polyhedrons (2);
+  polyhedron_t points;
+  for (int i = 0; i < 2000; ++i)
+    {
+      point_t p = rotation * point_t::Random ().cwiseProduct
+	(point_t (2., 0.6, 0.4));
+      polyhedrons[i % 2].push_back (p);
+      points.push_back (p);
+    }
+
+  DirectFitter fitter (polyhedrons);
+  fitter.computeBestFitCapsule ();
+
+  const argument_t& param = fitter.solutionParam ();
+  BOOST_CHECK_LT (maxDistance (points, param), 1e-9);
+
+  // Better than the bounding capsule.
+  point_t endPoint1, endPoint2;
+  value_type radius;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+  argument_t boundingParam (7);
+  convertCapsuleToSolverParam (boundingParam, endPoint1, endPoint2, radius);
+  BOOST_CHECK_LT (fitter.solutionVolume (), capsuleVolume (boundingParam));
+}
+
+BOOST_AUTO_TEST_CASE (direct_fitter_degenerate)
+{
+  // Single point.
+  DirectFitter fitter (polyhedrons_t (1, polyhedron_t (3, point_t (1., 2., 3.))));
+  fitter.computeBestFitCapsule ();
+  BOOST_CHECK_SMALL (fitter.solutionVolume (), 1e-12);
+  BOOST_CHECK_SMALL ((fitter.solutionParam ().segment<3> (0)
+		      - point_t (1., 2., 3.)).norm (), 1e-9);
+
+  // Segment.
+  polyhedron_t segment;
+  segment.push_back (point_t (0., 0., 0.));
+  segment.push_back (point_t (1., 1., 0.));
+  segment.push_back (point_t (0.5, 0.5, 0.));
+  fitter.polyhedrons (polyhedrons_t (1, segment));
+  fitter.computeBestFitCapsule ();
+  BOOST_CHECK_LT (maxDistance (segment, fitter.solutionParam ()), 1e-9);
+  BOOST_CHECK_SMALL (fitter.solutionVolume (), 1e-6);
+}
@@ -83,3 +83,92 @@ BOOST_AUTO_TEST_CASE (distance_capsule_polyhedron)
 			 true);
     }
 }
+
+BOOST_AUTO_TEST_CASE (distance_capsule_point_gradient)
+{
+  using namespace roboptim::capsule;
+
+  // Capsule along the x axis.
+  argument_t argument (7);
+  argument << -1., 0., 0., 1., 0., 0., 0.5;
+
+  // Points projecting inside the segment, beyond the first end point
+  // and beyond the second end point.
+  std::vector<point_t> points;
+  points.push_back (point_t (0.3, 0.7, -0.2));
+  points.push_back (point_t (-0.8, -1.2, 0.4));
+  points.push_back (point_t (-2.1, 0.3, 0.5));
+  points.push_back (point_t (1.7, -0.4, 0.9));
+
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      DistanceCapsulePoint distanceFunction (points[i]);
+      BOOST_CHECK (checkGradient (distanceFunction, 0, argument, 1e-6));
+    }
+
+  // Same test on a randomly oriented capsule.
+  argument.segment<6> (0).setRandom ();
+  for (size_t i = 0; i < 20; ++i)
+    {
+      DistanceCapsulePoint distanceFunction (2. * point_t::Random ());
+      BOOST_CHECK (checkGradient (distanceFunction, 0, argument, 1e-6));
+    }
+
+  // Degenerate capsule (sphere): both end points share the gradient
+  // evenly.
+  argument << 0., 0., 0., 0., 0., 0., 0.5;
+  DistanceCapsulePoint sphereDistance (point_t (0., 2., 0.));
+  DistanceCapsulePoint::gradient_t gradient
+    = sphereDistance.gradient (argument);
+
+  BOOST_CHECK_SMALL (gradient[0], 1e-12);
+  BOOST_CHECK_CLOSE (gradient[1], -0.5, 1e-6);
+  BOOST_CHECK_SMALL (gradient[2], 1e-12);
+  BOOST_CHECK_SMALL (gradient[3], 1e-12);
+  BOOST_CHECK_CLOSE (gradient[4], -0.5, 1e-6);
+  BOOST_CHECK_SMALL (gradient[5], 1e-12);
+  BOOST_CHECK_CLOSE (gradient[6], -1., 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE (distance_capsule_point_hessian)
+{
+  using namespace roboptim::capsule;
+
+  argument_t argument (7);
+  argument << -1., 0.2, 0.1, 1., -0.3, 0.2, 0.5;
+
+  // Points projecting inside the segment, beyond the first end point
+  // and beyond the second end point.
+  std::vector<point_t> points;
+  points.push_back (point_t (0.3, 0.7, -0.2));
+  points.push_back (point_t (-2.1, 0.3, 0.5));
+  points.push_back (point_t (1.7, -0.4, 0.9));
+  for (size_t i = 0; i < 10; ++i)
+    points.push_back (2. * point_t::Random ());
+
+  value_type epsilon = 1e-6;
+  for (size_t k = 0; k < points.size (); ++k)
+    {
+      DistanceCapsulePoint distanceFunction (points[k]);
+      DistanceCapsulePoint::hessian_t hessian
+	= distanceFunction.hessian (argument);
+
+      BOOST_CHECK_SMALL ((hessian - hessian.transpose ()).norm (), 1e-12);
+
+      // Compare with central finite differences of the gradient.
+      for (size_type j = 0; j < 7; ++j)
+	{
+	  argument_t xPlus = argument;
+	  argument_t xMinus = argument;
+	  xPlus[j] += epsilon;
+	  xMinus[j] -= epsilon;
+
+	  DistanceCapsulePoint::gradient_t column
+	    = (distanceFunction.gradient (xPlus)
+	       - distanceFunction.gradient (xMinus)) / (2. * epsilon);
+
+	  for (size_type i = 0; i < 7; ++i)
+	    BOOST_CHECK_SMALL (hessian (i, j) - column[i], 1e-5);
+	}
+    }
+}
@@ -0,0 +1,156 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE distance-capsule-points
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+
+#include "roboptim/capsule/distance-capsule-point.hh"
+#include "roboptim/capsule/distance-capsule-points.hh"
+
+using boost::test_tools::output_test_stream;
+
+BOOST_AUTO_TEST_CASE (distance_capsule_points)
+{
+  using namespace roboptim::capsule;
+
+  // Build a random point cloud split in two polyhedrons.
+  polyhedrons_t polyhedrons (2);
+  for (size_t i = 0; i < 50; ++i)
+    polyhedrons[i%2].push_back (2. * point_t::Random ());
+
+  DistanceCapsulePoints distanceFunction (polyhedrons);
+  BOOST_CHECK_EQUAL (distanceFunction.outputSize (), 50);
+  BOOST_CHECK_EQUAL (distanceFunction.points ().cols (), 50);
+
+  // Capsule parameters, including a degenerate (sphere) capsule.
+  std::vector<argument_t> arguments (2, argument_t (7));
+  arguments[0] << -0.5, 0.2, 0.1, 0.7, -0.3, 0.4, 0.8;
+  arguments[1] << 0.1, 0.2, 0.3, 0.1, 0.2, 0.3, 1.;
+
+  for (size_t k = 0; k < arguments.size (); ++k)
+    {
+      const argument_t& argument = arguments[k];
+
+      DistanceCapsulePoints::result_t distances
+	= distanceFunction (argument);
+      DistanceCapsulePoints::jacobian_t jacobian
+	= distanceFunction.jacobian (argument);
+
+      BOOST_CHECK_EQUAL (jacobian.rows (), 50);
+      BOOST_CHECK_EQUAL (jacobian.cols (), 7);
+
+      // Compare with the per-point distance function.
+      size_type i = 0;
+      for (size_t p = 0; p < polyhedrons.size (); ++p)
+	for (size_t j = 0; j < polyhedrons[p].size (); ++j, ++i)
+	  {
+	    DistanceCapsulePoint pointDistance (polyhedrons[p][j]);
+
+	    BOOST_CHECK_CLOSE (distances[i], pointDistance (argument)[0], 1e-8);
+
+	    DistanceCapsulePoint::gradient_t gradient
+	      = pointDistance.gradient (argument);
+	    for (size_type c = 0; c < 7; ++c)
+	      {
+		BOOST_CHECK_SMALL (jacobian (i, c) - gradient[c], 1e-10);
+		BOOST_CHECK_SMALL (distanceFunction.gradient (argument, i)[c]
+				   - gradient[c], 1e-10);
+	      }
+	  }
+    }
+
+  // Check the jacobian rows against finite differences.
+  for (size_type i = 0; i < distanceFunction.outputSize (); ++i)
+    BOOST_CHECK (checkGradient (distanceFunction, i, arguments[0], 1e-6));
+}
+
+BOOST_AUTO_TEST_CASE (distance_capsule_points_sparse)
+{
+  using namespace roboptim::capsule;
+
+  argument_t argument (7);
+  argument << -0.5, 0.2, 0.1, 0.7, -0.3, 0.4, 0.8;
+
+  // Fewer points than parameters, as in small active sets, and more.
+  const size_type sizes[] = {3, 30};
+  for (int k = 0; k < 2; ++k)
+    {
+      const size_type n = sizes[k];
+      points_t points = 2. * points_t::Random (3, n);
+
+      DistanceCapsulePoints denseFunction (points);
+      SparseDistanceCapsulePoints sparseFunction (points);
+
+      DistanceCapsulePoints::jacobian_t denseJacobian
+	= denseFunction.jacobian (argument);
+      SparseDistanceCapsulePoints::jacobian_t sparseJacobian
+	= sparseFunction.jacobian (argument);
+
+      // Every row stores its 7 entries, whatever their value.
+      BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (), n * 7);
+      BOOST_CHECK_SMALL ((DistanceCapsulePoints::jacobian_t (sparseJacobian)
+			  - denseJacobian).norm (), 1e-12);
+
+      // Refilled in place.
+      sparseFunction.jacobian (sparseJacobian, argument);
+      BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (), n * 7);
+      BOOST_CHECK_SMALL ((DistanceCapsulePoints::jacobian_t (sparseJacobian)
+			  - denseJacobian).norm (), 1e-12);
+
+      for (size_type i = 0; i < points.cols (); ++i)
+	{
+	  SparseDistanceCapsulePoints::gradient_t gradient
+	    = sparseFunction.gradient (argument, i);
+	  for (size_type c = 0; c < 7; ++c)
+	    BOOST_CHECK_SMALL (gradient.coeff (c) - denseJacobian (i, c),
+			       1e-12);
+	}
+    }
+}
+
+BOOST_AUTO_TEST_CASE (distance_capsule_points_hessian)
+{
+  using namespace roboptim::capsule;
+
+  points_t points = 2. * points_t::Random (3, 20);
+
+  DistanceCapsulePoints denseFunction (points);
+  SparseDistanceCapsulePoints sparseFunction (points);
+
+  argument_t argument (7);
+  argument << -0.5, 0.2, 0.1, 0.7, -0.3, 0.4, 0.8;
+
+  for (size_type i = 0; i < points.cols (); ++i)
+    {
+      DistanceCapsulePoint pointDistance (points.col (i));
+
+      DistanceCapsulePoints::hessian_t hessian
+	= denseFunction.hessian (argument, i);
+      SparseDistanceCapsulePoints::hessian_t sparseHessian
+	= sparseFunction.hessian (argument, i);
+
+      BOOST_CHECK_SMALL ((hessian - pointDistance.hessian (argument)).norm (),
+			 1e-12);
+      BOOST_CHECK_SMALL ((DistanceCapsulePoints::hessian_t (sparseHessian)
+			  - hessian).norm (), 1e-12);
+    }
+}
@@ -0,0 +1,194 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE fit_cache
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/fit-cache.hh>
+#include <roboptim/capsule/fitter.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Unit cube centered in (0,0,0).
+  polyhedrons_t cube ()
+  {
+    polyhedron_t polyhedron;
+    for (int i = 0; i < 8; ++i)
+      polyhedron.push_back (point_t ((i & 1) ? 0.5 : -0.5,
+				     (i & 2) ? 0.5 : -0.5,
+				     (i & 4) ? 0.5 : -0.5));
+    return polyhedrons_t (1, polyhedron);
+  }
+
+  FitCache::entry_t makeEntry (value_type value)
+  {
+    FitCache::entry_t entry;
+    entry.initParam.setConstant (value);
+    entry.initVolume = 2. * value;
+    entry.solutionParam.setConstant (value + 1.);
+    entry.solutionVolume = value;
+    return entry;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (fit_cache_key)
+{
+  polyhedrons_t polyhedrons = cube ();
+  FitterOptions options = FitterOptions::quiet ();
+
+  FitCache::key_t key = FitCache::key (polyhedrons, "ipopt", options);
+  BOOST_CHECK_EQUAL (key, FitCache::key (polyhedrons, "ipopt", options));
+
+  // Log files and verbosity do not change the solution.
+  FitterOptions logOptions = options;
+  logOptions.solverLogFile = std::string ("fit-cache-ipopt.log");
+  logOptions.verbose = true;
+  BOOST_CHECK_EQUAL (key, FitCache::key (polyhedrons, "ipopt", logOptions));
+  BOOST_CHECK_EQUAL (key, FitCache::key (polyhedrons, "ipopt",
+					 FitterOptions::debug ()));
+
+  // Points, solver and options do.
+  polyhedrons_t moved = polyhedrons;
+  moved[0][3][1] += 1e-12;
+  BOOST_CHECK (key != FitCache::key (moved, "ipopt", options));
+
+  polyhedrons_t split (2);
+  split[0].assign (polyhedrons[0].begin (), polyhedrons[0].begin () + 4);
+  split[1].assign (polyhedrons[0].begin () + 4, polyhedrons[0].end ());
+  BOOST_CHECK (key != FitCache::key (split, "ipopt", options));
+
+  BOOST_CHECK (key != FitCache::key (polyhedrons, "ipopt-sparse", options));
+
+  FitterOptions tolOptions = options;
+  tolOptions.parameters["ipopt.tol"] = 1e-6;
+  BOOST_CHECK (key != FitCache::key (polyhedrons, "ipopt", tolOptions));
+
+  FitterOptions activeSetOptions = options;
+  activeSetOptions.useActiveSet = true;
+  BOOST_CHECK (key != FitCache::key (polyhedrons, "ipopt", activeSetOptions));
+}
+
+BOOST_AUTO_TEST_CASE (fit_cache_file)
+{
+  const std::string path = "fit-cache-test.bin";
+  std::remove (path.c_str ());
+
+  {
+    FitCache cache (path);
+    FitCache::entry_t entry;
+    BOOST_CHECK_EQUAL (cache.size (), 0);
+    BOOST_CHECK (!cache.find (1, entry));
+
+    cache.insert (1, makeEntry (1.));
+    cache.insert (2, makeEntry (2.));
+    BOOST_CHECK_EQUAL (cache.size (), 2);
+
+    BOOST_CHECK (cache.find (2, entry));
+    BOOST_CHECK_EQUAL (entry.solutionVolume, 2.);
+    BOOST_CHECK (!cache.find (3, entry));
+
+    // The latest record wins.
+    cache.insert (1, makeEntry (3.));
+    BOOST_CHECK (cache.find (1, entry));
+    BOOST_CHECK_EQUAL (entry.solutionVolume, 3.);
+  }
+
+  // Simulate an interrupted write.
+  {
+    std::ofstream file (path.c_str (), std::ios::binary | std::ios::app);
+    file.write ("partial", 7);
+  }
+
+  // Records persist across instances.
+  {
+    FitCache cache (path);
+    BOOST_CHECK_EQUAL (cache.size (), 3);
+
+    FitCache::entry_t entry;
+    BOOST_CHECK (cache.find (2, entry));
+    BOOST_CHECK (entry.initParam.isApprox (makeEntry (2.).initParam));
+    BOOST_CHECK_EQUAL (entry.initVolume, 4.);
+    BOOST_CHECK (entry.solutionParam.isApprox (makeEntry (2.).solutionParam));
+    BOOST_CHECK_EQUAL (entry.solutionVolume, 2.);
+
+    // The partial record is dropped before appending.
+    cache.insert (4, makeEntry (4.));
+    BOOST_CHECK_EQUAL (cache.size (), 4);
+    BOOST_CHECK (cache.find (4, entry));
+    BOOST_CHECK_EQUAL (entry.solutionVolume, 4.);
+    BOOST_CHECK (cache.find (2, entry));
+    BOOST_CHECK_EQUAL (entry.solutionVolume, 2.);
+  }
+
+  std::remove (path.c_str ());
+
+  // Other files are rejected.
+  {
+    std::ofstream file (path.c_str (), std::ios::binary);
+    file << "not a cache file";
+  }
+  BOOST_CHECK_THROW (FitCache cache (path), std::runtime_error);
+
+  std::remove (path.c_str ());
+}
+
+BOOST_AUTO_TEST_CASE (fit_cache_fitter)
+{
+  const std::string path = "fit-cache-fitter.bin";
+  std::remove (path.c_str ());
+
+  boost::shared_ptr<FitCache> cache = boost::make_shared<FitCache> (path);
+  polyhedrons_t polyhedrons = cube ();
+
+  Fitter fitter (polyhedrons);
+  fitter.cache () = cache;
+  fitter.computeBestFitCapsule ();
+  BOOST_CHECK (!fitter.stats ().cached);
+  BOOST_CHECK_EQUAL (fitter.status (), roboptim::GenericSolver::SOLVER_VALUE);
+  BOOST_CHECK_EQUAL (cache->size (), 1);
+
+  // The same fit is read from the cache, without any optimization.
+  Fitter cachedFitter (polyhedrons);
+  cachedFitter.cache () = cache;
+  cachedFitter.computeBestFitCapsule ();
+  BOOST_CHECK (cachedFitter.stats ().cached);
+  BOOST_CHECK_EQUAL (cachedFitter.solverIterations (), 0);
+  BOOST_CHECK_EQUAL (cachedFitter.status (), fitter.status ());
+  BOOST_CHECK (cachedFitter.solutionParam () == fitter.solutionParam ());
+  BOOST_CHECK_EQUAL (cachedFitter.solutionVolume (), fitter.solutionVolume ());
+  BOOST_CHECK (cachedFitter.initParam () == fitter.initParam ());
+  BOOST_CHECK_SMALL (cachedFitter.stats ().constraintViolation, 1e-6);
+  BOOST_CHECK_EQUAL (cache->size (), 1);
+
+  // Other options are a cache miss.
+  Fitter activeSetFitter (polyhedrons);
+  activeSetFitter.cache () = cache;
+  activeSetFitter.useActiveSet () = true;
+  activeSetFitter.computeBestFitCapsule ();
+  BOOST_CHECK (!activeSetFitter.stats ().cached);
+  BOOST_CHECK_EQUAL (cache->size (), 2);
+
+  std::remove (path.c_str ());
+}
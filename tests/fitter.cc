@@ -17,8 +17,13 @@
 
 #define BOOST_TEST_MODULE fitter
 
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <roboptim/capsule/util.hh>
 #include <roboptim/capsule/fitter.hh>
@@ -32,6 +37,16 @@
 
 using boost::test_tools::output_test_stream;
 
+namespace
+{
+  /// \brief Statistics callback storing the statistics of every fit.
+  void storeStats (std::vector<roboptim::capsule::FitStats>& allStats,
+		   const roboptim::capsule::FitStats& stats)
+  {
+    allStats.push_back (stats);
+  }
+} // end of anonymous namespace.
+
 BOOST_AUTO_TEST_CASE (fitter)
 {
   using namespace roboptim::capsule;
@@ -91,6 +106,19 @@ BOOST_AUTO_TEST_CASE (fitter)
   BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[4], 0.,epsilon);
   BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[5], 0.,epsilon);
   BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[6], 0.77191705555821011, epsilon)
+  BOOST_CHECK_GT (fitter_cube.solverIterations (), 0);
+
+  // Check the statistics of the fit.
+  const FitStats& stats = fitter_cube.stats ();
+  BOOST_CHECK_EQUAL (stats.iterations, fitter_cube.solverIterations ());
+  BOOST_CHECK_EQUAL (stats.status, fitter_cube.status ());
+  BOOST_CHECK_GT (stats.costEvaluations, 0);
+  BOOST_CHECK_GT (stats.costGradientEvaluations, 0);
+  BOOST_CHECK_GT (stats.constraintEvaluations, 0);
+  BOOST_CHECK_GT (stats.constraintJacobianEvaluations, 0);
+  BOOST_CHECK_GT (stats.solveTime, 0.);
+  BOOST_CHECK_EQUAL (stats.hullTime, 0.);
+  BOOST_CHECK_SMALL (stats.constraintViolation, 1e-5);
 
   polyhedrons.clear ();
   convexPolyhedrons.clear ();
@@ -109,9 +137,369 @@ BOOST_AUTO_TEST_CASE (fitter)
   computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
 
   Fitter fitter_rect (convexPolyhedrons);
+
+  // Statistics can also be retrieved with a callback.
+  std::vector<FitStats> allStats;
+  fitter_rect.statsCallback () = boost::bind (&storeStats,
+					      boost::ref (allStats), _1);
   computeBoundingCapsulePolyhedron (convexPolyhedrons,
 				    endPoint1, endPoint2, radius);
   convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
   fitter_rect.computeBestFitCapsule (initParam);
   std::cout << fitter_rect << std::endl;
+
+  BOOST_REQUIRE_EQUAL (allStats.size (), 1);
+  BOOST_CHECK_EQUAL (allStats[0].iterations, fitter_rect.solverIterations ());
+}
+
+BOOST_AUTO_TEST_CASE (fitter_sparse)
+{
+  using namespace roboptim::capsule;
+
+  // Build a rectangular box centered in (0,0,0).
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 1.5 : -1.5,
+				   (i & 2) ? 0.5 : -0.5,
+				   (i & 4) ? 0.5 : -0.5));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  // Solve the same problem with dense and sparse matrices.
+  Fitter denseFitter (polyhedrons);
+  denseFitter.computeBestFitCapsule (initParam);
+
+  Fitter sparseFitter (polyhedrons);
+  sparseFitter.useSparseMatrices () = true;
+  sparseFitter.computeBestFitCapsule (initParam);
+
+  BOOST_CHECK_CLOSE (sparseFitter.solutionVolume (),
+		     denseFitter.solutionVolume (), 1.);
+}
+
+namespace
+{
+  using namespace roboptim::capsule;
+  namespace fs = boost::filesystem;
+
+  /// \brief Fit a random cloud several times, from the convex hull
+  /// computation to the optimization.
+  void fitRepeatedly (const polyhedrons_t& polyhedrons,
+		      const FitterOptions& options,
+		      const fs::path& logDirectory, int threadId,
+		      int nbFits, std::vector<value_type>& volumes)
+  {
+    for (int k = 0; k < nbFits; ++k)
+      {
+	Fitter fitter (polyhedrons);
+	fitter.options () = options;
+
+	std::stringstream logFile;
+	logFile << "fitter-thread-" << threadId << "-" << k << "-ipopt.log";
+	fitter.solverLogFile () = (logDirectory / logFile.str ()).string ();
+
+	fitter.computeBestFitCapsule ();
+	volumes.push_back (fitter.solutionVolume ());
+      }
+  }
+
+  /// \brief Run many fits on many threads at the same time, and check
+  /// them against a reference volume.
+  void checkThreads (const polyhedrons_t& polyhedrons,
+		     const FitterOptions& options,
+		     value_type referenceVolume)
+  {
+    const int nbThreads = 8;
+    const int nbFits = 4;
+    std::vector<std::vector<value_type> > volumes (nbThreads);
+
+    // Log files are written to a temporary directory.
+    const fs::path logDirectory = fs::temp_directory_path ()
+      / fs::unique_path ("roboptim-capsule-%%%%-%%%%-%%%%");
+    fs::create_directories (logDirectory);
+
+    boost::thread_group threads;
+    for (int i = 0; i < nbThreads; ++i)
+      threads.create_thread (boost::bind (&fitRepeatedly,
+					  boost::cref (polyhedrons),
+					  boost::cref (options),
+					  boost::cref (logDirectory), i,
+					  nbFits, boost::ref (volumes[i])));
+    threads.join_all ();
+
+    for (int i = 0; i < nbThreads; ++i)
+      {
+	BOOST_REQUIRE_EQUAL (volumes[i].size (), nbFits);
+	for (int k = 0; k < nbFits; ++k)
+	  {
+	    BOOST_CHECK_CLOSE (volumes[i][k], referenceVolume, 1e-6);
+
+	    // Each fit wrote its own log file.
+	    std::stringstream logFile;
+	    logFile << "fitter-thread-" << i << "-" << k << "-ipopt.log";
+	    BOOST_CHECK (fs::exists (logDirectory / logFile.str ()));
+	  }
+      }
+
+    fs::remove_all (logDirectory);
+  }
+
+  /// \brief Random cloud along the x axis.
+  polyhedrons_t randomCloud ()
+  {
+    polyhedron_t polyhedron;
+    for (int i = 0; i < 200; ++i)
+      polyhedron.push_back (point_t::Random ().cwiseProduct
+			    (point_t (2., 0.5, 0.5)));
+    return polyhedrons_t (1, polyhedron);
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (fitter_threads)
+{
+  using namespace roboptim::capsule;
+
+  const polyhedrons_t polyhedrons = randomCloud ();
+
+  // Reference fit.
+  Fitter reference (polyhedrons);
+  reference.computeBestFitCapsule ();
+
+  // With MUMPS, the default linear solver, the optimizations are
+  // serialized.
+  checkThreads (polyhedrons, FitterOptions::quiet (),
+		reference.solutionVolume ());
+}
+
+BOOST_AUTO_TEST_CASE (fitter_threads_without_lock)
+{
+  using namespace roboptim::capsule;
+
+  const polyhedrons_t polyhedrons = randomCloud ();
+
+  // Other linear solvers are not serialized. MA27 is only available
+  // if Ipopt is built with the HSL solvers.
+  FitterOptions options = FitterOptions::quiet ();
+  options.parameters["ipopt.linear_solver"] = std::string ("ma27");
+
+  Fitter reference (polyhedrons);
+  reference.options () = options;
+  reference.computeBestFitCapsule ();
+  if (reference.status () != roboptim::GenericSolver::SOLVER_VALUE
+      && reference.status () != roboptim::GenericSolver::SOLVER_VALUE_WARNINGS)
+    {
+      BOOST_TEST_MESSAGE ("MA27 is not available, test skipped.");
+      return;
+    }
+
+  checkThreads (polyhedrons, options, reference.solutionVolume ());
+}
+
+BOOST_AUTO_TEST_CASE (fitter_active_set)
+{
+  using namespace roboptim::capsule;
+
+  // Points sampled on an elongated ellipsoid: all of them are on the
+  // convex hull.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 500; ++i)
+    polyhedron.push_back (point_t::Random ().normalized ().cwiseProduct
+			  (point_t (2., 0.6, 0.4)));
+  polyhedrons_t polyhedrons (1, polyhedron);
+
+  Fitter fullFitter (polyhedrons);
+  fullFitter.computeBestFitCapsule ();
+
+  Fitter activeSetFitter (polyhedrons);
+  activeSetFitter.useActiveSet () = true;
+  activeSetFitter.computeBestFitCapsule ();
+
+  BOOST_CHECK_CLOSE (activeSetFitter.solutionVolume (),
+		     fullFitter.solutionVolume (), 1e-1);
+
+  // The last optimization only involved a few of the hull points.
+  BOOST_CHECK_LT (activeSetFitter.activeSetSize (),
+		  fullFitter.activeSetSize ());
+
+  // All points are inside the capsule.
+  DistanceCapsulePoints distances (polyhedrons);
+  vector_t d = distances (activeSetFitter.solutionParam ());
+  BOOST_CHECK_LT (d.maxCoeff (), 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_pruning)
+{
+  using namespace roboptim::capsule;
+
+  // Points sampled on an elongated ellipsoid: those near the flat
+  // sides are deep inside the initial capsule.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 500; ++i)
+    polyhedron.push_back (point_t::Random ().normalized ().cwiseProduct
+			  (point_t (2., 0.6, 0.3)));
+  polyhedrons_t polyhedrons (1, polyhedron);
+
+  Fitter fullFitter (polyhedrons);
+  fullFitter.computeBestFitCapsule ();
+  BOOST_CHECK_EQUAL (fullFitter.stats ().prunedPoints, 0);
+
+  Fitter prunedFitter (polyhedrons);
+  prunedFitter.usePruning () = true;
+  prunedFitter.computeBestFitCapsule ();
+
+  BOOST_CHECK_CLOSE (prunedFitter.solutionVolume (),
+		     fullFitter.solutionVolume (), 1e-1);
+
+  // Fewer points constrained the optimization.
+  BOOST_CHECK_GT (prunedFitter.stats ().prunedPoints, 0);
+  BOOST_CHECK_EQUAL (prunedFitter.activeSetSize ()
+		     + prunedFitter.stats ().prunedPoints,
+		     fullFitter.activeSetSize ());
+
+  // All points are inside the capsule.
+  BOOST_CHECK_LT (prunedFitter.stats ().constraintViolation, 1e-5);
+
+  // A deeper pruning threshold prunes fewer points.
+  Fitter deepFitter (polyhedrons);
+  deepFitter.usePruning () = true;
+  deepFitter.options ().pruningDepth = 0.5;
+  deepFitter.computeBestFitCapsule ();
+  BOOST_CHECK_LE (deepFitter.stats ().prunedPoints,
+		  prunedFitter.stats ().prunedPoints);
+  BOOST_CHECK_LT (deepFitter.stats ().constraintViolation, 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_options)
+{
+  using namespace roboptim::capsule;
+
+  // The quiet preset is the default, and does not run the derivative
+  // test nor write a log file.
+  FitterOptions quiet = FitterOptions::quiet ();
+  BOOST_CHECK (quiet.parameters.find ("ipopt.derivative_test")
+	       == quiet.parameters.end ());
+  BOOST_CHECK (!quiet.solverLogFile);
+  BOOST_CHECK (!quiet.verbose);
+
+  FitterOptions debug = FitterOptions::debug ();
+  BOOST_CHECK (debug.parameters.find ("ipopt.derivative_test")
+	       != debug.parameters.end ());
+  BOOST_CHECK (debug.solverLogFile);
+  BOOST_CHECK (debug.verbose);
+
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 1.5 : -1.5,
+				   (i & 2) ? 0.5 : -0.5,
+				   (i & 4) ? 0.5 : -0.5));
+  polyhedrons_t polyhedrons (1, polyhedron);
+
+  Fitter quietFitter (polyhedrons);
+  BOOST_CHECK (!quietFitter.options ().verbose);
+  BOOST_CHECK (!quietFitter.solverLogFile ());
+  quietFitter.computeBestFitCapsule ();
+
+  // Debug preset with a user override. The log file is written to a
+  // temporary directory.
+  const fs::path logDirectory = fs::temp_directory_path ()
+    / fs::unique_path ("roboptim-capsule-%%%%-%%%%-%%%%");
+  fs::create_directories (logDirectory);
+  const fs::path logFile = logDirectory / "fitter-options-ipopt.log";
+
+  Fitter debugFitter (polyhedrons);
+  debugFitter.options () = FitterOptions::debug ();
+  debugFitter.options ().solverLogFile = logFile.string ();
+  debugFitter.options ().parameters["ipopt.tol"] = 1e-6;
+  debugFitter.computeBestFitCapsule ();
+
+  BOOST_CHECK (fs::exists (logFile));
+  BOOST_CHECK_CLOSE (debugFitter.solutionVolume (),
+		     quietFitter.solutionVolume (), 1.);
+
+  fs::remove_all (logDirectory);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_refit)
+{
+  using namespace roboptim::capsule;
+
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 300; ++i)
+    polyhedron.push_back (point_t::Random ().cwiseProduct
+			  (point_t (2., 0.6, 0.4)));
+  polyhedrons_t polyhedrons (1, polyhedron);
+
+  Fitter fitter (polyhedrons);
+  BOOST_CHECK (fitter.refit (polyhedrons));
+  argument_t solutionParam = fitter.solutionParam ();
+  value_type volume = fitter.solutionVolume ();
+
+  // Same points: nothing to do.
+  BOOST_CHECK (!fitter.refit (polyhedrons));
+  BOOST_CHECK_EQUAL (fitter.solutionParam (), solutionParam);
+
+  // Points added inside the capsule: nothing to do.
+  polyhedrons_t inside = polyhedrons;
+  for (int i = 0; i < 100; ++i)
+    inside[0].push_back (0.5 * point_t::Random ());
+  BOOST_CHECK (!fitter.refit (inside));
+  BOOST_CHECK_EQUAL (fitter.solutionParam (), solutionParam);
+  BOOST_CHECK_EQUAL (fitter.stats ().iterations, 0);
+
+  // Point added outside of the capsule: the capsule grows.
+  polyhedrons_t outside = polyhedrons;
+  outside[0].push_back (point_t (2.5, 0., 0.));
+  BOOST_CHECK (fitter.refit (outside));
+  BOOST_CHECK_GT (fitter.solutionVolume (), volume);
+  BOOST_CHECK_SMALL (fitter.stats ().constraintViolation, 1e-5);
+
+  Fitter reference (outside);
+  reference.computeBestFitCapsule ();
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), reference.solutionVolume (), 1.);
+
+  // Extreme points removed: the capsule may shrink.
+  polyhedrons_t shrunk (1);
+  BOOST_FOREACH (const point_t& p, polyhedron)
+    if (std::fabs (p[0]) < 1.5)
+      shrunk[0].push_back (p);
+  BOOST_CHECK (fitter.refit (shrunk));
+
+  reference.polyhedrons (shrunk);
+  reference.computeBestFitCapsule ();
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), reference.solutionVolume (), 1.);
+  BOOST_CHECK_LT (fitter.solutionVolume (), volume);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_points)
+{
+  using namespace roboptim::capsule;
+
+  // Box vertices given as the columns of a matrix.
+  points_t points (3, 8);
+  for (int i = 0; i < 8; ++i)
+    points.col (i) = point_t ((i & 1) ? 1. : -1.,
+			      (i & 2) ? 0.5 : -0.5,
+			      (i & 4) ? 0.25 : -0.25);
+
+  Fitter fitter (points);
+  BOOST_REQUIRE_EQUAL (fitter.polyhedrons ().size (), 1);
+  BOOST_CHECK_EQUAL (fitter.polyhedrons ()[0].size (), 8);
+  fitter.computeBestFitCapsule ();
+
+  polyhedron_t polyhedron;
+  convertPointsToPolyhedron (polyhedron, points);
+  Fitter reference (polyhedrons_t (1, polyhedron));
+  reference.computeBestFitCapsule ();
+
+  BOOST_CHECK (fitter.status () == reference.status ());
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), reference.solutionVolume (),
+		     1e-9);
 }
@@ -0,0 +1,153 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE geometry
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/geometry.hh>
+#include <roboptim/capsule/fitter.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Random points along a bent tube.
+  Geometry::points_t tube (size_type n, const point_t& offset)
+  {
+    Geometry::points_t points (3, n);
+    for (size_type i = 0; i < n; ++i)
+      {
+	value_type t = static_cast<value_type> (i)
+	  / static_cast<value_type> (n);
+	points.col (i) = offset + point_t (4. * t, 0.3 * t * t, 0.)
+	  + 0.5 * point_t::Random ();
+      }
+    return points;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (float_kernels)
+{
+  const Geometry::points_t points = tube (1000, point_t::Zero ());
+  const FloatGeometry::points_t fpoints = points.cast<float> ();
+  const point_t a (0.5, 0.1, -0.2);
+  const point_t b (3.5, 0.2, 0.3);
+  const FloatGeometry::point_t fa = a.cast<float> ();
+  const FloatGeometry::point_t fb = b.cast<float> ();
+
+  // Batched kernels agree with double precision up to float rounding.
+  vector_t distances (points.cols ());
+  FloatGeometry::vector_t fdistances (points.cols ());
+  Geometry::distancesPointsToSegment (points, a, b, distances);
+  FloatGeometry::distancesPointsToSegment (fpoints, fa, fb, fdistances);
+  BOOST_CHECK_SMALL ((distances - fdistances.cast<value_type> ())
+		     .cwiseAbs ().maxCoeff (), 1e-5);
+
+  vector_t lambdas (points.cols ());
+  FloatGeometry::vector_t flambdas (points.cols ());
+  Geometry::projectionParametersOnSegment (points, a, b, lambdas);
+  FloatGeometry::projectionParametersOnSegment (fpoints, fa, fb, flambdas);
+  BOOST_CHECK_SMALL ((lambdas - flambdas.cast<value_type> ())
+		     .cwiseAbs ().maxCoeff (), 1e-5);
+
+  for (size_type i = 0; i < points.cols (); i += 97)
+    BOOST_CHECK_CLOSE (static_cast<value_type>
+		       (FloatGeometry::distancePointToSegment
+			(fpoints.col (i), fa, fb)),
+		       distancePointToSegment (points.col (i), a, b), 1e-3);
+
+  // Statistics.
+  point_t mean, lower, upper;
+  Geometry::matrix3_t covariance;
+  Geometry::statistics (points, mean, covariance, lower, upper);
+  BOOST_CHECK_SMALL ((mean - points.rowwise ().mean ()).norm (), 1e-12);
+  BOOST_CHECK (lower == points.rowwise ().minCoeff ());
+  BOOST_CHECK (upper == points.rowwise ().maxCoeff ());
+
+  FloatGeometry::point_t fmean, flower, fupper;
+  FloatGeometry::matrix3_t fcovariance;
+  FloatGeometry::statistics (fpoints, fmean, fcovariance, flower, fupper);
+  BOOST_CHECK_SMALL ((mean - fmean.cast<value_type> ()).norm (), 1e-5);
+  BOOST_CHECK_SMALL ((covariance - fcovariance.cast<value_type> ())
+		     .norm (), 1e-5);
+  BOOST_CHECK (flower == fpoints.rowwise ().minCoeff ());
+  BOOST_CHECK (fupper == fpoints.rowwise ().maxCoeff ());
+
+  int imin, imax, fimin, fimax;
+  extremePointsAlongDirection (vector3_t::UnitX (), points, imin, imax);
+  FloatGeometry::extremePointsAlongDirection
+    (FloatGeometry::vector3_t::UnitX (), fpoints, fimin, fimax);
+  BOOST_CHECK_EQUAL (imin, fimin);
+  BOOST_CHECK_EQUAL (imax, fimax);
+}
+
+BOOST_AUTO_TEST_CASE (conservative_capsule)
+{
+  // Near and far from the origin: the inflation scales with the
+  // distance of the points to the origin.
+  const point_t offsets[] = {point_t::Zero (), point_t (1e3, -2e3, 5e2)};
+  for (int k = 0; k < 2; ++k)
+    {
+      const FloatGeometry::points_t fpoints =
+	tube (5000, offsets[k]).cast<float> ();
+      const Geometry::points_t points = fpoints.cast<value_type> ();
+
+      // Every float point is inside the double capsule.
+      const Capsule capsule = boundingCapsule (fpoints);
+      vector_t distances (points.cols ());
+      distancesPointsToSegment (points, capsule.P0, capsule.P1, distances);
+      BOOST_CHECK_LE (distances.maxCoeff (), capsule.radius);
+
+      // The inflation is within the documented bound.
+      const value_type scale = std::max (capsule.P0.norm (),
+					 capsule.P1.norm ()) + capsule.radius;
+      BOOST_CHECK_LE (capsule.radius - distances.maxCoeff (),
+		      FloatGeometry::radiusInflation (scale)
+		      + 16. * std::ldexp (1., -24) * scale);
+
+      // Same capsule as in double precision, up to float rounding.
+      const Geometry::capsule_t reference =
+	Geometry::boundingCapsule (points);
+      BOOST_CHECK_SMALL (capsule.radius - reference.radius, 1e-4 * scale);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (double_polishing)
+{
+  // The float capsule is a feasible initial guess of the fitter, which
+  // polishes it in double precision.
+  const Geometry::points_t points = tube (200, point_t::Zero ());
+  const Capsule capsule = boundingCapsule (points.cast<float> ());
+
+  Fitter fitter (points);
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, capsule.P0, capsule.P1,
+			       capsule.radius);
+  fitter.computeBestFitCapsule (initParam);
+
+  const argument_t& param = fitter.solutionParam ();
+  BOOST_CHECK_LE (fitter.solutionVolume (), fitter.initVolume () + 1e-10);
+  point_t P0 = param.segment<3> (0);
+  point_t P1 = param.segment<3> (3);
+  for (size_type i = 0; i < points.cols (); ++i)
+    BOOST_CHECK_LE (distancePointToSegment (points.col (i), P0, P1),
+		    param[6] + 1e-6);
+}
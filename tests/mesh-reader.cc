@@ -0,0 +1,230 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE mesh_reader
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/mesh-reader.hh>
+#include <roboptim/capsule/util.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Triangle used by every test mesh.
+  polyhedron_t triangle ()
+  {
+    polyhedron_t points;
+    points.push_back (point_t (0., 0., 0.));
+    points.push_back (point_t (1., 0., 0.5));
+    points.push_back (point_t (0., -2., 1.25));
+    return points;
+  }
+
+  void append (polyhedron_t& points, size_t& nbChunks,
+	       const polyhedron_t& chunk)
+  {
+    points.insert (points.end (), chunk.begin (), chunk.end ());
+    ++nbChunks;
+  }
+
+  /// \brief Read a whole mesh from a string.
+  polyhedron_t readString (const std::string& data, MeshFormat format,
+			   size_t chunkSize = 1 << 16)
+  {
+    polyhedron_t points;
+    size_t nbChunks = 0;
+    std::istringstream input (data);
+    size_t n = readMesh (input, format,
+			 boost::bind (&append, boost::ref (points),
+				      boost::ref (nbChunks), _1),
+			 chunkSize);
+    BOOST_CHECK_EQUAL (n, points.size ());
+    return points;
+  }
+
+  template <typename T>
+  void write (std::ostream& os, T value)
+  {
+    os.write (reinterpret_cast<const char*> (&value), sizeof (T));
+  }
+
+  void checkPoints (const polyhedron_t& points, const polyhedron_t& expected)
+  {
+    BOOST_REQUIRE_EQUAL (points.size (), expected.size ());
+    for (size_t i = 0; i < points.size (); ++i)
+      BOOST_CHECK (points[i].isApprox (expected[i], 1e-6)
+		   || points[i] == expected[i]);
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (mesh_reader_ply)
+{
+  const polyhedron_t expected = triangle ();
+
+  std::stringstream ascii;
+  ascii << "ply\nformat ascii 1.0\ncomment test\n"
+	<< "element vertex 3\nproperty float x\nproperty float y\n"
+	<< "property float z\nproperty uchar red\n"
+	<< "element face 1\nproperty list uchar int vertex_indices\n"
+	<< "end_header\n";
+  for (size_t i = 0; i < expected.size (); ++i)
+    ascii << expected[i].transpose () << " 255\n";
+  ascii << "3 0 1 2\n";
+  checkPoints (readString (ascii.str (), MESH_FORMAT_PLY), expected);
+  checkPoints (readString (ascii.str (), MESH_FORMAT_AUTO), expected);
+
+  // Binary, with a list element before the vertices.
+  std::stringstream binary;
+  binary << "ply\r\nformat binary_little_endian 1.0\r\n"
+	 << "element face 1\r\nproperty list uchar int vertex_indices\r\n"
+	 << "element vertex 3\r\nproperty double z\r\nproperty short id\r\n"
+	 << "property double x\r\nproperty double y\r\nend_header\r\n";
+  write<unsigned char> (binary, 3);
+  for (int k = 0; k < 3; ++k)
+    write<int> (binary, k);
+  for (size_t i = 0; i < expected.size (); ++i)
+    {
+      write<double> (binary, expected[i][2]);
+      write<short> (binary, static_cast<short> (i));
+      write<double> (binary, expected[i][0]);
+      write<double> (binary, expected[i][1]);
+    }
+  checkPoints (readString (binary.str (), MESH_FORMAT_PLY), expected);
+
+  BOOST_CHECK_THROW (readString ("ply\nformat ascii 1.0\nelement vertex 1\n"
+				 "property float x\nend_header\n0\n",
+				 MESH_FORMAT_PLY), std::runtime_error);
+  BOOST_CHECK_THROW (readString ("ply\nformat ascii 1.0\nelement vertex 2\n"
+				 "property float x\nproperty float y\n"
+				 "property float z\nend_header\n0 0 0\n",
+				 MESH_FORMAT_PLY), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_stl)
+{
+  const polyhedron_t expected = triangle ();
+
+  std::stringstream ascii;
+  ascii << "solid test\n  facet normal 0 0 1\n    outer loop\n";
+  for (size_t i = 0; i < expected.size (); ++i)
+    ascii << "      vertex " << expected[i].transpose () << "\n";
+  ascii << "    endloop\n  endfacet\nendsolid test\n";
+  checkPoints (readString (ascii.str (), MESH_FORMAT_STL), expected);
+  checkPoints (readString (ascii.str (), MESH_FORMAT_AUTO), expected);
+
+  // Binary, whose header starts with "solid".
+  std::stringstream binary;
+  std::string header ("solid binary");
+  header.resize (80, ' ');
+  binary << header;
+  write<unsigned int> (binary, 2);
+  for (int t = 0; t < 2; ++t)
+    {
+      for (int k = 0; k < 3; ++k)
+	write<float> (binary, 0.f);
+      for (size_t i = 0; i < expected.size (); ++i)
+	for (int k = 0; k < 3; ++k)
+	  write<float> (binary, static_cast<float> (expected[i][k]));
+      write<unsigned short> (binary, 0);
+    }
+  polyhedron_t twice = expected;
+  twice.insert (twice.end (), expected.begin (), expected.end ());
+  checkPoints (readString (binary.str (), MESH_FORMAT_STL), twice);
+
+  BOOST_CHECK_THROW (readString (binary.str ().substr (0, 120),
+				 MESH_FORMAT_STL), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_obj_xyz)
+{
+  const polyhedron_t expected = triangle ();
+
+  std::stringstream obj;
+  obj << "# test\no triangle\n";
+  for (size_t i = 0; i < expected.size (); ++i)
+    obj << "v " << expected[i].transpose () << "\nvn 0 0 1\nvt 0 0\n";
+  obj << "f 1 2 3";
+  checkPoints (readString (obj.str (), MESH_FORMAT_OBJ), expected);
+
+  std::stringstream xyz;
+  for (size_t i = 0; i < expected.size (); ++i)
+    for (int k = 0; k < 3; ++k)
+      write<double> (xyz, expected[i][k]);
+  checkPoints (readString (xyz.str (), MESH_FORMAT_XYZ), expected);
+
+  BOOST_CHECK_THROW (readString (xyz.str () + "x", MESH_FORMAT_XYZ),
+		     std::runtime_error);
+
+  // OBJ and xyz inputs cannot be detected from their content.
+  BOOST_CHECK_THROW (readString (obj.str (), MESH_FORMAT_AUTO),
+		     std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_chunks)
+{
+  // Large enough to span several stream blocks.
+  std::stringstream xyz;
+  const size_t n = 100000;
+  for (size_t i = 0; i < n; ++i)
+    for (int k = 0; k < 3; ++k)
+      write<double> (xyz, static_cast<double> (3 * i + k));
+
+  polyhedron_t points;
+  size_t nbChunks = 0;
+  BOOST_CHECK_EQUAL (readMesh (xyz, MESH_FORMAT_XYZ,
+			       boost::bind (&append, boost::ref (points),
+					    boost::ref (nbChunks), _1),
+			       1000), n);
+  BOOST_CHECK_EQUAL (nbChunks, n / 1000);
+  BOOST_REQUIRE_EQUAL (points.size (), n);
+  for (size_t i = 0; i < n; ++i)
+    BOOST_CHECK_EQUAL (points[i][0], static_cast<double> (3 * i));
+
+  // Memory-mapped file.
+  const std::string path = "mesh-reader-test.xyz";
+  {
+    std::ofstream file (path.c_str (), std::ios::binary);
+    file << xyz.str ();
+  }
+  // The raw format is not guessed from the extension, usually used
+  // by ASCII point lists.
+  BOOST_CHECK_EQUAL (meshFormatFromPath (path), MESH_FORMAT_AUTO);
+
+  ConvexHullAccumulator hull (1000);
+  void (ConvexHullAccumulator::*add) (const polyhedron_t&)
+    = &ConvexHullAccumulator::add;
+  BOOST_CHECK_THROW (readMeshFile (path, MESH_FORMAT_AUTO,
+				   boost::bind (add, &hull, _1), 1000),
+		     std::runtime_error);
+  BOOST_CHECK_EQUAL (readMeshFile (path, MESH_FORMAT_XYZ,
+				   boost::bind (add, &hull, _1), 1000), n);
+  BOOST_CHECK_EQUAL (hull.nbPoints (), n);
+
+  // All points are collinear.
+  BOOST_CHECK_EQUAL (hull.hull ().size (), 2);
+
+  std::remove (path.c_str ());
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE multi_fitter
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/capsule/util.hh>
+#include <roboptim/capsule/multi-fitter.hh>
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Grid of points over a box.
+  void addBox (polyhedron_t& points, const point_t& lower,
+	       const point_t& upper, int n)
+  {
+    for (int i = 0; i <= n; ++i)
+      for (int j = 0; j <= 2; ++j)
+	for (int k = 0; k <= 2; ++k)
+	  {
+	    point_t t (i / static_cast<value_type> (n), j / 2., k / 2.);
+	    if (upper[1] - lower[1] > upper[0] - lower[0])
+	      std::swap (t[0], t[1]);
+	    points.push_back (lower + t.cwiseProduct (upper - lower));
+	  }
+  }
+
+  /// \brief L-shaped link: two bars sharing a corner.
+  polyhedron_t lShape ()
+  {
+    polyhedron_t points;
+    addBox (points, point_t (0., 0., 0.), point_t (4., 0.5, 0.5), 16);
+    addBox (points, point_t (0., 0., 0.), point_t (0.5, 4., 0.5), 16);
+    return points;
+  }
+
+  /// \brief Check that each point is inside its capsule.
+  void checkContainment (const MultiFitter& fitter)
+  {
+    const polyhedron_t& points = fitter.polyhedron ();
+    const std::vector<Capsule> capsules = fitter.capsules ();
+    BOOST_REQUIRE_EQUAL (fitter.labels ().size (), points.size ());
+
+    for (size_t j = 0; j < points.size (); ++j)
+      {
+	BOOST_REQUIRE_LT (fitter.labels ()[j], capsules.size ());
+	const Capsule& c = capsules[fitter.labels ()[j]];
+	BOOST_CHECK_LE (distancePointToSegment (points[j], c.P0, c.P1),
+			c.radius + 1e-12);
+      }
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (multi_fitter_fixed)
+{
+  MultiFitter fitter (lShape ());
+  fitter.nbCapsules () = 2;
+  fitter.nbThreads () = 2;
+  fitter.computeBestFitCapsules ();
+
+  BOOST_CHECK_EQUAL (fitter.solutionParams ().size (), 2);
+  checkContainment (fitter);
+
+  // Two capsules along the bars are much smaller than a single one.
+  BOOST_CHECK_LT (fitter.solutionVolume (), 0.5 * fitter.singleVolume ());
+
+  value_type volume = 0.;
+  const std::vector<Capsule> capsules = fitter.capsules ();
+  for (size_t i = 0; i < capsules.size (); ++i)
+    volume += M_PI * capsules[i].radius * capsules[i].radius
+      * (capsules[i].P1 - capsules[i].P0).norm ()
+      + 4. / 3. * M_PI * std::pow (capsules[i].radius, 3);
+  BOOST_CHECK_CLOSE (fitter.solutionVolume (), volume, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE (multi_fitter_automatic)
+{
+  MultiFitter fitter (lShape ());
+  fitter.maxCapsules () = 4;
+  fitter.volumeRatio () = 0.6;
+  fitter.computeBestFitCapsules ();
+
+  BOOST_CHECK_GE (fitter.solutionParams ().size (), 2);
+  BOOST_CHECK_LE (fitter.solutionParams ().size (), 4);
+  BOOST_CHECK_LE (fitter.solutionVolume (), 0.6 * fitter.singleVolume ());
+  checkContainment (fitter);
+
+  // A single capsule fits a straight bar: no split pays off.
+  polyhedron_t bar;
+  addBox (bar, point_t (0., 0., 0.), point_t (4., 0.5, 0.5), 16);
+  fitter.polyhedron (bar);
+  fitter.volumeRatio () = 0.1;
+  fitter.computeBestFitCapsules ();
+  BOOST_CHECK_EQUAL (fitter.solutionParams ().size (), 1);
+  BOOST_CHECK_EQUAL (fitter.solutionVolume (), fitter.singleVolume ());
+  checkContainment (fitter);
+}
+
+BOOST_AUTO_TEST_CASE (multi_fitter_small)
+{
+  // Too few points to be split.
+  polyhedron_t polyhedron;
+  polyhedron.push_back (point_t (0., 0., 0.));
+  polyhedron.push_back (point_t (1., 0., 0.));
+  polyhedron.push_back (point_t (0., 1., 0.));
+  polyhedron.push_back (point_t (0., 0., 1.));
+  polyhedron.push_back (point_t (1., 1., 1.));
+
+  MultiFitter fitter (polyhedron);
+  fitter.nbCapsules () = 3;
+  fitter.computeBestFitCapsules ();
+  BOOST_CHECK_EQUAL (fitter.solutionParams ().size (), 1);
+  checkContainment (fitter);
+}
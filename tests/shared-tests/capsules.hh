@@ -0,0 +1,69 @@
+// Copyright (C) 2026 by CNRS-LIRMM.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file tests/shared-tests/capsules.hh
+ *
+ * \brief Capsules shared by the tests of the capsule queries.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_TESTS_SHARED_TESTS_CAPSULES_HH
+# define ROBOPTIM_CAPSULE_TESTS_SHARED_TESTS_CAPSULES_HH
+
+# include <vector>
+
+# include <roboptim/capsule/util.hh>
+
+/// \brief Build a capsule from its end points and radius.
+inline roboptim::capsule::Capsule
+makeCapsule (const roboptim::capsule::point_t& P0,
+	     const roboptim::capsule::point_t& P1,
+	     roboptim::capsule::value_type radius)
+{
+  roboptim::capsule::Capsule capsule;
+  capsule.P0 = P0;
+  capsule.P1 = P1;
+  capsule.radius = radius;
+  return capsule;
+}
+
+/// \brief Random capsules in a cube, some of them degenerate (spheres)
+/// or parallel to the first one.
+///
+/// \param n number of capsules.
+/// \param side side of the cube containing the first end points.
+inline std::vector<roboptim::capsule::Capsule>
+randomCapsules (size_t n, roboptim::capsule::value_type side)
+{
+  using roboptim::capsule::point_t;
+
+  std::vector<roboptim::capsule::Capsule> capsules;
+  for (size_t i = 0; i < n; ++i)
+    {
+      point_t P0 = 0.5 * side * point_t::Random ();
+      point_t P1 = P0 + point_t::Random ();
+      if (i % 7 == 3)
+	P1 = P0;
+      if (i % 11 == 5)
+	P1 = P0 + 0.5 * (capsules[0].P1 - capsules[0].P0);
+      capsules.push_back (makeCapsule (P0, P1, 0.1 + 0.1 * (i % 5)));
+    }
+  return capsules;
+}
+
+#endif //! ROBOPTIM_CAPSULE_TESTS_SHARED_TESTS_CAPSULES_HH
@@ -70,3 +70,281 @@ BOOST_AUTO_TEST_CASE (util)
   BOOST_CHECK_SMALL_OR_CLOSE ((p2 - projectionOnSegment (p3, a, b)).norm (), 0., epsilon);
   BOOST_CHECK_SMALL_OR_CLOSE (((a + 0.25 * dir_x) - projectionOnSegment (p4, a, b)).norm (), 0., epsilon);
 }
+
+BOOST_AUTO_TEST_CASE (convex_hull)
+{
+  using namespace roboptim::capsule;
+
+  // Empty and degenerate inputs.
+  std::vector<point_t> points;
+  BOOST_CHECK (convexHullFromPoints (points).empty ());
+
+  points.assign (5, point_t (1., 2., 3.));
+  BOOST_CHECK_EQUAL (convexHullFromPoints (points).size (), 1);
+
+  // Collinear points: only the end points are kept.
+  points.clear ();
+  for (int i = 0; i <= 10; ++i)
+    points.push_back (point_t (0.1 * i, 0.2 * i, -0.3 * i));
+  polyhedron_t hull = convexHullFromPoints (points);
+  BOOST_CHECK_EQUAL (hull.size (), 2);
+
+  // Coplanar grid: only the corners of the square are kept.
+  points.clear ();
+  for (int i = 0; i <= 10; ++i)
+    for (int j = 0; j <= 10; ++j)
+      points.push_back (point_t (i, j, 2.));
+  hull = convexHullFromPoints (points);
+  BOOST_CHECK_EQUAL (hull.size (), 4);
+
+  // Cubic grid: points on faces and edges are not vertices.
+  points.clear ();
+  for (int i = 0; i <= 4; ++i)
+    for (int j = 0; j <= 4; ++j)
+      for (int k = 0; k <= 4; ++k)
+	points.push_back (point_t (i, j, k));
+  hull = convexHullFromPoints (points);
+  BOOST_CHECK_EQUAL (hull.size (), 8);
+  for (size_t i = 0; i < hull.size (); ++i)
+    for (int c = 0; c < 3; ++c)
+      BOOST_CHECK (hull[i][c] == 0. || hull[i][c] == 4.);
+
+  // Points on a sphere surrounding random interior points: the hull
+  // vertices are exactly the points of the sphere.
+  points.clear ();
+  const size_t nSphere = 500;
+  for (size_t i = 0; i < 5000; ++i)
+    {
+      point_t p = point_t::Random ();
+      if (p.norm () < 0.9)
+	points.push_back (p);
+    }
+  for (size_t i = 0; i < nSphere; ++i)
+    points.push_back (point_t::Random ().normalized ());
+  hull = convexHullFromPoints (points);
+  BOOST_CHECK_EQUAL (hull.size (), nSphere);
+  for (size_t i = 0; i < hull.size (); ++i)
+    BOOST_CHECK_SMALL (hull[i].norm () - 1., 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (convex_hull_accumulator)
+{
+  using namespace roboptim::capsule;
+
+  // Random interior points interleaved with points on a sphere, added
+  // with a small buffer: the hull is the same as in one pass.
+  ConvexHullAccumulator accumulator (64);
+  const size_t nSphere = 300;
+  size_t n = 0;
+  for (size_t i = 0; i < nSphere; ++i)
+    {
+      for (int k = 0; k < 10; ++k, ++n)
+	accumulator.add (point_t (0.5 * point_t::Random ()));
+      accumulator.add (point_t (point_t::Random ().normalized ()));
+      ++n;
+    }
+
+  BOOST_CHECK_EQUAL (accumulator.nbPoints (), n);
+  const polyhedron_t& hull = accumulator.hull ();
+  BOOST_CHECK_EQUAL (hull.size (), nSphere);
+  for (size_t i = 0; i < hull.size (); ++i)
+    BOOST_CHECK_SMALL (hull[i].norm () - 1., 1e-12);
+
+  // Points added after the hull was computed are taken into account.
+  accumulator.add (point_t (2., 0., 0.));
+  BOOST_CHECK_EQUAL (accumulator.hull ().size (), nSphere + 1);
+}
+
+BOOST_AUTO_TEST_CASE (active_set_seed)
+{
+  using namespace roboptim::capsule;
+
+  // Box elongated along x: the seed contains both ends of the box.
+  std::vector<point_t> points;
+  for (int i = 0; i < 1000; ++i)
+    points.push_back (point_t::Random ().cwiseProduct (point_t (3., 1., 0.5)));
+  points.push_back (point_t (-4., 0., 0.));
+  points.push_back (point_t (4., 0., 0.));
+
+  vector3_t axis = largestSpreadDirection (points);
+  BOOST_CHECK_CLOSE (std::fabs (axis[0]), 1., 1.);
+
+  std::vector<size_t> seed;
+  activeSetSeed (points, seed);
+  BOOST_CHECK_GE (seed.size (), 3);
+  BOOST_CHECK_LE (seed.size (), 7);
+  for (size_t i = 1; i < seed.size (); ++i)
+    BOOST_CHECK_LT (seed[i - 1], seed[i]);
+  BOOST_CHECK (std::find (seed.begin (), seed.end (), 1000) != seed.end ());
+  BOOST_CHECK (std::find (seed.begin (), seed.end (), 1001) != seed.end ());
+}
+
+BOOST_AUTO_TEST_CASE (points_view)
+{
+  using namespace roboptim::capsule;
+
+  // More points than a streaming block, spread along a tilted axis.
+  polyhedron_t polyhedron;
+  vector3_t axis = vector3_t (1., 2., -0.5).normalized ();
+  for (int i = 0; i < 1000; ++i)
+    polyhedron.push_back (point_t (3. * point_t::Random ()[0] * axis
+				   + 0.5 * point_t::Random ()
+				   + point_t (10., -4., 2.)));
+
+  // Zero-copy views over the polyhedron and over a raw buffer.
+  Eigen::Map<const points_t> view = pointsMap (polyhedron);
+  BOOST_CHECK_EQUAL (view.cols (), 1000);
+  BOOST_CHECK_EQUAL (view.data (), polyhedron[0].data ());
+  Eigen::Map<const points_t> raw = pointsMap (polyhedron[0].data (), 1000);
+  BOOST_CHECK (raw.col (999) == polyhedron[999]);
+
+  // Matrix and vector inputs give the same results.
+  points_t points;
+  convertPolyhedronVectorToPoints (points, polyhedrons_t (1, polyhedron));
+  BOOST_CHECK_EQUAL (points.cols (), 1000);
+
+  BOOST_CHECK (covarianceMatrix (points)
+	       .isApprox (covarianceMatrix (polyhedron), 1e-12));
+
+  // Reference covariance, in two passes.
+  point_t mean = points.rowwise ().mean ();
+  points_t centered = points.colwise () - mean;
+  Eigen::Matrix3d covariance = centered * centered.transpose () / 1000.;
+  BOOST_CHECK (covarianceMatrix (view).isApprox (covariance, 1e-12));
+
+  int imin = -1, imax = -1;
+  extremePointsAlongDirection (axis, points, imin, imax);
+  Eigen::RowVectorXd proj = axis.transpose () * points;
+  Eigen::RowVectorXd::Index jmin, jmax;
+  proj.minCoeff (&jmin);
+  proj.maxCoeff (&jmax);
+  BOOST_CHECK_EQUAL (imin, jmin);
+  BOOST_CHECK_EQUAL (imax, jmax);
+
+  Capsule fromPoints = capsuleFromPoints (points);
+  Capsule fromPolyhedron = capsuleFromPoints (polyhedron);
+  BOOST_CHECK (fromPoints.P0.isApprox (fromPolyhedron.P0));
+  BOOST_CHECK (fromPoints.P1.isApprox (fromPolyhedron.P1));
+  BOOST_CHECK_CLOSE (fromPoints.radius, fromPolyhedron.radius, 1e-9);
+
+  // The bounding capsule contains all the points.
+  point_t endPoint1, endPoint2;
+  value_type radius;
+  computeBoundingCapsulePolyhedron (view, endPoint1, endPoint2, radius);
+  for (size_t i = 0; i < polyhedron.size (); ++i)
+    BOOST_CHECK_LE (distancePointToSegment (polyhedron[i],
+					    endPoint1, endPoint2),
+		    radius * (1. + 1e-9));
+
+  // The hull of a view is the hull of the polyhedron.
+  BOOST_CHECK_EQUAL (convexHullFromPoints (view).size (),
+		     convexHullFromPoints (polyhedron).size ());
+
+  polyhedron_t back;
+  convertPointsToPolyhedron (back, points);
+  BOOST_CHECK (back == polyhedron);
+}
+
+BOOST_AUTO_TEST_CASE (batched_segment_distances)
+{
+  using namespace roboptim::capsule;
+
+  // Not a multiple of the block size.
+  const size_type n = 1000;
+  points_t points = 2. * points_t::Random (3, n);
+
+  point_t a (-0.5, 0.2, 0.1);
+  point_t b (0.7, -0.3, 0.4);
+  for (int degenerate = 0; degenerate < 2; ++degenerate)
+    {
+      if (degenerate)
+	b = a;
+
+      vector_t distances (n);
+      vector_t lambdas (n);
+      points_t projections (3, n);
+      distancesPointsToSegment (points, a, b, distances);
+      projectionParametersOnSegment (points, a, b, lambdas);
+      projectionsOnSegment (points, a, b, projections);
+
+      for (size_type i = 0; i < n; ++i)
+	{
+	  point_t p = points.col (i);
+	  BOOST_CHECK_SMALL (distances[i] - distancePointToSegment (p, a, b),
+			     1e-12);
+	  BOOST_CHECK_SMALL (lambdas[i]
+			     - projectionParameterOnSegment (p, a, b), 1e-12);
+	  BOOST_CHECK_SMALL ((projections.col (i)
+			      - projectionOnSegment (p, a, b)).norm (),
+			     1e-12);
+	}
+    }
+
+  // One point against many segments, some of them degenerate.
+  points_t starts = points_t::Random (3, n);
+  points_t ends = points_t::Random (3, n);
+  for (size_type i = 0; i < n; i += 7)
+    ends.col (i) = starts.col (i);
+
+  point_t p (0.3, -0.1, 0.8);
+  vector_t distances (n);
+  distancesPointToSegments (p, starts, ends, distances);
+  for (size_type i = 0; i < n; ++i)
+    BOOST_CHECK_SMALL (distances[i]
+		       - distancePointToSegment (p, starts.col (i),
+						 ends.col (i)), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (point_statistics)
+{
+  using namespace roboptim::capsule;
+
+  // A cloud far from the origin, where raw moments lose all precision.
+  const size_type n = 300000;
+  points_t points = points_t::Random (3, n);
+  points.row (0) *= 5.;
+  points.colwise () += point_t (1e6, -2e6, 3e6);
+
+  // Reference statistics, in two passes.
+  point_t mean = points.rowwise ().mean ();
+  points_t centered = points.colwise () - mean;
+  Eigen::Matrix3d covariance
+    = centered * centered.transpose () / static_cast<value_type> (n);
+
+  PointStatistics serial = pointStatistics (points, 1);
+  BOOST_CHECK_EQUAL (serial.count (), n);
+  BOOST_CHECK (serial.mean ().isApprox (mean, 1e-14));
+  BOOST_CHECK (serial.covariance ().isApprox (covariance, 1e-9));
+  BOOST_CHECK (serial.lower () == point_t (points.rowwise ().minCoeff ()));
+  BOOST_CHECK (serial.upper () == point_t (points.rowwise ().maxCoeff ()));
+
+  // Parallel reduction.
+  PointStatistics parallel = pointStatistics (points, 4);
+  BOOST_CHECK_EQUAL (parallel.count (), n);
+  BOOST_CHECK (parallel.mean ().isApprox (mean, 1e-14));
+  BOOST_CHECK (parallel.covariance ().isApprox (covariance, 1e-9));
+  BOOST_CHECK (covarianceMatrix (points).isApprox (covariance, 1e-9));
+
+  // Merged chunks and single points.
+  PointStatistics merged;
+  merged.addPoints (points.leftCols (1000));
+  PointStatistics last;
+  for (size_type i = 1000; i < 2000; ++i)
+    last.add (point_t (points.col (i)));
+  merged.merge (last);
+  merged.merge (PointStatistics ());
+
+  point_t head = points.leftCols (2000).rowwise ().mean ();
+  centered = points.leftCols (2000).colwise () - head;
+  BOOST_CHECK_EQUAL (merged.count (), 2000);
+  BOOST_CHECK (merged.mean ().isApprox (head, 1e-14));
+  BOOST_CHECK (merged.covariance ()
+	       .isApprox (centered * centered.transpose () / 2000., 1e-9));
+
+  // The capsule contains all the points, whatever the number of
+  // threads used.
+  Capsule capsule = capsuleFromPoints (points);
+  vector_t distances (n);
+  distancesPointsToSegment (points, capsule.P0, capsule.P1, distances);
+  BOOST_CHECK_LE (distances.maxCoeff (), capsule.radius * (1. + 1e-9));
+}